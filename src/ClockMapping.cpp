@@ -0,0 +1,166 @@
+// -----------------------------------------------------------------------
+// Copyright (C) 2019-2023, EyeLogic GmbH
+//
+// Permission is hereby granted, free of charge, to any person or
+// organization obtaining a copy of the software and accompanying
+// documentation covered by this license (the "Software") to use,
+// reproduce, display, distribute, execute, and transmit the Software,
+// and to prepare derivative works of the Software, and to permit
+// third-parties to whom the Software is furnished to do so.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, TITLE AND
+// NON-INFRINGEMENT. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR ANYONE
+// DISTRIBUTING THE SOFTWARE BE LIABLE FOR ANY DAMAGES OR OTHER
+// LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+// OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+// -----------------------------------------------------------------------
+
+
+#include "ClockMapping.h"
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+using namespace ellsl;
+
+namespace
+{
+// observations until outliers are rejected
+const uint64 WARMUP_OBSERVATIONS = 16;
+// residuals beyond HUBER_K mean absolute residuals are down-weighted
+const double HUBER_K = 2.5;
+// the skew is only estimated once the observations span this standard deviation [s]
+const double MIN_SPREAD = 1.0;
+// a larger residual means the device clock was reset, the fit starts over [s]
+const double CLOCK_JUMP = 1.0;
+// the scale never drops below the resolution of the device timestamps [s]
+const double MIN_SCALE = 1e-6;
+}  // namespace
+
+ClockMapping::ClockMapping( double timeConstant ) : m_timeConstant( timeConstant )
+{
+}
+
+void
+ClockMapping::reset( )
+{
+    m_observations = 0;
+    m_weight       = 0.0;
+    m_meanX        = 0.0;
+    m_meanY        = 0.0;
+    m_covXX        = 0.0;
+    m_covXY        = 0.0;
+    m_scale        = 0.0;
+}
+
+double
+ClockMapping::update( int64 deviceMicroSec, double localClock )
+{
+    if ( m_observations == 0 ) {
+        m_deviceOrigin = deviceMicroSec;
+        m_localOrigin  = localClock;
+        m_lastX        = 0.0;
+    }
+
+    const double x = deviceSeconds( deviceMicroSec );
+    const double y = localClock - m_localOrigin;
+
+    double weight = 1.0;
+    if ( m_observations > 0 ) {
+        const double residual = y - ( m_meanY + slope( ) * ( x - m_meanX ) );
+        if ( std::abs( residual ) > CLOCK_JUMP ) {
+            reset( );
+            return update( deviceMicroSec, localClock );
+        }
+        if ( m_observations >= WARMUP_OBSERVATIONS &&
+             std::abs( residual ) > HUBER_K * m_scale ) {
+            weight = HUBER_K * m_scale / std::abs( residual );
+        }
+
+        // age the previous observations by the device time that has passed
+        const double decay = std::exp( -std::max( 0.0, x - m_lastX ) / m_timeConstant );
+        m_weight *= decay;
+        m_covXX *= decay;
+        m_covXY *= decay;
+        m_scale = m_observations == 1
+                      ? std::abs( residual )
+                      : m_scale + ( std::abs( residual ) - m_scale ) * ( 1.0 - decay );
+        m_scale = std::max( m_scale, MIN_SCALE );
+    }
+
+    // weighted incremental (West) update of means and co-moments
+    m_weight += weight;
+    const double dx = x - m_meanX;
+    m_meanX += weight * dx / m_weight;
+    m_meanY += weight * ( y - m_meanY ) / m_weight;
+    m_covXX += weight * dx * ( x - m_meanX );
+    m_covXY += weight * dx * ( y - m_meanY );
+
+    m_lastX = std::max( m_lastX, x );
+    m_observations++;
+    return map( deviceMicroSec );
+}
+
+double
+ClockMapping::map( int64 deviceMicroSec ) const
+{
+    if ( m_observations == 0 ) {
+        return deviceMicroSec / 1e6;
+    }
+    return m_localOrigin + m_meanY + slope( ) * ( deviceSeconds( deviceMicroSec ) - m_meanX );
+}
+
+ClockMapping::Fit
+ClockMapping::fit( ) const
+{
+    Fit result;
+    if ( m_observations == 0 ) {
+        return result;
+    }
+    const double b        = slope( );
+    result.offset         = m_localOrigin + m_meanY - b * ( m_meanX + m_deviceOrigin / 1e6 );
+    result.skewPpm        = ( b - 1.0 ) * 1e6;
+    result.jitterMicroSec = m_scale * 1e6;
+    result.observations   = m_observations;
+    return result;
+}
+
+double
+ClockMapping::timeConstant( ) const
+{
+    return m_timeConstant;
+}
+
+void
+ClockMapping::describe( lsl::xml_element desc ) const
+{
+    const Fit current = fit( );
+    desc.append_child( "clock_mapping" )
+        .append_child_value( "method", "robust exponentially weighted linear fit of "
+                                       "lsl::local_clock() at callback entry over device time" )
+        .append_child_value( "time_constant", std::to_string( m_timeConstant ) )
+        .append_child_value( "offset", std::to_string( current.offset ) )
+        .append_child_value( "skew_ppm", std::to_string( current.skewPpm ) )
+        .append_child_value( "jitter_us", std::to_string( current.jitterMicroSec ) )
+        .append_child_value( "observations", std::to_string( current.observations ) );
+}
+
+double
+ClockMapping::deviceSeconds( int64 deviceMicroSec ) const
+{
+    return ( deviceMicroSec - m_deviceOrigin ) / 1e6;
+}
+
+double
+ClockMapping::slope( ) const
+{
+    // pure offset until the observations span enough time to estimate the skew
+    if ( m_weight <= 0.0 || m_covXX / m_weight < MIN_SPREAD * MIN_SPREAD ) {
+        return 1.0;
+    }
+    return m_covXY / m_covXX;
+}
@@ -0,0 +1,94 @@
+// -----------------------------------------------------------------------
+// Copyright (C) 2019-2023, EyeLogic GmbH
+//
+// Permission is hereby granted, free of charge, to any person or
+// organization obtaining a copy of the software and accompanying
+// documentation covered by this license (the "Software") to use,
+// reproduce, display, distribute, execute, and transmit the Software,
+// and to prepare derivative works of the Software, and to permit
+// third-parties to whom the Software is furnished to do so.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, TITLE AND
+// NON-INFRINGEMENT. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR ANYONE
+// DISTRIBUTING THE SOFTWARE BE LIABLE FOR ANY DAMAGES OR OTHER
+// LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+// OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+// -----------------------------------------------------------------------
+
+
+#pragma once
+
+#include <cstdint>
+
+using int32  = int32_t;
+using int64  = int64_t;
+using uint32 = uint32_t;
+using uint64 = uint64_t;
+
+#include "lsl_cpp.h"
+
+namespace ellsl
+{
+/**
+ * @brief maps device timestamps into the lsl::local_clock( ) domain
+ *
+ * Keeps a robust, exponentially weighted linear fit of lsl::local_clock( ) at callback entry over
+ * the device timestamp. Every observation updates the fit in O(1); observations far from the fit,
+ * e.g. samples delayed by the scheduler, are down-weighted (Huber weights). The mean delay from
+ * the device to the callback remains part of the offset.
+ */
+class ClockMapping
+{
+public:
+    /** @brief LSL time = offset + ( 1 + skew ) * device time, both in [s] */
+    struct Fit {
+        double offset         = 0.0;
+        double skewPpm        = 0.0;
+        /** @brief mean absolute residual of the observations */
+        double jitterMicroSec = 0.0;
+        uint64 observations   = 0;
+    };
+
+    /** @param timeConstant [s] age at which an observation has lost 63% of its weight */
+    explicit ClockMapping( double timeConstant = 30.0 );
+
+    void reset( );
+
+    /** @brief adds an observation and returns the device timestamp mapped with the updated fit */
+    double update( int64 deviceMicroSec, double localClock );
+
+    /** @brief maps a device timestamp with the current fit */
+    double map( int64 deviceMicroSec ) const;
+
+    Fit    fit( ) const;
+    double timeConstant( ) const;
+
+    /** @brief appends the method and current fit to the stream meta-data */
+    void describe( lsl::xml_element desc ) const;
+
+private:
+    double deviceSeconds( int64 deviceMicroSec ) const;
+    double slope( ) const;
+
+    const double m_timeConstant;
+
+    // device timestamps and local clock relative to their first observation [s]
+    int64  m_deviceOrigin = 0;
+    double m_localOrigin  = 0.0;
+    uint64 m_observations = 0;
+    double m_lastX        = 0.0;
+
+    // exponentially weighted sum of weights, means and co-moments
+    double m_weight = 0.0;
+    double m_meanX  = 0.0;
+    double m_meanY  = 0.0;
+    double m_covXX  = 0.0;
+    double m_covXY  = 0.0;
+    // exponentially weighted mean absolute residual [s]
+    double m_scale = 0.0;
+};
+
+}  // namespace ellsl
@@ -0,0 +1,1007 @@
+// -----------------------------------------------------------------------
+// Copyright (C) 2019-2023, EyeLogic GmbH
+//
+// Permission is hereby granted, free of charge, to any person or
+// organization obtaining a copy of the software and accompanying
+// documentation covered by this license (the "Software") to use,
+// reproduce, display, distribute, execute, and transmit the Software,
+// and to prepare derivative works of the Software, and to permit
+// third-parties to whom the Software is furnished to do so.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, TITLE AND
+// NON-INFRINGEMENT. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR ANYONE
+// DISTRIBUTING THE SOFTWARE BE LIABLE FOR ANY DAMAGES OR OTHER
+// LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+// OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+// -----------------------------------------------------------------------
+
+
+#include "ControlServer.h"
+#include "Log.h"
+
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include <type_traits>
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+#endif
+
+using namespace ellsl;
+
+namespace
+{
+// interval at which the blocked threads check whether the server is stopping
+constexpr int POLL_INTERVAL_MS = 100;
+// a client that does not read its replies must not stall the worker
+constexpr int SEND_TIMEOUT_MS = 1000;
+
+#ifdef _WIN32
+using Socket               = SOCKET;
+const Socket  NO_SOCKET    = INVALID_SOCKET;
+constexpr int SEND_FLAGS   = 0;
+
+bool
+startSockets( )
+{
+    WSADATA data;
+    return WSAStartup( MAKEWORD( 2, 2 ), &data ) == 0;
+}
+
+void
+stopSockets( )
+{
+    WSACleanup( );
+}
+
+void
+closeSocket( Socket socket )
+{
+    closesocket( socket );
+}
+
+void
+shutdownSocket( Socket socket )
+{
+    shutdown( socket, SD_BOTH );
+}
+
+// > 0 if there is something to receive or the connection is gone
+int
+pollSocket( Socket socket, int timeoutMillis )
+{
+    WSAPOLLFD fd{ };
+    fd.fd     = socket;
+    fd.events = POLLRDNORM;
+    return WSAPoll( &fd, 1, timeoutMillis );
+}
+
+void
+configureSocket( Socket socket )
+{
+    const DWORD timeout = SEND_TIMEOUT_MS;
+    setsockopt( socket, SOL_SOCKET, SO_SNDTIMEO, reinterpret_cast< const char* >( &timeout ),
+                sizeof( timeout ) );
+}
+#else
+using Socket               = int;
+constexpr Socket NO_SOCKET = -1;
+#ifdef MSG_NOSIGNAL
+constexpr int SEND_FLAGS = MSG_NOSIGNAL;
+#else
+constexpr int SEND_FLAGS = 0;
+#endif
+
+bool
+startSockets( )
+{
+    return true;
+}
+
+void
+stopSockets( )
+{
+}
+
+void
+closeSocket( Socket socket )
+{
+    close( socket );
+}
+
+void
+shutdownSocket( Socket socket )
+{
+    shutdown( socket, SHUT_RDWR );
+}
+
+// > 0 if there is something to receive or the connection is gone
+int
+pollSocket( Socket socket, int timeoutMillis )
+{
+    pollfd fd{ };
+    fd.fd     = socket;
+    fd.events = POLLIN;
+    return poll( &fd, 1, timeoutMillis );
+}
+
+void
+configureSocket( Socket socket )
+{
+    timeval timeout{ };
+    timeout.tv_sec  = SEND_TIMEOUT_MS / 1000;
+    timeout.tv_usec = ( SEND_TIMEOUT_MS % 1000 ) * 1000;
+    setsockopt( socket, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof( timeout ) );
+#ifdef SO_NOSIGPIPE
+    const int on = 1;
+    setsockopt( socket, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof( on ) );
+#endif
+}
+#endif
+
+// -?(0|[1-9][0-9]*)(.[0-9]+)?([eE][+-]?[0-9]+)? - strtod( ) alone would accept more, e.g. "0x1"
+bool
+isJsonNumber( const std::string& text )
+{
+    const auto digits = [ &text ]( size_t& pos ) {
+        const size_t begin = pos;
+        while ( pos < text.size( ) &&
+                std::isdigit( static_cast< unsigned char >( text[ pos ] ) ) ) {
+            pos++;
+        }
+        return pos - begin;
+    };
+    size_t       pos   = ( !text.empty( ) && text[ 0 ] == '-' ) ? 1 : 0;
+    const size_t begin = pos;
+    const size_t count = digits( pos );
+    if ( count == 0 || ( count > 1 && text[ begin ] == '0' ) ) {
+        return false;
+    }
+    if ( pos < text.size( ) && text[ pos ] == '.' ) {
+        pos++;
+        if ( digits( pos ) == 0 ) {
+            return false;
+        }
+    }
+    if ( pos < text.size( ) && ( text[ pos ] == 'e' || text[ pos ] == 'E' ) ) {
+        pos++;
+        if ( pos < text.size( ) && ( text[ pos ] == '+' || text[ pos ] == '-' ) ) {
+            pos++;
+        }
+        if ( digits( pos ) == 0 ) {
+            return false;
+        }
+    }
+    return pos == text.size( );
+}
+
+struct JsonValue {
+    enum class Type {
+        STRING,
+        NUMBER,
+        BOOLEAN,
+        NULLVALUE,
+    };
+    Type type = Type::NULLVALUE;
+    // decoded string, or number as sent
+    std::string text;
+    double      number  = 0.0;
+    bool        boolean = false;
+};
+
+using JsonMembers = std::map< std::string, JsonValue >;
+
+// parses a flat object of string, number, boolean and null members - requests do not nest
+class JsonParser
+{
+public:
+    explicit JsonParser( const std::string& text ) : m_text( text ) { }
+
+    bool parseObject( JsonMembers& members )
+    {
+        skipSpace( );
+        if ( !consume( '{' ) ) {
+            return false;
+        }
+        skipSpace( );
+        if ( !consume( '}' ) ) {
+            do {
+                std::string key;
+                JsonValue   value;
+                skipSpace( );
+                if ( !parseString( key ) ) {
+                    return false;
+                }
+                skipSpace( );
+                if ( !consume( ':' ) ) {
+                    return false;
+                }
+                skipSpace( );
+                if ( !parseValue( value ) ) {
+                    return false;
+                }
+                members[ key ] = std::move( value );
+                skipSpace( );
+            } while ( consume( ',' ) );
+            if ( !consume( '}' ) ) {
+                return false;
+            }
+        }
+        skipSpace( );
+        return m_pos == m_text.size( );
+    }
+
+private:
+    void skipSpace( )
+    {
+        while ( m_pos < m_text.size( ) && ( m_text[ m_pos ] == ' ' || m_text[ m_pos ] == '\t' ||
+                                            m_text[ m_pos ] == '\r' || m_text[ m_pos ] == '\n' ) ) {
+            m_pos++;
+        }
+    }
+
+    bool consume( char c )
+    {
+        if ( m_pos < m_text.size( ) && m_text[ m_pos ] == c ) {
+            m_pos++;
+            return true;
+        }
+        return false;
+    }
+
+    bool consume( const char* literal )
+    {
+        const size_t length = std::strlen( literal );
+        if ( m_text.compare( m_pos, length, literal ) == 0 ) {
+            m_pos += length;
+            return true;
+        }
+        return false;
+    }
+
+    bool parseString( std::string& value )
+    {
+        if ( !consume( '"' ) ) {
+            return false;
+        }
+        while ( m_pos < m_text.size( ) ) {
+            const char c = m_text[ m_pos++ ];
+            if ( c == '"' ) {
+                return true;
+            }
+            if ( static_cast< unsigned char >( c ) < 0x20 ) {
+                return false;
+            }
+            if ( c != '\\' ) {
+                value += c;
+                continue;
+            }
+            if ( m_pos >= m_text.size( ) ) {
+                return false;
+            }
+            switch ( m_text[ m_pos++ ] ) {
+                case '"':
+                    value += '"';
+                    break;
+                case '\\':
+                    value += '\\';
+                    break;
+                case '/':
+                    value += '/';
+                    break;
+                case 'b':
+                    value += '\b';
+                    break;
+                case 'f':
+                    value += '\f';
+                    break;
+                case 'n':
+                    value += '\n';
+                    break;
+                case 'r':
+                    value += '\r';
+                    break;
+                case 't':
+                    value += '\t';
+                    break;
+                case 'u':
+                    if ( !parseCodePoint( value ) ) {
+                        return false;
+                    }
+                    break;
+                default:
+                    return false;
+            }
+        }
+        return false;
+    }
+
+    // "\uXXXX" of the basic multilingual plane, appended as UTF-8
+    bool parseCodePoint( std::string& value )
+    {
+        if ( m_pos + 4 > m_text.size( ) ) {
+            return false;
+        }
+        uint32 code = 0;
+        for ( int32 i = 0; i < 4; i++ ) {
+            const char c = m_text[ m_pos++ ];
+            code <<= 4;
+            if ( c >= '0' && c <= '9' ) {
+                code |= static_cast< uint32 >( c - '0' );
+            } else if ( c >= 'a' && c <= 'f' ) {
+                code |= static_cast< uint32 >( c - 'a' + 10 );
+            } else if ( c >= 'A' && c <= 'F' ) {
+                code |= static_cast< uint32 >( c - 'A' + 10 );
+            } else {
+                return false;
+            }
+        }
+        if ( code >= 0xD800 && code <= 0xDFFF ) {
+            return false;
+        }
+        if ( code < 0x80 ) {
+            value += static_cast< char >( code );
+        } else if ( code < 0x800 ) {
+            value += static_cast< char >( 0xC0 | ( code >> 6 ) );
+            value += static_cast< char >( 0x80 | ( code & 0x3F ) );
+        } else {
+            value += static_cast< char >( 0xE0 | ( code >> 12 ) );
+            value += static_cast< char >( 0x80 | ( ( code >> 6 ) & 0x3F ) );
+            value += static_cast< char >( 0x80 | ( code & 0x3F ) );
+        }
+        return true;
+    }
+
+    bool parseValue( JsonValue& value )
+    {
+        if ( m_pos >= m_text.size( ) ) {
+            return false;
+        }
+        if ( m_text[ m_pos ] == '"' ) {
+            value.type = JsonValue::Type::STRING;
+            return parseString( value.text );
+        }
+        if ( consume( "true" ) ) {
+            value.type    = JsonValue::Type::BOOLEAN;
+            value.boolean = true;
+            return true;
+        }
+        if ( consume( "false" ) ) {
+            value.type    = JsonValue::Type::BOOLEAN;
+            value.boolean = false;
+            return true;
+        }
+        if ( consume( "null" ) ) {
+            value.type = JsonValue::Type::NULLVALUE;
+            return true;
+        }
+        const size_t      end = m_text.find_first_not_of( "0123456789+-.eE", m_pos );
+        const std::string number =
+            m_text.substr( m_pos, end == std::string::npos ? std::string::npos : end - m_pos );
+        if ( !isJsonNumber( number ) ) {
+            return false;
+        }
+        value.type   = JsonValue::Type::NUMBER;
+        value.number = std::strtod( number.c_str( ), nullptr );
+        value.text   = number;
+        m_pos += number.size( );
+        return std::isfinite( value.number );
+    }
+
+    const std::string& m_text;
+    size_t             m_pos = 0;
+};
+
+std::string
+quote( const std::string& text )
+{
+    std::string quoted = "\"";
+    for ( const char c : text ) {
+        switch ( c ) {
+            case '"':
+                quoted += "\\\"";
+                break;
+            case '\\':
+                quoted += "\\\\";
+                break;
+            case '\n':
+                quoted += "\\n";
+                break;
+            case '\r':
+                quoted += "\\r";
+                break;
+            case '\t':
+                quoted += "\\t";
+                break;
+            default:
+                if ( static_cast< unsigned char >( c ) < 0x20 ) {
+                    char escaped[ 8 ];
+                    std::snprintf( escaped, sizeof( escaped ), "\\u%04x", c );
+                    quoted += escaped;
+                } else {
+                    quoted += c;
+                }
+        }
+    }
+    return quoted + "\"";
+}
+
+// invalid values become null
+template< typename Number >
+std::string
+formatNumber( Number number )
+{
+    if constexpr ( std::is_integral_v< Number > ) {
+        return std::to_string( number );
+    } else {
+        if ( !std::isfinite( number ) || number == elapi::ELInvalidValue ) {
+            return "null";
+        }
+        std::ostringstream ss;
+        ss << std::setprecision( 10 ) << number;
+        return ss.str( );
+    }
+}
+
+template< typename Number >
+std::string
+formatArray( const std::vector< Number >& numbers )
+{
+    std::string array;
+    for ( const auto number : numbers ) {
+        array += ( array.empty( ) ? "" : "," ) + formatNumber( number );
+    }
+    return "[" + array + "]";
+}
+
+class JsonObject
+{
+public:
+    JsonObject& value( const char* key, const std::string& text )
+    {
+        return raw( key, quote( text ) );
+    }
+    JsonObject& value( const char* key, const char* text ) { return raw( key, quote( text ) ); }
+    JsonObject& value( const char* key, bool flag ) { return raw( key, flag ? "true" : "false" ); }
+
+    template< typename Number, typename = std::enable_if_t< std::is_arithmetic_v< Number > > >
+    JsonObject& value( const char* key, Number number )
+    {
+        return raw( key, formatNumber( number ) );
+    }
+
+    /** @brief appends a member whose value is JSON text already */
+    JsonObject& raw( const char* key, const std::string& json )
+    {
+        m_members += ( m_members.empty( ) ? "" : "," ) + quote( key ) + ":" + json;
+        return *this;
+    }
+
+    std::string str( ) const { return "{" + m_members + "}"; }
+
+private:
+    std::string m_members;
+};
+
+std::string
+formatId( const JsonMembers& members )
+{
+    const auto id = members.find( "id" );
+    if ( id == members.end( ) ) {
+        return "null";
+    }
+    switch ( id->second.type ) {
+        case JsonValue::Type::STRING:
+            return quote( id->second.text );
+        case JsonValue::Type::NUMBER:
+            // as sent - reformatting could round large ids and break matching the reply
+            return id->second.text;
+        case JsonValue::Type::BOOLEAN:
+            return id->second.boolean ? "true" : "false";
+        case JsonValue::Type::NULLVALUE:
+            break;
+    }
+    return "null";
+}
+
+std::string
+success( const std::string& id, const std::string& result = "{}" )
+{
+    return "{\"id\":" + id + ",\"ok\":true,\"result\":" + result + "}";
+}
+
+std::string
+failure( const std::string& id, const char* error )
+{
+    return "{\"id\":" + id + ",\"ok\":false,\"error\":" + quote( error ) + "}";
+}
+
+bool
+findString( const JsonMembers& members, const char* key, std::string& value )
+{
+    const auto member = members.find( key );
+    if ( member == members.end( ) || member->second.type != JsonValue::Type::STRING ) {
+        return false;
+    }
+    value = member->second.text;
+    return true;
+}
+
+bool
+findInteger( const JsonMembers& members, const char* key, int32& value )
+{
+    const auto member = members.find( key );
+    if ( member == members.end( ) || member->second.type != JsonValue::Type::NUMBER ) {
+        return false;
+    }
+    const double number = member->second.number;
+    if ( number != std::floor( number ) || number < INT32_MIN || number > INT32_MAX ) {
+        return false;
+    }
+    value = static_cast< int32 >( number );
+    return true;
+}
+
+std::string
+formatStatus( const LSLClient& client )
+{
+    return JsonObject( )
+        .value( "connected", client.isConnected( ) )
+        .value( "streaming", client.isStreaming( ) )
+        .value( "consumers", client.hasConsumers( ) )
+        .value( "idle", client.isIdle( ) )
+        .value( "calibrating", client.isCalibrating( ) )
+        .value( "deviceSerial", client.deviceSerial( ) )
+        .str( );
+}
+
+std::string
+formatStatistics( const LSLClient& client )
+{
+    JsonObject result;
+
+    const auto ring = client.ringStatistics( );
+    result.raw( "ring", JsonObject( )
+                            .value( "capacity", ring.capacity )
+                            .value( "occupancy", ring.occupancy )
+                            .value( "highWater", ring.highWater )
+                            .value( "pushed", ring.pushed )
+                            .value( "overflows", ring.overflows )
+                            .str( ) );
+
+    const auto continuity = client.continuityStatistics( );
+    result.raw( "stream", JsonObject( )
+                              .value( "samples", continuity.samples )
+                              .value( "gaps", continuity.gaps )
+                              .value( "missing", continuity.missing )
+                              .value( "duplicates", continuity.duplicates )
+                              .value( "restarts", continuity.restarts )
+                              .value( "filled", continuity.filled )
+                              .value( "gapFilling", client.gapFilling( ) )
+                              .str( ) );
+
+    // disabled outputs are null
+    MarkerOutlet::Statistics markers;
+    result.raw( "markers", client.markerStatistics( markers )
+                               ? JsonObject( )
+                                     .value( "posted", markers.posted )
+                                     .value( "dropped", markers.dropped )
+                                     .str( )
+                               : "null" );
+    MarkerOutlet::Statistics events;
+    result.raw( "events", client.eventStatistics( events )
+                              ? JsonObject( )
+                                    .value( "posted", events.posted )
+                                    .value( "dropped", events.dropped )
+                                    .str( )
+                              : "null" );
+    XdfWriter::Statistics xdf;
+    result.raw( "xdf", client.xdfStatistics( xdf ) ? JsonObject( )
+                                                         .value( "streams", xdf.streams )
+                                                         .value( "samples", xdf.samples )
+                                                         .value( "bytes", xdf.bytes )
+                                                         .value( "late", xdf.late )
+                                                         .str( )
+                                                   : "null" );
+    RecordingJournal::Statistics journal;
+    result.raw( "journal", client.journalStatistics( journal )
+                               ? JsonObject( )
+                                     .value( "segments", journal.segments )
+                                     .value( "records", journal.records )
+                                     .value( "bytes", journal.bytes )
+                                     .value( "dropped", journal.dropped )
+                                     .value( "recovered", journal.recovered )
+                                     .str( )
+                               : "null" );
+
+    const auto log = Log::statistics( );
+    result.raw( "log", JsonObject( )
+                           .value( "written", log.written )
+                           .value( "dropped", log.dropped )
+                           .str( ) );
+    return result.str( );
+}
+
+std::string
+formatValidation( const elapi::ELApi::ELValidationResult& validation )
+{
+    std::string points;
+    for ( const auto& point : validation.pointsData ) {
+        const std::string json = JsonObject( )
+                                     .value( "x", point.validationPointPxX )
+                                     .value( "y", point.validationPointPxY )
+                                     .value( "leftPx", point.meanDeviationLeftPx )
+                                     .value( "leftDeg", point.meanDeviationLeftDeg )
+                                     .value( "rightPx", point.meanDeviationRightPx )
+                                     .value( "rightDeg", point.meanDeviationRightDeg )
+                                     .str( );
+        points += ( points.empty( ) ? "" : "," ) + json;
+    }
+    return JsonObject( ).raw( "points", "[" + points + "]" ).str( );
+}
+
+}  // namespace
+
+struct ControlServer::Connection {
+    explicit Connection( Socket socket ) : socket( socket ) { }
+
+    // replies may come from the worker and the calibration task while the reader receives
+    void send( const std::string& line )
+    {
+        std::lock_guard< std::mutex > lock( sendMutex );
+        const std::string data = line + "\n";
+        size_t            sent = 0;
+        while ( open && sent < data.size( ) ) {
+            const auto count = ::send( socket, data.c_str( ) + sent,
+                                       static_cast< int >( data.size( ) - sent ), SEND_FLAGS );
+            if ( count <= 0 ) {
+                // a partly sent line would garble every later reply - the reader closes the
+                // socket once it notices the shutdown
+                Log::warning( "control client does not receive - connection closed" );
+                open = false;
+                shutdownSocket( socket );
+                return;
+            }
+            sent += static_cast< size_t >( count );
+        }
+    }
+
+    // called by the reader when it is done, pending replies are dropped afterwards
+    void close( )
+    {
+        std::lock_guard< std::mutex > lock( sendMutex );
+        open = false;
+        closeSocket( socket );
+    }
+
+    const Socket        socket;
+    std::thread         thread;
+    std::mutex          sendMutex;
+    bool                open = true;  // guarded by sendMutex
+    std::atomic< bool > finished{ false };
+};
+
+ControlServer::ControlServer( LSLClient& client ) : m_client( client ) { }
+
+ControlServer::~ControlServer( )
+{
+    stop( );
+}
+
+bool
+ControlServer::start( uint16_t port )
+{
+    if ( m_running || !startSockets( ) ) {
+        return false;
+    }
+    const Socket listener = socket( AF_INET, SOCK_STREAM, IPPROTO_TCP );
+    if ( listener == NO_SOCKET ) {
+        stopSockets( );
+        return false;
+    }
+#ifndef _WIN32
+    // a restarted client gets its port back while old connections linger in TIME_WAIT
+    const int reuse = 1;
+    setsockopt( listener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof( reuse ) );
+#endif
+    // only processes on this machine may control the client
+    sockaddr_in address{ };
+    address.sin_family      = AF_INET;
+    address.sin_port        = htons( port );
+    address.sin_addr.s_addr = htonl( INADDR_LOOPBACK );
+    if ( bind( listener, reinterpret_cast< const sockaddr* >( &address ), sizeof( address ) ) !=
+             0 ||
+         listen( listener, SOMAXCONN ) != 0 ) {
+        closeSocket( listener );
+        stopSockets( );
+        return false;
+    }
+
+    m_listener = static_cast< int64 >( listener );
+    m_running  = true;
+    m_worker   = std::thread( &ControlServer::runWorker, this );
+    m_acceptor = std::thread( &ControlServer::runAcceptor, this );
+    return true;
+}
+
+void
+ControlServer::stop( )
+{
+    if ( !m_running.exchange( false ) ) {
+        return;
+    }
+    m_acceptor.join( );
+    closeSocket( static_cast< Socket >( m_listener ) );
+    m_listener = -1;
+
+    std::vector< std::shared_ptr< Connection > > connections;
+    {
+        std::lock_guard< std::mutex > lock( m_connectionMutex );
+        connections.swap( m_connections );
+    }
+    for ( auto& connection : connections ) {
+        connection->thread.join( );
+    }
+
+    {
+        std::lock_guard< std::mutex > lock( m_workerMutex );
+        m_commands.clear( );
+    }
+    m_workerCondition.notify_all( );
+    m_worker.join( );
+    stopSockets( );
+}
+
+void
+ControlServer::handle( const std::string& request, Reply reply )
+{
+    JsonMembers members;
+    if ( !JsonParser( request ).parseObject( members ) ) {
+        reply( failure( "null", "BAD_REQUEST" ) );
+        return;
+    }
+    const std::string id = formatId( members );
+    std::string       command;
+    if ( !findString( members, "cmd", command ) ) {
+        reply( failure( id, "MISSING_COMMAND" ) );
+        return;
+    }
+    Log::verbose( "control command " + command );
+
+    // queries are answered right away, even while a command is running
+    if ( command == "status" ) {
+        reply( success( id, formatStatus( m_client ) ) );
+    } else if ( command == "stats" ) {
+        reply( success( id, formatStatistics( m_client ) ) );
+    } else if ( command == "list-framerates" ) {
+        reply( success(
+            id, JsonObject( ).raw( "framerates", formatArray( m_client.framerates( ) ) ).str( ) ) );
+    } else if ( command == "list-calibrations" ) {
+        reply( success( id, JsonObject( )
+                                .raw( "calibrations", formatArray( m_client.calibrations( ) ) )
+                                .str( ) ) );
+    } else if ( command == "abort" ) {
+        // the reply to the running calibrate or validate follows once it has stopped
+        m_client.abortCalibration( );
+        reply( success( id ) );
+    } else if ( command == "connect" ) {
+        std::string              address;
+        elapi::ELApi::ServerInfo server{ };
+        const bool               remote = findString( members, "server", address );
+        if ( remote && !parseServer( address, server ) ) {
+            reply( failure( id, "INVALID_PARAMETER" ) );
+            return;
+        }
+        post( [ this, id, reply, remote, server ]( ) {
+            const auto retConnect =
+                remote ? m_client.connectRemote( server ) : m_client.connectELApi( );
+            if ( retConnect == elapi::ELApi::ReturnConnect::SUCCESS ) {
+                reply( success(
+                    id, JsonObject( ).value( "deviceSerial", m_client.deviceSerial( ) ).str( ) ) );
+            } else {
+                reply( failure( id, toString( retConnect ) ) );
+            }
+        } );
+    } else if ( command == "startstream" ) {
+        int32         samplerate = 0;
+        std::string   text;
+        StreamProfile profile = m_client.streamProfile( );
+        if ( !findInteger( members, "rate", samplerate ) ) {
+            reply( failure( id, "MISSING_PARAMETER" ) );
+            return;
+        }
+        if ( findString( members, "profile", text ) && !parseStreamProfile( text, profile ) ) {
+            reply( failure( id, "INVALID_PARAMETER" ) );
+            return;
+        }
+        post( [ this, id, reply, samplerate, profile ]( ) {
+            m_client.setStreamProfile( profile );
+            const auto retTracking = m_client.requestTracking( samplerate );
+            if ( retTracking == elapi::ELApi::ReturnStart::SUCCESS ) {
+                reply( success( id, JsonObject( )
+                                        .value( "rate", samplerate )
+                                        .value( "profile", toString( profile ) )
+                                        .str( ) ) );
+            } else {
+                reply( failure( id, toString( retTracking ) ) );
+            }
+        } );
+    } else if ( command == "closestream" ) {
+        post( [ this, id, reply ]( ) {
+            if ( !m_client.isStreaming( ) ) {
+                reply( failure( id, "NOT_STREAMING" ) );
+                return;
+            }
+            m_client.closeStream( );
+            reply( success( id ) );
+        } );
+    } else if ( command == "calibrate" ) {
+        int32 mode = 0;
+        if ( !findInteger( members, "mode", mode ) ) {
+            reply( failure( id, "MISSING_PARAMETER" ) );
+            return;
+        }
+        post( [ this, id, reply, mode ]( ) {
+            const auto retCalibrate = m_client.requestCalibration(
+                mode, [ id, reply, mode ]( elapi::ELApi::ReturnCalibrate result ) {
+                    if ( result == elapi::ELApi::ReturnCalibrate::SUCCESS ) {
+                        reply( success( id, JsonObject( ).value( "mode", mode ).str( ) ) );
+                    } else {
+                        reply( failure( id, toString( result ) ) );
+                    }
+                } );
+            if ( retCalibrate != elapi::ELApi::ReturnCalibrate::SUCCESS ) {
+                reply( failure( id, toString( retCalibrate ) ) );
+            }
+        } );
+    } else if ( command == "validate" ) {
+        post( [ this, id, reply ]( ) {
+            const auto retValidate = m_client.requestValidation(
+                [ id, reply ]( elapi::ELApi::ReturnValidate              result,
+                               const elapi::ELApi::ELValidationResult& validation ) {
+                    if ( result == elapi::ELApi::ReturnValidate::SUCCESS ) {
+                        reply( success( id, formatValidation( validation ) ) );
+                    } else {
+                        reply( failure( id, toString( result ) ) );
+                    }
+                } );
+            if ( retValidate != elapi::ELApi::ReturnValidate::SUCCESS ) {
+                reply( failure( id, toString( retValidate ) ) );
+            }
+        } );
+    } else {
+        reply( failure( id, "UNKNOWN_COMMAND" ) );
+    }
+}
+
+void
+ControlServer::post( std::function< void( ) > command )
+{
+    {
+        std::lock_guard< std::mutex > lock( m_workerMutex );
+        m_commands.push_back( std::move( command ) );
+    }
+    m_workerCondition.notify_one( );
+}
+
+void
+ControlServer::runWorker( )
+{
+    while ( true ) {
+        std::function< void( ) > command;
+        {
+            std::unique_lock< std::mutex > lock( m_workerMutex );
+            m_workerCondition.wait( lock, [ this ] { return !m_running || !m_commands.empty( ); } );
+            if ( !m_running ) {
+                return;
+            }
+            command = std::move( m_commands.front( ) );
+            m_commands.pop_front( );
+        }
+        command( );
+    }
+}
+
+void
+ControlServer::runAcceptor( )
+{
+    const Socket listener = static_cast< Socket >( m_listener );
+    while ( m_running ) {
+        // joins the readers of closed connections
+        std::vector< std::shared_ptr< Connection > > closed;
+        {
+            std::lock_guard< std::mutex > lock( m_connectionMutex );
+            for ( auto it = m_connections.begin( ); it != m_connections.end( ); ) {
+                if ( ( *it )->finished ) {
+                    closed.push_back( *it );
+                    it = m_connections.erase( it );
+                } else {
+                    ++it;
+                }
+            }
+        }
+        for ( auto& connection : closed ) {
+            connection->thread.join( );
+        }
+
+        if ( pollSocket( listener, POLL_INTERVAL_MS ) <= 0 ) {
+            continue;
+        }
+        const Socket socket = accept( listener, nullptr, nullptr );
+        if ( socket == NO_SOCKET ) {
+            continue;
+        }
+        std::lock_guard< std::mutex > lock( m_connectionMutex );
+        if ( m_connections.size( ) >= MAX_CONNECTIONS ) {
+            Log::warning( "too many control clients - connection refused" );
+            closeSocket( socket );
+            continue;
+        }
+        configureSocket( socket );
+        auto connection    = std::make_shared< Connection >( socket );
+        connection->thread = std::thread( &ControlServer::runConnection, this, connection );
+        m_connections.push_back( std::move( connection ) );
+        Log::verbose( "control client connected" );
+    }
+}
+
+void
+ControlServer::runConnection( std::shared_ptr< Connection > connection )
+{
+    // replies only hold on to the connection, they may outlive the server
+    const Reply reply = [ connection ]( const std::string& line ) { connection->send( line ); };
+
+    std::string buffer;
+    char        received[ 4096 ];
+    while ( m_running ) {
+        if ( pollSocket( connection->socket, POLL_INTERVAL_MS ) <= 0 ) {
+            continue;
+        }
+        const auto count = recv( connection->socket, received, sizeof( received ), 0 );
+        if ( count <= 0 ) {
+            break;
+        }
+        buffer.append( received, static_cast< size_t >( count ) );
+
+        size_t begin = 0;
+        size_t end;
+        while ( ( end = buffer.find( '\n', begin ) ) != std::string::npos ) {
+            std::string line = buffer.substr( begin, end - begin );
+            begin            = end + 1;
+            if ( !line.empty( ) && line.back( ) == '\r' ) {
+                line.pop_back( );
+            }
+            if ( line.find_first_not_of( " \t" ) != std::string::npos ) {
+                handle( line, reply );
+            }
+        }
+        buffer.erase( 0, begin );
+        if ( buffer.size( ) > MAX_LINE ) {
+            Log::warning( "control request too long - connection closed" );
+            break;
+        }
+    }
+    connection->close( );
+    connection->finished = true;
+    Log::verbose( "control client disconnected" );
+}
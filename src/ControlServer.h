@@ -0,0 +1,105 @@
+// -----------------------------------------------------------------------
+// Copyright (C) 2019-2023, EyeLogic GmbH
+//
+// Permission is hereby granted, free of charge, to any person or
+// organization obtaining a copy of the software and accompanying
+// documentation covered by this license (the "Software") to use,
+// reproduce, display, distribute, execute, and transmit the Software,
+// and to prepare derivative works of the Software, and to permit
+// third-parties to whom the Software is furnished to do so.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, TITLE AND
+// NON-INFRINGEMENT. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR ANYONE
+// DISTRIBUTING THE SOFTWARE BE LIABLE FOR ANY DAMAGES OR OTHER
+// LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+// OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+// -----------------------------------------------------------------------
+
+
+#pragma once
+
+#include <cstdint>
+
+using int32  = int32_t;
+using int64  = int64_t;
+using uint32 = uint32_t;
+using uint64 = uint64_t;
+
+#include "LSLClient.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ellsl
+{
+/**
+ * @brief line-delimited JSON control endpoint on localhost for scripted experiments
+ *
+ * Every request is one JSON object per line, e.g. {"id":1,"cmd":"startstream","rate":500}, and
+ * is answered by exactly one line {"id":1,"ok":true,"result":{...}} or
+ * {"id":1,"ok":false,"error":"INVALID_FRAMERATE_MODE"}. Queries are answered right away,
+ * commands changing the client run one after another on a worker thread, calibrate and validate
+ * reply once they have finished - so replies may arrive out of order and carry the request id.
+ */
+class ControlServer
+{
+public:
+    /** @brief receives the reply line of a request, without the trailing newline */
+    using Reply = std::function< void( const std::string& ) >;
+
+    /** @brief longer request lines close the connection */
+    static constexpr size_t MAX_LINE = 64 * 1024;
+    /** @brief further connections are refused */
+    static constexpr size_t MAX_CONNECTIONS = 8;
+
+    explicit ControlServer( LSLClient& client );
+    ~ControlServer( );
+
+    ControlServer( const ControlServer& ) = delete;
+    ControlServer& operator=( const ControlServer& ) = delete;
+
+    /** @brief listens on 127.0.0.1:<port>, false if the port cannot be bound */
+    bool start( uint16_t port );
+    /** @brief closes all connections, queued commands are dropped */
+    void stop( );
+
+    /** @brief handles one request line, 'reply' is called exactly once, possibly later */
+    void handle( const std::string& request, Reply reply );
+
+private:
+    struct Connection;
+
+    void runAcceptor( );
+    void runConnection( std::shared_ptr< Connection > connection );
+    void runWorker( );
+
+    /** @brief queues a command for the worker thread */
+    void post( std::function< void( ) > command );
+
+    LSLClient& m_client;
+
+    // socket handle, -1 while not listening
+    int64               m_listener = -1;
+    std::atomic< bool > m_running{ false };
+    std::thread         m_acceptor;
+
+    std::mutex                                   m_connectionMutex;
+    std::vector< std::shared_ptr< Connection > > m_connections;
+
+    std::mutex                             m_workerMutex;
+    std::condition_variable                m_workerCondition;
+    std::deque< std::function< void( ) > > m_commands;
+    std::thread                            m_worker;
+};
+
+}  // namespace ellsl
@@ -0,0 +1,134 @@
+// -----------------------------------------------------------------------
+// Copyright (C) 2019-2023, EyeLogic GmbH
+//
+// Permission is hereby granted, free of charge, to any person or
+// organization obtaining a copy of the software and accompanying
+// documentation covered by this license (the "Software") to use,
+// reproduce, display, distribute, execute, and transmit the Software,
+// and to prepare derivative works of the Software, and to permit
+// third-parties to whom the Software is furnished to do so.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, TITLE AND
+// NON-INFRINGEMENT. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR ANYONE
+// DISTRIBUTING THE SOFTWARE BE LIABLE FOR ANY DAMAGES OR OTHER
+// LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+// OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+// -----------------------------------------------------------------------
+
+
+#pragma once
+
+#include "StreamProfile.h"
+
+#include <type_traits>
+
+#if defined( __AVX2__ )
+#include <immintrin.h>
+#endif
+#if defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 )
+#include <emmintrin.h>
+#define ELLSL_HAVE_SSE2 1
+#endif
+
+namespace ellsl
+{
+/**
+ * @brief vectorized ELGazeSample -> LSL sample conversion
+ *
+ * The channels of a selection are gathered through CHANNEL_OFFSET into a contiguous buffer, the
+ * ELInvalidValue -> NaN substitution and the narrowing to float then run over the whole buffer,
+ * i.e. over all channels of all samples of a chunk at once. The instruction set is chosen at
+ * compile time: AVX2 if enabled (ELLSL_ENABLE_AVX2), SSE2 on every x86-64 build, scalar otherwise.
+ */
+namespace kernel
+{
+    /** @brief replaces every ELInvalidValue in values[0 ... count-1] by NaN */
+    inline void maskInvalid( double* values, size_t count )
+    {
+        const double invalid = elapi::ELInvalidValue;
+        const double nan     = std::numeric_limits< double >::quiet_NaN( );
+        size_t       i       = 0;
+#if defined( __AVX2__ )
+        const __m256d invalid4 = _mm256_set1_pd( invalid );
+        const __m256d nan4     = _mm256_set1_pd( nan );
+        for ( ; i + 4 <= count; i += 4 ) {
+            const __m256d value = _mm256_loadu_pd( values + i );
+            const __m256d mask  = _mm256_cmp_pd( value, invalid4, _CMP_EQ_OQ );
+            _mm256_storeu_pd( values + i, _mm256_blendv_pd( value, nan4, mask ) );
+        }
+#endif
+#if defined( ELLSL_HAVE_SSE2 )
+        const __m128d invalid2 = _mm_set1_pd( invalid );
+        const __m128d nan2     = _mm_set1_pd( nan );
+        for ( ; i + 2 <= count; i += 2 ) {
+            const __m128d value = _mm_loadu_pd( values + i );
+            const __m128d mask  = _mm_cmpeq_pd( value, invalid2 );
+            _mm_storeu_pd( values + i,
+                           _mm_or_pd( _mm_and_pd( mask, nan2 ), _mm_andnot_pd( mask, value ) ) );
+        }
+#endif
+        for ( ; i < count; i++ ) {
+            if ( values[ i ] == invalid ) {
+                values[ i ] = nan;
+            }
+        }
+    }
+
+    /** @brief converts values[0 ... count-1] to float */
+    inline void narrow( const double* values, float* narrowed, size_t count )
+    {
+        size_t i = 0;
+#if defined( __AVX2__ )
+        for ( ; i + 4 <= count; i += 4 ) {
+            _mm_storeu_ps( narrowed + i, _mm256_cvtpd_ps( _mm256_loadu_pd( values + i ) ) );
+        }
+#endif
+#if defined( ELLSL_HAVE_SSE2 )
+        for ( ; i + 2 <= count; i += 2 ) {
+            _mm_storel_pi( reinterpret_cast< __m64* >( narrowed + i ),
+                           _mm_cvtpd_ps( _mm_loadu_pd( values + i ) ) );
+        }
+#endif
+        for ( ; i < count; i++ ) {
+            narrowed[ i ] = static_cast< float >( values[ i ] );
+        }
+    }
+
+    template< int32... Channels >
+    inline void gather( const elapi::ELGazeSample* samples, size_t count, double* values,
+                        std::integer_sequence< int32, Channels... > )
+    {
+        for ( size_t s = 0; s < count; s++ ) {
+            int32 i = 0;
+            ( ( values[ i++ ] = loadChannel< Channels >( samples[ s ] ) ), ... );
+            values += sizeof...( Channels );
+        }
+    }
+}  // namespace kernel
+
+/**
+ * @brief converts 'count' samples into out[count][channels of Selection]
+ *
+ * @param scratch   buffer of count * channels doubles, only used if Value is float
+ */
+template< typename Value, ChannelSelection Selection >
+inline void
+convertBatch( const elapi::ELGazeSample* samples, size_t count, Value* out, double* scratch )
+{
+    using Channels         = typename ChannelSet< Selection >::Channels;
+    const size_t nvalues   = count * channelCount( Channels{ } );
+    double*      converted = std::is_same< Value, double >::value
+                                 ? reinterpret_cast< double* >( out )
+                                 : scratch;
+
+    kernel::gather( samples, count, converted, Channels{ } );
+    kernel::maskInvalid( converted, nvalues );
+    if constexpr ( std::is_same< Value, float >::value ) {
+        kernel::narrow( converted, out, nvalues );
+    }
+}
+
+}  // namespace ellsl
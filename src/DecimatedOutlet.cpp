@@ -0,0 +1,194 @@
+// -----------------------------------------------------------------------
+// Copyright (C) 2019-2023, EyeLogic GmbH
+//
+// Permission is hereby granted, free of charge, to any person or
+// organization obtaining a copy of the software and accompanying
+// documentation covered by this license (the "Software") to use,
+// reproduce, display, distribute, execute, and transmit the Software,
+// and to prepare derivative works of the Software, and to permit
+// third-parties to whom the Software is furnished to do so.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, TITLE AND
+// NON-INFRINGEMENT. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR ANYONE
+// DISTRIBUTING THE SOFTWARE BE LIABLE FOR ANY DAMAGES OR OTHER
+// LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+// OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+// -----------------------------------------------------------------------
+
+
+#include "DecimatedOutlet.h"
+#include "GazeOutlet.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <sstream>
+
+using namespace ellsl;
+
+namespace
+{
+constexpr double PI = 3.14159265358979323846;
+// pass band edge relative to the output Nyquist frequency
+constexpr double CUTOFF = 0.8;
+
+std::vector< double >
+designLowPass( int32 factor )
+{
+    const int32  ntaps  = DecimatedOutlet::TAPS_PER_FACTOR * factor + 1;
+    const double center = ( ntaps - 1 ) / 2.0;
+    // cutoff in cycles per input sample
+    const double cutoff = CUTOFF * 0.5 / factor;
+
+    std::vector< double > taps( ntaps );
+    double                sum = 0.0;
+    for ( int32 k = 0; k < ntaps; k++ ) {
+        const double t      = k - center;
+        const double sinc =
+            t == 0.0 ? 2.0 * cutoff : std::sin( 2.0 * PI * cutoff * t ) / ( PI * t );
+        const double phase  = 2.0 * PI * k / ( ntaps - 1 );
+        const double window = 0.42 - 0.5 * std::cos( phase ) + 0.08 * std::cos( 2.0 * phase );
+        taps[ k ]           = sinc * window;
+        sum += taps[ k ];
+    }
+    // unity gain at DC
+    for ( double& tap : taps ) {
+        tap /= sum;
+    }
+    return taps;
+}
+
+double
+readChannel( const elapi::ELGazeSample& gazeSample, int32 channel )
+{
+    if ( channel == 0 ) {
+        return gazeSample.index;
+    }
+    double value;
+    std::memcpy( &value, reinterpret_cast< const char* >( &gazeSample ) + CHANNEL_OFFSET[ channel ],
+                 sizeof( value ) );
+    return value == elapi::ELInvalidValue ? std::numeric_limits< double >::quiet_NaN( ) : value;
+}
+}  // namespace
+
+DecimatedOutlet::DecimatedOutlet( const StreamProfile& profile, int32 samplerate, int32 factor,
+                                  uint64 deviceSerial, const ClockMapping* clockMapping,
+                                  const std::string& name )
+    : m_factor( factor ),
+      m_samplerate( samplerate / factor ),
+      m_taps( designLowPass( factor ) ),
+      m_channels( channelIndices( profile.channels, m_indices ) ),
+      m_outlet( [ & ] {
+          lsl::stream_info info =
+              makeGazeStreamInfo( profile, m_samplerate, deviceSerial, clockMapping, name, { },
+                                  " | " + std::to_string( m_samplerate ) + " Hz" );
+          info.desc( )
+              .append_child( "decimation" )
+              .append_child_value( "factor", std::to_string( factor ) )
+              .append_child_value( "source_rate", std::to_string( samplerate ) )
+              .append_child_value( "filter", "polyphase FIR, Blackman-windowed sinc" )
+              .append_child_value( "taps", std::to_string( m_taps.size( ) ) )
+              .append_child_value( "cutoff_hz",
+                                   std::to_string( CUTOFF * 0.5 * samplerate / factor ) )
+              .append_child_value( "delay_compensated", "true" );
+          return info;
+      }( ) ),
+      m_history( m_taps.size( ) * m_channels, 0.0 ),
+      m_timestamps( m_taps.size( ), 0.0 ),
+      m_sample( m_channels, 0.0 )
+{
+}
+
+void
+DecimatedOutlet::push( const elapi::ELGazeSample& gazeSample, double timestamp )
+{
+    double* slot = &m_history[ m_next * m_channels ];
+    for ( int32 c = 0; c < m_channels; c++ ) {
+        slot[ c ] = readChannel( gazeSample, m_indices[ c ] );
+    }
+    m_timestamps[ m_next ] = timestamp;
+    m_pushed++;
+
+    // the filter is evaluated for every m_factor-th input only
+    const uint64 ntaps = m_taps.size( );
+    if ( m_pushed >= ntaps && ( m_pushed - ntaps ) % m_factor == 0 ) {
+        emit( );
+    }
+    m_next = ( m_next + 1 ) % ntaps;
+}
+
+void
+DecimatedOutlet::reset( )
+{
+    m_next   = 0;
+    m_pushed = 0;
+}
+
+bool
+DecimatedOutlet::haveConsumers( )
+{
+    return m_outlet.have_consumers( );
+}
+
+int32
+DecimatedOutlet::factor( ) const
+{
+    return m_factor;
+}
+
+int32
+DecimatedOutlet::samplerate( ) const
+{
+    return m_samplerate;
+}
+
+void
+DecimatedOutlet::emit( )
+{
+    const size_t ntaps  = m_taps.size( );
+    const size_t center = ( m_next + ntaps - ( ntaps - 1 ) / 2 ) % ntaps;
+
+    // the frame number is passed through, the values are filtered
+    m_sample[ 0 ] = m_history[ center * m_channels ];
+    for ( int32 c = 1; c < m_channels; c++ ) {
+        double sum    = 0.0;
+        double weight = 0.0;
+        size_t slot   = m_next;
+        for ( size_t k = 0; k < ntaps; k++ ) {
+            const double value = m_history[ slot * m_channels + c ];
+            if ( !std::isnan( value ) ) {
+                sum += m_taps[ k ] * value;
+                weight += m_taps[ k ];
+            }
+            slot = slot == 0 ? ntaps - 1 : slot - 1;
+        }
+        m_sample[ c ] = weight >= MIN_VALID_WEIGHT ? sum / weight
+                                                   : std::numeric_limits< double >::quiet_NaN( );
+    }
+    m_outlet.push_sample( m_sample, m_timestamps[ center ] );
+}
+
+bool
+ellsl::parseRates( const std::string& text, std::vector< int32 >& rates )
+{
+    std::vector< int32 > parsed;
+    std::istringstream   stream( text );
+    std::string          item;
+    while ( std::getline( stream, item, ',' ) ) {
+        char*      end;
+        const long rate = std::strtol( item.c_str( ), &end, 10 );
+        if ( item.empty( ) || *end != '\0' || rate <= 0 ) {
+            return false;
+        }
+        parsed.push_back( static_cast< int32 >( rate ) );
+    }
+    if ( parsed.empty( ) ) {
+        return false;
+    }
+    rates = parsed;
+    return true;
+}
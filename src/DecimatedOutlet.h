@@ -0,0 +1,91 @@
+// -----------------------------------------------------------------------
+// Copyright (C) 2019-2023, EyeLogic GmbH
+//
+// Permission is hereby granted, free of charge, to any person or
+// organization obtaining a copy of the software and accompanying
+// documentation covered by this license (the "Software") to use,
+// reproduce, display, distribute, execute, and transmit the Software,
+// and to prepare derivative works of the Software, and to permit
+// third-parties to whom the Software is furnished to do so.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, TITLE AND
+// NON-INFRINGEMENT. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR ANYONE
+// DISTRIBUTING THE SOFTWARE BE LIABLE FOR ANY DAMAGES OR OTHER
+// LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+// OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+// -----------------------------------------------------------------------
+
+
+#pragma once
+
+#include "ClockMapping.h"
+#include "StreamProfile.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace ellsl
+{
+/**
+ * @brief secondary gaze outlet at an integer fraction of the tracking rate
+ *
+ * A linear-phase, Blackman-windowed sinc low-pass of TAPS_PER_FACTOR * factor + 1 taps, computed
+ * when the outlet opens, suppresses everything above 80% of the output Nyquist frequency. The
+ * filter is only evaluated for the samples that are kept (polyphase decimation). Invalid inputs
+ * are left out and the remaining taps renormalized; an output channel is NaN if the valid taps
+ * carry less than MIN_VALID_WEIGHT of the filter. Outputs are stamped with the time of the
+ * center tap, so they lag TAPS_PER_FACTOR / 2 output periods behind. The frame number channel
+ * is passed through from the center tap.
+ *
+ * Not thread-safe, the owner has to serialize all calls.
+ */
+class DecimatedOutlet
+{
+public:
+    static constexpr int32  TAPS_PER_FACTOR  = 8;
+    static constexpr double MIN_VALID_WEIGHT = 0.75;
+
+    /** @param factor tracking rate / output rate, at least 2 */
+    DecimatedOutlet( const StreamProfile& profile, int32 samplerate, int32 factor,
+                     uint64 deviceSerial, const ClockMapping* clockMapping,
+                     const std::string& name );
+
+    DecimatedOutlet( const DecimatedOutlet& ) = delete;
+    DecimatedOutlet& operator=( const DecimatedOutlet& ) = delete;
+
+    /** @brief appends the next sample at the tracking rate, consecutive indices are expected */
+    void push( const elapi::ELGazeSample& gazeSample, double timestamp );
+    /** @brief forgets the history, e.g. after an outage too long to be filled */
+    void reset( );
+
+    bool  haveConsumers( );
+    int32 factor( ) const;
+    /** @brief output rate [Hz] */
+    int32 samplerate( ) const;
+
+private:
+    void emit( );
+
+    const int32              m_factor;
+    const int32              m_samplerate;
+    std::vector< double >    m_taps;
+    int32                    m_indices[ NCHANNELS ];
+    int32                    m_channels;
+    lsl::stream_outlet       m_outlet;
+
+    // the last m_taps.size( ) inputs, [tap][channel]
+    std::vector< double > m_history;
+    std::vector< double > m_timestamps;
+    size_t                m_next   = 0;
+    uint64                m_pushed = 0;
+    std::vector< double > m_sample;
+};
+
+/** @brief parses a comma-separated list of output rates, e.g. "60,120" */
+bool parseRates( const std::string& text, std::vector< int32 >& rates );
+
+}  // namespace ellsl
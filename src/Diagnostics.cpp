@@ -0,0 +1,150 @@
+// -----------------------------------------------------------------------
+// Copyright (C) 2019-2023, EyeLogic GmbH
+//
+// Permission is hereby granted, free of charge, to any person or
+// organization obtaining a copy of the software and accompanying
+// documentation covered by this license (the "Software") to use,
+// reproduce, display, distribute, execute, and transmit the Software,
+// and to prepare derivative works of the Software, and to permit
+// third-parties to whom the Software is furnished to do so.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, TITLE AND
+// NON-INFRINGEMENT. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR ANYONE
+// DISTRIBUTING THE SOFTWARE BE LIABLE FOR ANY DAMAGES OR OTHER
+// LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+// OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+// -----------------------------------------------------------------------
+
+
+#include "Diagnostics.h"
+
+#ifdef ELLSL_ENABLE_DIAGNOSTICS
+
+#include <string>
+#include <vector>
+
+using namespace ellsl;
+
+namespace
+{
+const std::chrono::seconds PUBLISH_INTERVAL( 1 );
+
+const char* const STAGE_LABEL[ Diagnostics::NSTAGES ] = {
+    "DeviceToCallback",
+    "CallbackToConverted",
+    "ConvertedToPushed",
+    "DeviceToPushed",
+};
+
+const double PERCENTILES[]      = { 0.5, 0.99, 0.999 };
+const char*  PERCENTILE_LABEL[] = { "p50", "p99", "p99.9" };
+
+// sample rate, lost, duplicate and filled samples, ring overflows, clock offset, skew and jitter,
+// then percentiles and maximum of every stage
+constexpr int32 NSTAGE_CHANNELS = sizeof( PERCENTILES ) / sizeof( PERCENTILES[ 0 ] ) + 1;
+constexpr int32 NCHANNELS       = 8 + Diagnostics::NSTAGES * NSTAGE_CHANNELS;
+
+lsl::stream_info
+makeDiagnosticsStreamInfo( int32 samplerate, uint64 deviceSerial, const std::string& name )
+{
+    lsl::stream_info lslInfo( name, "Diagnostics", NCHANNELS,
+                              1.0 / PUBLISH_INTERVAL.count( ), lsl::cf_double64,
+                              "EyeLogic One | " + std::to_string( deviceSerial ) +
+                                  " | diagnostics" );
+
+    lsl::xml_element channels = lslInfo.desc( ).append_child( "channels" );
+    const auto       append   = [ &channels ]( const std::string& label, const char* unit ) {
+        channels.append_child( "channel" )
+            .append_child_value( "label", label )
+            .append_child_value( "unit", unit );
+    };
+    append( "SampleRate", "hertz" );
+    append( "LostSamples", "number" );
+    append( "DuplicateSamples", "number" );
+    append( "FilledSamples", "number" );
+    append( "RingOverflows", "number" );
+    append( "ClockOffset", "seconds" );
+    append( "ClockSkew", "ppm" );
+    append( "ClockJitter", "microseconds" );
+    for ( const char* stage : STAGE_LABEL ) {
+        for ( const char* percentile : PERCENTILE_LABEL ) {
+            append( std::string( stage ) + "_" + percentile, "microseconds" );
+        }
+        append( std::string( stage ) + "_max", "microseconds" );
+    }
+
+    lslInfo.desc( )
+        .append_child( "acquisition" )
+        .append_child_value( "manufacturer", "EyeLogic" )
+        .append_child_value( "model", "One" )
+        .append_child_value( "serial number", std::to_string( deviceSerial ) )
+        .append_child_value( "gaze_samplerate", std::to_string( samplerate ) );
+    return lslInfo;
+}
+}  // namespace
+
+Diagnostics::Diagnostics( int32 samplerate, uint64 deviceSerial, uint64 ringOverflows,
+                          const std::string& name )
+    : m_outlet( makeDiagnosticsStreamInfo( samplerate, deviceSerial, name ) ),
+      m_windowBegin( std::chrono::steady_clock::now( ) ),
+      m_ringOverflows( ringOverflows )
+{
+}
+
+void
+Diagnostics::recordChunk( const elapi::ELGazeSample* samples, const int64* callbackMicroSec,
+                          size_t count, int64 convertedMicroSec, int64 pushedMicroSec )
+{
+    for ( size_t i = 0; i < count; i++ ) {
+        const int64 callback = callbackMicroSec[ i ];
+        if ( callback == 0 ) {
+            continue;
+        }
+        const int64 device = samples[ i ].timestampMicroSec;
+        m_histograms[ DEVICE_TO_CALLBACK ].record( callback - device );
+        m_histograms[ CALLBACK_TO_CONVERTED ].record( convertedMicroSec - callback );
+        m_histograms[ CONVERTED_TO_PUSHED ].record( pushedMicroSec - convertedMicroSec );
+        m_histograms[ DEVICE_TO_PUSHED ].record( pushedMicroSec - device );
+        m_samples++;
+    }
+}
+
+void
+Diagnostics::publishIfDue( uint64 ringOverflows, const ClockMapping::Fit& clockFit,
+                           const IndexContinuity::Statistics& continuity )
+{
+    const auto now     = std::chrono::steady_clock::now( );
+    const auto elapsed = now - m_windowBegin;
+    if ( elapsed < PUBLISH_INTERVAL ) {
+        return;
+    }
+
+    double sample[ NCHANNELS ];
+    int32  channel = 0;
+    sample[ channel++ ] = m_samples / std::chrono::duration< double >( elapsed ).count( );
+    sample[ channel++ ] = static_cast< double >( continuity.missing - m_continuity.missing );
+    sample[ channel++ ] = static_cast< double >( continuity.duplicates - m_continuity.duplicates );
+    sample[ channel++ ] = static_cast< double >( continuity.filled - m_continuity.filled );
+    sample[ channel++ ] = static_cast< double >( ringOverflows - m_ringOverflows );
+    sample[ channel++ ] = clockFit.offset;
+    sample[ channel++ ] = clockFit.skewPpm;
+    sample[ channel++ ] = clockFit.jitterMicroSec;
+    for ( auto& histogram : m_histograms ) {
+        const auto snapshot = histogram.snapshot( true );
+        for ( double percentile : PERCENTILES ) {
+            sample[ channel++ ] = static_cast< double >( snapshot.percentile( percentile ) );
+        }
+        sample[ channel++ ] = static_cast< double >( snapshot.max );
+    }
+    m_outlet.push_sample( sample );
+
+    m_windowBegin   = now;
+    m_samples       = 0;
+    m_ringOverflows = ringOverflows;
+    m_continuity    = continuity;
+}
+
+#endif
@@ -0,0 +1,106 @@
+// -----------------------------------------------------------------------
+// Copyright (C) 2019-2023, EyeLogic GmbH
+//
+// Permission is hereby granted, free of charge, to any person or
+// organization obtaining a copy of the software and accompanying
+// documentation covered by this license (the "Software") to use,
+// reproduce, display, distribute, execute, and transmit the Software,
+// and to prepare derivative works of the Software, and to permit
+// third-parties to whom the Software is furnished to do so.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, TITLE AND
+// NON-INFRINGEMENT. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR ANYONE
+// DISTRIBUTING THE SOFTWARE BE LIABLE FOR ANY DAMAGES OR OTHER
+// LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+// OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+// -----------------------------------------------------------------------
+
+
+#pragma once
+
+#include <cstdint>
+
+using int32  = int32_t;
+using int64  = int64_t;
+using uint32 = uint32_t;
+using uint64 = uint64_t;
+
+#include "ClockMapping.h"
+#include "IndexContinuity.h"
+#include "LatencyHistogram.h"
+#include "elapi/ELGazeSample.h"
+#include "lsl_cpp.h"
+
+#include <chrono>
+
+namespace ellsl
+{
+/**
+ * @brief timings of the hot path, published once per second on the "EyeLogicDiagnostics" outlet
+ *
+ * Every sample is stamped with its device timestamp, the entry of the gaze sample callback, the
+ * end of its conversion and the end of its push into liblsl. Only compiled in with
+ * ELLSL_ENABLE_DIAGNOSTICS. Not thread-safe except for reading the histograms.
+ */
+class Diagnostics
+{
+public:
+    /** @brief pairs of hot path timestamps measured as latencies */
+    enum Stage {
+        DEVICE_TO_CALLBACK,
+        CALLBACK_TO_CONVERTED,
+        CONVERTED_TO_PUSHED,
+        DEVICE_TO_PUSHED,
+        NSTAGES,
+    };
+
+    /** @brief system clock in [us], same time base as the device timestamps */
+    static int64 clock( )
+    {
+        return std::chrono::duration_cast< std::chrono::microseconds >(
+                   std::chrono::system_clock::now( ).time_since_epoch( ) )
+            .count( );
+    }
+
+    /**
+     * @param ringOverflows current overflow count of the hand-over ring
+     * @param name of the diagnostics stream
+     */
+    Diagnostics( int32 samplerate, uint64 deviceSerial, uint64 ringOverflows,
+                 const std::string& name = "EyeLogicDiagnostics" );
+
+    Diagnostics( const Diagnostics& ) = delete;
+    Diagnostics& operator=( const Diagnostics& ) = delete;
+
+    /**
+     * @brief records the timings of a chunk of samples pushed into liblsl
+     * @param callbackMicroSec callback entry time of every sample, 0 for gap placeholders which
+     * are not timed
+     */
+    void recordChunk( const elapi::ELGazeSample* samples, const int64* callbackMicroSec,
+                      size_t count, int64 convertedMicroSec, int64 pushedMicroSec );
+
+    /**
+     * @brief publishes and resets the statistics once a second has passed since the last time
+     * @param ringOverflows current overflow count of the hand-over ring
+     * @param clockFit current mapping of the device clock into the LSL clock
+     * @param continuity index continuity of the session
+     */
+    void publishIfDue( uint64 ringOverflows, const ClockMapping::Fit& clockFit,
+                       const IndexContinuity::Statistics& continuity );
+
+    LatencyHistogram& histogram( Stage stage ) { return m_histograms[ stage ]; }
+
+private:
+    lsl::stream_outlet                    m_outlet;
+    LatencyHistogram                      m_histograms[ NSTAGES ];
+    std::chrono::steady_clock::time_point m_windowBegin;
+    uint64                                m_samples       = 0;
+    uint64                                m_ringOverflows = 0;
+    IndexContinuity::Statistics           m_continuity;
+};
+
+}  // namespace ellsl
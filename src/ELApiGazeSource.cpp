@@ -0,0 +1,133 @@
+// -----------------------------------------------------------------------
+// Copyright (C) 2019-2023, EyeLogic GmbH
+//
+// Permission is hereby granted, free of charge, to any person or
+// organization obtaining a copy of the software and accompanying
+// documentation covered by this license (the "Software") to use,
+// reproduce, display, distribute, execute, and transmit the Software,
+// and to prepare derivative works of the Software, and to permit
+// third-parties to whom the Software is furnished to do so.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, TITLE AND
+// NON-INFRINGEMENT. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR ANYONE
+// DISTRIBUTING THE SOFTWARE BE LIABLE FOR ANY DAMAGES OR OTHER
+// LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+// OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+// -----------------------------------------------------------------------
+
+
+#include "ELApiGazeSource.h"
+
+using namespace ellsl;
+
+ELApiGazeSource::ELApiGazeSource( const char* clientName ) : m_api( clientName )
+{
+}
+
+void
+ELApiGazeSource::registerEventListener( elapi::ELApi::ELEventCallback* callback )
+{
+    m_api.registerEventListener( callback );
+}
+
+void
+ELApiGazeSource::registerGazeSampleListener( elapi::ELApi::ELGazeSampleCallback* callback )
+{
+    m_api.registerGazeSampleListener( callback );
+}
+
+elapi::ELApi::ReturnConnect
+ELApiGazeSource::connect( )
+{
+    return m_api.connect( );
+}
+
+elapi::ELApi::ReturnConnect
+ELApiGazeSource::connectRemote( elapi::ELApi::ServerInfo server )
+{
+    return m_api.connectRemote( server );
+}
+
+int32
+ELApiGazeSource::requestServerList( int32 blockingDurationMS, elapi::ELApi::ServerInfo* serverList,
+                                    int32 serverListLength )
+{
+    return m_api.requestServerList( blockingDurationMS, serverList, serverListLength );
+}
+
+void
+ELApiGazeSource::disconnect( )
+{
+    m_api.disconnect( );
+}
+
+bool
+ELApiGazeSource::isConnected( ) const
+{
+    return m_api.isConnected( );
+}
+
+void
+ELApiGazeSource::getActiveScreen( elapi::ELApi::ScreenConfig& screenConfig ) const
+{
+    m_api.getActiveScreen( screenConfig );
+}
+
+void
+ELApiGazeSource::getDeviceInfo( DeviceInfo& deviceInfo ) const
+{
+    elapi::ELApi::DeviceConfig deviceConfig;
+    m_api.getDeviceConfig( deviceConfig );
+
+    deviceInfo.deviceSerial = deviceConfig.deviceSerial;
+    deviceInfo.frameRates.assign( deviceConfig.frameRates,
+                                  deviceConfig.frameRates + deviceConfig.numFrameRates );
+    deviceInfo.calibrationMethods.assign( deviceConfig.calibrationMethods,
+                                          deviceConfig.calibrationMethods +
+                                              deviceConfig.numCalibrationMethods );
+}
+
+elapi::ELApi::ReturnNextData
+ELApiGazeSource::getNextEvent( elapi::ELApi::Event& event, int32 timeoutMillis )
+{
+    return m_api.getNextEvent( event, timeoutMillis );
+}
+
+elapi::ELApi::ReturnNextData
+ELApiGazeSource::getNextGazeSample( elapi::ELGazeSample& gazeSample, int32 timeoutMillis )
+{
+    return m_api.getNextGazeSample( gazeSample, timeoutMillis );
+}
+
+elapi::ELApi::ReturnStart
+ELApiGazeSource::requestTracking( int32 frameRateModeInd )
+{
+    return m_api.requestTracking( frameRateModeInd );
+}
+
+void
+ELApiGazeSource::unrequestTracking( )
+{
+    m_api.unrequestTracking( );
+}
+
+elapi::ELApi::ReturnCalibrate
+ELApiGazeSource::calibrate( int32 calibrationModeInd )
+{
+    return m_api.calibrate( calibrationModeInd );
+}
+
+void
+ELApiGazeSource::abortCalibValidation( )
+{
+    m_api.abortCalibValidation( );
+}
+
+elapi::ELApi::ReturnValidate
+ELApiGazeSource::validate( elapi::ELApi::ELValidationResult& validationResult )
+{
+    return m_api.validate( validationResult );
+}
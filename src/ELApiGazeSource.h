@@ -0,0 +1,64 @@
+// -----------------------------------------------------------------------
+// Copyright (C) 2019-2023, EyeLogic GmbH
+//
+// Permission is hereby granted, free of charge, to any person or
+// organization obtaining a copy of the software and accompanying
+// documentation covered by this license (the "Software") to use,
+// reproduce, display, distribute, execute, and transmit the Software,
+// and to prepare derivative works of the Software, and to permit
+// third-parties to whom the Software is furnished to do so.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, TITLE AND
+// NON-INFRINGEMENT. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR ANYONE
+// DISTRIBUTING THE SOFTWARE BE LIABLE FOR ANY DAMAGES OR OTHER
+// LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+// OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+// -----------------------------------------------------------------------
+
+
+#pragma once
+
+#include "GazeSource.h"
+
+namespace ellsl
+{
+/** @brief gaze source backed by a connection to an EyeLogic server through the EyeLogic SDK */
+class ELApiGazeSource final : public GazeSource
+{
+public:
+    explicit ELApiGazeSource( const char* clientName );
+
+    void registerEventListener( elapi::ELApi::ELEventCallback* callback ) override;
+    void registerGazeSampleListener( elapi::ELApi::ELGazeSampleCallback* callback ) override;
+
+    elapi::ELApi::ReturnConnect connect( ) override;
+    elapi::ELApi::ReturnConnect connectRemote( elapi::ELApi::ServerInfo server ) override;
+    int32 requestServerList( int32 blockingDurationMS, elapi::ELApi::ServerInfo* serverList,
+                             int32 serverListLength ) override;
+    void disconnect( ) override;
+    bool isConnected( ) const override;
+
+    void getActiveScreen( elapi::ELApi::ScreenConfig& screenConfig ) const override;
+    void getDeviceInfo( DeviceInfo& deviceInfo ) const override;
+
+    elapi::ELApi::ReturnNextData getNextEvent( elapi::ELApi::Event& event,
+                                               int32 timeoutMillis ) override;
+    elapi::ELApi::ReturnNextData getNextGazeSample( elapi::ELGazeSample& gazeSample,
+                                                    int32 timeoutMillis ) override;
+
+    elapi::ELApi::ReturnStart requestTracking( int32 frameRateModeInd ) override;
+    void unrequestTracking( ) override;
+
+    elapi::ELApi::ReturnCalibrate calibrate( int32 calibrationModeInd ) override;
+    void abortCalibValidation( ) override;
+    elapi::ELApi::ReturnValidate validate(
+        elapi::ELApi::ELValidationResult& validationResult ) override;
+
+private:
+    elapi::ELApi m_api;
+};
+
+}  // namespace ellsl
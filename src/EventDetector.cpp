@@ -0,0 +1,355 @@
+// -----------------------------------------------------------------------
+// Copyright (C) 2019-2023, EyeLogic GmbH
+//
+// Permission is hereby granted, free of charge, to any person or
+// organization obtaining a copy of the software and accompanying
+// documentation covered by this license (the "Software") to use,
+// reproduce, display, distribute, execute, and transmit the Software,
+// and to prepare derivative works of the Software, and to permit
+// third-parties to whom the Software is furnished to do so.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, TITLE AND
+// NON-INFRINGEMENT. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR ANYONE
+// DISTRIBUTING THE SOFTWARE BE LIABLE FOR ANY DAMAGES OR OTHER
+// LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+// OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+// -----------------------------------------------------------------------
+
+
+#include "EventDetector.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+using namespace ellsl;
+
+namespace
+{
+constexpr double PI = 3.14159265358979323846;
+// assumed until the tracker measures the eye position
+constexpr double DEFAULT_DISTANCE_MM = 600.0;
+// 96 dpi, if the screen reports no physical size
+constexpr double DEFAULT_MM_PER_PIXEL = 25.4 / 96.0;
+
+bool
+isValid( double value )
+{
+    return value != elapi::ELInvalidValue;
+}
+
+size_t
+windowSize( const EventDetector::Config& config, int32 samplerate )
+{
+    const int32 millis = config.algorithm == EventDetector::Algorithm::IVT
+                             ? config.velocityWindowMillis
+                             : config.dispersionWindowMillis;
+    return std::max< size_t >( 2, static_cast< size_t >( std::max( millis, 0 ) ) *
+                                      static_cast< size_t >( std::max( samplerate, 1 ) ) / 1000 );
+}
+
+const char*
+typeName( EventDetector::Type type )
+{
+    switch ( type ) {
+        case EventDetector::Type::FIXATION:
+            return "FIXATION";
+        case EventDetector::Type::SACCADE:
+            return "SACCADE";
+        case EventDetector::Type::BLINK:
+            return "BLINK";
+    }
+    return "UNKNOWN";
+}
+}  // namespace
+
+EventDetector::Extremum::Extremum( size_t capacity, bool maximum )
+    : m_capacity( capacity ),
+      m_maximum( maximum ),
+      m_sequence( std::make_unique< uint64[] >( capacity ) ),
+      m_value( std::make_unique< double[] >( capacity ) )
+{
+}
+
+void
+EventDetector::Extremum::push( uint64 sequence, double value, uint64 oldest )
+{
+    // drop the values that left the window, then those that can never be the extremum again
+    while ( m_count > 0 && m_sequence[ m_head ] < oldest ) {
+        m_head = ( m_head + 1 ) % m_capacity;
+        m_count--;
+    }
+    while ( m_count > 0 ) {
+        const double back = m_value[ ( m_head + m_count - 1 ) % m_capacity ];
+        if ( m_maximum ? back > value : back < value ) {
+            break;
+        }
+        m_count--;
+    }
+    m_sequence[ ( m_head + m_count ) % m_capacity ] = sequence;
+    m_value[ ( m_head + m_count ) % m_capacity ]    = value;
+    m_count++;
+}
+
+double
+EventDetector::Extremum::value( ) const
+{
+    return m_value[ m_head ];
+}
+
+void
+EventDetector::Extremum::clear( )
+{
+    m_head  = 0;
+    m_count = 0;
+}
+
+EventDetector::EventDetector( const Config& config, const elapi::ELApi::ScreenConfig& screen,
+                              int32 samplerate )
+    : m_config( config ),
+      m_distanceMM( DEFAULT_DISTANCE_MM ),
+      m_windowSize( windowSize( config, samplerate ) ),
+      m_windowTimestamp( std::make_unique< double[] >( m_windowSize ) ),
+      m_windowX( std::make_unique< double[] >( m_windowSize ) ),
+      m_windowY( std::make_unique< double[] >( m_windowSize ) ),
+      m_minX( m_windowSize, false ),
+      m_maxX( m_windowSize, true ),
+      m_minY( m_windowSize, false ),
+      m_maxY( m_windowSize, true )
+{
+    setScreen( screen );
+}
+
+void
+EventDetector::setScreen( const elapi::ELApi::ScreenConfig& screen )
+{
+    const bool known = screen.resolutionX > 0 && screen.resolutionY > 0 &&
+                       screen.physicalSizeX_mm > 0.0 && screen.physicalSizeY_mm > 0.0;
+    m_mmPerPixelX = known ? screen.physicalSizeX_mm / screen.resolutionX : DEFAULT_MM_PER_PIXEL;
+    m_mmPerPixelY = known ? screen.physicalSizeY_mm / screen.resolutionY : DEFAULT_MM_PER_PIXEL;
+}
+
+int32
+EventDetector::process( const elapi::ELGazeSample& gazeSample, double timestamp, Event* events )
+{
+    const double x = gazeSample.porFilteredX;
+    const double y = gazeSample.porFilteredY;
+    if ( !isValid( x ) || !isValid( y ) ) {
+        if ( m_state == State::BLINK ) {
+            return 0;
+        }
+        // the blink began right after the last valid sample
+        const int32 count = transit( State::BLINK,
+                                     m_havePrevious ? m_previousTimestamp : timestamp,
+                                     m_previousX, m_previousY, events );
+        m_havePrevious = false;
+        resetWindow( );
+        return count;
+    }
+    updateDistance( gazeSample );
+
+    int32 count = 0;
+    if ( m_state == State::BLINK ) {
+        count = transit( State::NONE, timestamp, x, y, events );
+    }
+    double      transition = timestamp;
+    double      onsetX     = x;
+    double      onsetY     = y;
+    const State state      = classify( gazeSample, timestamp, transition, onsetX, onsetY );
+    if ( state != State::NONE && state != m_state ) {
+        count += transit( state, transition, onsetX, onsetY, events + count );
+        if ( state == State::FIXATION && m_config.algorithm == Algorithm::IDT ) {
+            // the whole window belongs to the fixation
+            m_sumX         = m_windowSumX - x;
+            m_sumY         = m_windowSumY - y;
+            m_stateSamples = std::min< uint64 >( m_windowSamples, m_windowSize ) - 1;
+        }
+    }
+    m_sumX += x;
+    m_sumY += y;
+    m_stateSamples++;
+
+    m_havePrevious      = true;
+    m_previousTimestamp = timestamp;
+    m_previousX         = x;
+    m_previousY         = y;
+    return count;
+}
+
+double
+EventDetector::degrees( double dxPixels, double dyPixels ) const
+{
+    const double mm = std::hypot( dxPixels * m_mmPerPixelX, dyPixels * m_mmPerPixelY );
+    return std::atan2( mm, m_distanceMM ) * 180.0 / PI;
+}
+
+void
+EventDetector::updateDistance( const elapi::ELGazeSample& gazeSample )
+{
+    const bool left  = isValid( gazeSample.eyePositionLeftZ ) && gazeSample.eyePositionLeftZ > 0;
+    const bool right = isValid( gazeSample.eyePositionRightZ ) && gazeSample.eyePositionRightZ > 0;
+    if ( left && right ) {
+        m_distanceMM = ( gazeSample.eyePositionLeftZ + gazeSample.eyePositionRightZ ) / 2.0;
+    } else if ( left ) {
+        m_distanceMM = gazeSample.eyePositionLeftZ;
+    } else if ( right ) {
+        m_distanceMM = gazeSample.eyePositionRightZ;
+    }
+}
+
+EventDetector::State
+EventDetector::classify( const elapi::ELGazeSample& gazeSample, double timestamp,
+                         double& transition, double& x, double& y )
+{
+    const double currentX = gazeSample.porFilteredX;
+    const double currentY = gazeSample.porFilteredY;
+
+    const uint64 sequence = m_windowSamples++;
+    const size_t slot     = sequence % m_windowSize;
+    if ( sequence >= m_windowSize ) {
+        m_windowSumX -= m_windowX[ slot ];
+        m_windowSumY -= m_windowY[ slot ];
+    }
+    m_windowTimestamp[ slot ] = timestamp;
+    m_windowX[ slot ]         = currentX;
+    m_windowY[ slot ]         = currentY;
+    m_windowSumX += currentX;
+    m_windowSumY += currentY;
+    // oldest sample still within the window
+    const size_t first = m_windowSamples < m_windowSize
+                             ? 0
+                             : static_cast< size_t >( m_windowSamples % m_windowSize );
+
+    if ( m_config.algorithm == Algorithm::IVT ) {
+        const double dt = timestamp - m_windowTimestamp[ first ];
+        if ( !m_havePrevious || dt <= 0.0 ) {
+            return State::NONE;
+        }
+        const double velocity =
+            degrees( currentX - m_windowX[ first ], currentY - m_windowY[ first ] ) / dt;
+        // the movement began with the previous sample
+        transition = m_previousTimestamp;
+        x          = m_previousX;
+        y          = m_previousY;
+        return velocity > m_config.velocityThreshold ? State::SACCADE : State::FIXATION;
+    }
+
+    const uint64 oldest = sequence + 1 >= m_windowSize ? sequence + 1 - m_windowSize : 0;
+    m_minX.push( sequence, currentX, oldest );
+    m_maxX.push( sequence, currentX, oldest );
+    m_minY.push( sequence, currentY, oldest );
+    m_maxY.push( sequence, currentY, oldest );
+    if ( m_windowSamples < m_windowSize ) {
+        return State::NONE;
+    }
+
+    const double dispersion = degrees( m_maxX.value( ) - m_minX.value( ), 0.0 ) +
+                              degrees( 0.0, m_maxY.value( ) - m_minY.value( ) );
+    if ( dispersion <= m_config.dispersionThreshold ) {
+        // the fixation began with the oldest sample of the window
+        transition = m_windowTimestamp[ first ];
+        x          = m_windowX[ first ];
+        y          = m_windowY[ first ];
+        return State::FIXATION;
+    }
+    if ( m_havePrevious ) {
+        transition = m_previousTimestamp;
+        x          = m_previousX;
+        y          = m_previousY;
+    }
+    return State::SACCADE;
+}
+
+int32
+EventDetector::transit( State state, double timestamp, double x, double y, Event* events )
+{
+    static const Type TYPES[] = { Type::FIXATION, Type::FIXATION, Type::SACCADE, Type::BLINK };
+
+    // an event never ends before it began
+    timestamp   = std::max( timestamp, m_stateTimestamp );
+    int32 count = 0;
+    if ( m_state != State::NONE ) {
+        Event& offset    = events[ count++ ];
+        offset.type      = TYPES[ static_cast< int32 >( m_state ) ];
+        offset.onset     = false;
+        offset.timestamp = timestamp;
+        offset.duration  = timestamp - m_stateTimestamp;
+        offset.x         = x;
+        offset.y         = y;
+        offset.amplitude = 0.0;
+        if ( m_state == State::FIXATION && m_stateSamples > 0 ) {
+            offset.x = m_sumX / m_stateSamples;
+            offset.y = m_sumY / m_stateSamples;
+        } else if ( m_state == State::SACCADE ) {
+            offset.amplitude = degrees( x - m_stateX, y - m_stateY );
+        }
+    }
+
+    m_state          = state;
+    m_stateTimestamp = timestamp;
+    m_stateX         = x;
+    m_stateY         = y;
+    m_sumX           = 0.0;
+    m_sumY           = 0.0;
+    m_stateSamples   = 0;
+    if ( state != State::NONE ) {
+        Event& onset    = events[ count++ ];
+        onset.type      = TYPES[ static_cast< int32 >( state ) ];
+        onset.onset     = true;
+        onset.timestamp = timestamp;
+        onset.duration  = 0.0;
+        onset.x         = x;
+        onset.y         = y;
+        onset.amplitude = 0.0;
+    }
+    return count;
+}
+
+void
+EventDetector::resetWindow( )
+{
+    m_windowSamples = 0;
+    m_windowSumX    = 0.0;
+    m_windowSumY    = 0.0;
+    m_minX.clear( );
+    m_maxX.clear( );
+    m_minY.clear( );
+    m_maxY.clear( );
+}
+
+bool
+ellsl::parseAlgorithm( const std::string& text, EventDetector::Algorithm& algorithm )
+{
+    if ( text == "ivt" ) {
+        algorithm = EventDetector::Algorithm::IVT;
+    } else if ( text == "idt" ) {
+        algorithm = EventDetector::Algorithm::IDT;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+std::string
+ellsl::toString( const EventDetector::Event& event )
+{
+    char text[ 128 ];
+    int  length = std::snprintf( text, sizeof( text ), "%s_%s", typeName( event.type ),
+                                event.onset ? "ONSET" : "OFFSET" );
+    if ( !event.onset ) {
+        length += std::snprintf( text + length, sizeof( text ) - length, " duration=%.3f",
+                                 event.duration );
+    }
+    if ( event.type == EventDetector::Type::SACCADE && !event.onset ) {
+        length += std::snprintf( text + length, sizeof( text ) - length, " amplitude=%.2f",
+                                 event.amplitude );
+    }
+    if ( event.type != EventDetector::Type::BLINK ) {
+        std::snprintf( text + length, sizeof( text ) - length, " x=%.1f y=%.1f", event.x,
+                       event.y );
+    }
+    return text;
+}
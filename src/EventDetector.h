@@ -0,0 +1,185 @@
+// -----------------------------------------------------------------------
+// Copyright (C) 2019-2023, EyeLogic GmbH
+//
+// Permission is hereby granted, free of charge, to any person or
+// organization obtaining a copy of the software and accompanying
+// documentation covered by this license (the "Software") to use,
+// reproduce, display, distribute, execute, and transmit the Software,
+// and to prepare derivative works of the Software, and to permit
+// third-parties to whom the Software is furnished to do so.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, TITLE AND
+// NON-INFRINGEMENT. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR ANYONE
+// DISTRIBUTING THE SOFTWARE BE LIABLE FOR ANY DAMAGES OR OTHER
+// LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+// OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+// -----------------------------------------------------------------------
+
+
+#pragma once
+
+#include <cstdint>
+
+using int32  = int32_t;
+using int64  = int64_t;
+using uint32 = uint32_t;
+using uint64 = uint64_t;
+
+#include "elapi/ELApi.h"
+#include "elapi/ELGazeSample.h"
+
+#include <memory>
+#include <string>
+
+namespace ellsl
+{
+/** @brief default name of the oculomotor event stream */
+constexpr char EVENT_STREAM_NAME[] = "EyeLogicEvents";
+
+/**
+ * @brief incremental fixation, saccade and blink detection on the filtered binocular POR
+ *
+ * I-VT classifies every sample by its mean angular velocity over a short sliding window, I-DT by
+ * the dispersion of a longer one. Both take O(1) per sample - the window extrema are kept in
+ * monotonic queues - and report an onset or offset with the sample that reveals it, i.e. about
+ * one sample late for I-VT. Samples without a valid POR form blinks.
+ * Pixels are converted to degrees with the screen geometry and the measured eye distance.
+ *
+ * Not thread-safe, the owner has to serialize all calls.
+ */
+class EventDetector
+{
+public:
+    enum class Algorithm {
+        /** @brief velocity threshold */
+        IVT,
+        /** @brief dispersion threshold */
+        IDT,
+    };
+
+    struct Config {
+        Algorithm algorithm = Algorithm::IVT;
+        /** @brief I-VT: samples faster than this belong to a saccade [deg/s] */
+        double velocityThreshold = 30.0;
+        /** @brief I-VT: the velocity is averaged over this duration to suppress noise [ms] */
+        int32 velocityWindowMillis = 20;
+        /** @brief I-DT: windows dispersed less than this are fixations [deg] */
+        double dispersionThreshold = 1.0;
+        /** @brief I-DT: duration of the window [ms] */
+        int32 dispersionWindowMillis = 100;
+    };
+
+    enum class Type {
+        FIXATION,
+        SACCADE,
+        BLINK,
+    };
+
+    struct Event {
+        Type   type;
+        bool   onset;
+        /** @brief LSL time of the onset or offset */
+        double timestamp;
+        /** @brief offsets: duration [s] */
+        double duration;
+        /** @brief position [px] - mean of fixations and landing point of saccades on offsets */
+        double x;
+        double y;
+        /** @brief saccade offsets: amplitude [deg] */
+        double amplitude;
+    };
+
+    /** @brief most events a single sample can produce - the offset of one and onset of another */
+    static constexpr int32 MAX_EVENTS = 2;
+
+    EventDetector( const Config& config, const elapi::ELApi::ScreenConfig& screen,
+                   int32 samplerate );
+
+    /** @brief screen geometry used from the next sample on */
+    void setScreen( const elapi::ELApi::ScreenConfig& screen );
+
+    /**
+     * @brief classifies the next sample stamped with the LSL time 'timestamp'
+     * @return number of events written to 'events'
+     */
+    int32 process( const elapi::ELGazeSample& gazeSample, double timestamp, Event* events );
+
+private:
+    enum class State {
+        NONE,
+        FIXATION,
+        SACCADE,
+        BLINK,
+    };
+
+    /** @brief sliding minimum or maximum over the last 'capacity' pushed values */
+    class Extremum
+    {
+    public:
+        Extremum( size_t capacity, bool maximum );
+        void   push( uint64 sequence, double value, uint64 oldest );
+        double value( ) const;
+        void   clear( );
+
+    private:
+        const size_t                m_capacity;
+        const bool                  m_maximum;
+        std::unique_ptr< uint64[] > m_sequence;
+        std::unique_ptr< double[] > m_value;
+        size_t                      m_head  = 0;
+        size_t                      m_count = 0;
+    };
+
+    /** @brief angle between two positions on the screen [deg] */
+    double degrees( double dxPixels, double dyPixels ) const;
+    void   updateDistance( const elapi::ELGazeSample& gazeSample );
+    /** @brief NONE if undecided, otherwise the state and where and when it began */
+    State classify( const elapi::ELGazeSample& gazeSample, double timestamp, double& transition,
+                    double& x, double& y );
+    /** @brief ends the current state and starts 'state' at 'timestamp' */
+    int32 transit( State state, double timestamp, double x, double y, Event* events );
+    void  resetWindow( );
+
+    const Config m_config;
+    double       m_mmPerPixelX = 0.0;
+    double       m_mmPerPixelY = 0.0;
+    double       m_distanceMM;
+
+    State  m_state          = State::NONE;
+    double m_stateTimestamp = 0.0;
+    double m_stateX         = 0.0;
+    double m_stateY         = 0.0;
+    double m_sumX           = 0.0;
+    double m_sumY           = 0.0;
+    uint64 m_stateSamples   = 0;
+
+    // previous valid sample
+    bool   m_havePrevious      = false;
+    double m_previousTimestamp = 0.0;
+    double m_previousX         = 0.0;
+    double m_previousY         = 0.0;
+
+    // window of the last m_windowSize valid samples
+    const size_t                m_windowSize;
+    std::unique_ptr< double[] > m_windowTimestamp;
+    std::unique_ptr< double[] > m_windowX;
+    std::unique_ptr< double[] > m_windowY;
+    uint64                      m_windowSamples = 0;
+    double                      m_windowSumX    = 0.0;
+    double                      m_windowSumY    = 0.0;
+    Extremum                    m_minX;
+    Extremum                    m_maxX;
+    Extremum                    m_minY;
+    Extremum                    m_maxY;
+};
+
+/** @brief "ivt" or "idt" */
+bool parseAlgorithm( const std::string& text, EventDetector::Algorithm& algorithm );
+
+/** @brief marker text of an event, e.g. "FIXATION_OFFSET duration=0.215 x=812.4 y=433.0" */
+std::string toString( const EventDetector::Event& event );
+
+}  // namespace ellsl
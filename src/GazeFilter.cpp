@@ -0,0 +1,270 @@
+// -----------------------------------------------------------------------
+// Copyright (C) 2019-2023, EyeLogic GmbH
+//
+// Permission is hereby granted, free of charge, to any person or
+// organization obtaining a copy of the software and accompanying
+// documentation covered by this license (the "Software") to use,
+// reproduce, display, distribute, execute, and transmit the Software,
+// and to prepare derivative works of the Software, and to permit
+// third-parties to whom the Software is furnished to do so.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, TITLE AND
+// NON-INFRINGEMENT. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR ANYONE
+// DISTRIBUTING THE SOFTWARE BE LIABLE FOR ANY DAMAGES OR OTHER
+// LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+// OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+// -----------------------------------------------------------------------
+
+
+#include "GazeFilter.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <sstream>
+
+using namespace ellsl;
+
+namespace
+{
+constexpr double PI            = 3.14159265358979323846;
+constexpr int64  UNINITIALIZED = std::numeric_limits< int64 >::min( );
+// initial uncertainty of the Kalman velocity [px^2/s^2]
+constexpr double INITIAL_VELOCITY_VARIANCE = 1e6;
+
+struct FilterChannel {
+    const char* label;
+    const char* eye;
+    const char* type;
+};
+
+// clang-format off
+constexpr FilterChannel FILTER_CHANNELS[ GazeFilter::AXES ] = {
+    { "Screen_X",       "both",  "ScreenX" },
+    { "Screen_Y",       "both",  "ScreenY" },
+    { "Screen_X_left",  "left",  "ScreenX" },
+    { "Screen_Y_left",  "left",  "ScreenY" },
+    { "Screen_X_right", "right", "ScreenX" },
+    { "Screen_Y_right", "right", "ScreenY" },
+};
+// clang-format on
+
+double
+smoothingFactor( double cutoff, double dt )
+{
+    return 1.0 / ( 1.0 + 1.0 / ( 2.0 * PI * cutoff * dt ) );
+}
+
+bool
+parseParameters( std::istringstream& stream, double* parameters, int32 count )
+{
+    std::string item;
+    for ( int32 i = 0; i < count && std::getline( stream, item, ':' ); i++ ) {
+        char*        end;
+        const double value = std::strtod( item.c_str( ), &end );
+        if ( item.empty( ) || *end != '\0' || !( value > 0.0 ) ) {
+            return false;
+        }
+        parameters[ i ] = value;
+    }
+    // trailing parameters are rejected
+    return !std::getline( stream, item, ':' );
+}
+
+void
+describeAxes( lsl::xml_element channels, const char* suffix, const char* filter )
+{
+    for ( const FilterChannel& axis : FILTER_CHANNELS ) {
+        lsl::xml_element channel = channels.append_child( "channel" );
+        channel.append_child_value( "label", std::string( axis.label ) + "_" + suffix );
+        channel.append_child_value( "eye", axis.eye );
+        channel.append_child_value( "type", axis.type );
+        channel.append_child_value( "unit", "pixels" );
+        channel.append_child_value( "coordinate_system", "image-space" );
+        channel.append_child_value( "filter", filter );
+    }
+}
+}  // namespace
+
+bool
+FilterConfig::operator==( const FilterConfig& other ) const
+{
+    return oneEuro == other.oneEuro && minCutoff == other.minCutoff && beta == other.beta &&
+           derivativeCutoff == other.derivativeCutoff && kalman == other.kalman &&
+           processNoise == other.processNoise && measurementNoise == other.measurementNoise;
+}
+
+int32
+FilterConfig::channelCount( ) const
+{
+    return ( oneEuro ? GazeFilter::AXES : 0 ) + ( kalman ? GazeFilter::AXES : 0 );
+}
+
+GazeFilter::GazeFilter( const FilterConfig& config ) : m_config( config )
+{
+    for ( AxisState& axis : m_axes ) {
+        axis              = { };
+        axis.lastMicroSec = UNINITIALIZED;
+    }
+}
+
+const FilterConfig&
+GazeFilter::config( ) const
+{
+    return m_config;
+}
+
+int32
+GazeFilter::channelCount( ) const
+{
+    return m_config.channelCount( );
+}
+
+void
+GazeFilter::apply( const elapi::ELGazeSample& gazeSample, double* values )
+{
+    const double inputs[ AXES ] = { gazeSample.porRawX,   gazeSample.porRawY,
+                                    gazeSample.porLeftX,  gazeSample.porLeftY,
+                                    gazeSample.porRightX, gazeSample.porRightY };
+    double*      euroValues     = m_config.oneEuro ? values : nullptr;
+    double*      kalmanValues   = m_config.kalman ? values + ( euroValues ? AXES : 0 ) : nullptr;
+    const int64  sampleMicroSec = gazeSample.timestampMicroSec;
+
+    for ( int32 i = 0; i < AXES; i++ ) {
+        AxisState&   axis  = m_axes[ i ];
+        const double value = inputs[ i ];
+        double       euro  = std::numeric_limits< double >::quiet_NaN( );
+        double       kal   = euro;
+        if ( value != elapi::ELInvalidValue ) {
+            const int64 elapsed =
+                axis.lastMicroSec == UNINITIALIZED ? 0 : sampleMicroSec - axis.lastMicroSec;
+            if ( elapsed <= 0 || elapsed > MAX_GAP_MICROSEC ) {
+                axis.euroValue      = value;
+                axis.euroDerivative = 0.0;
+                axis.position       = value;
+                axis.velocity       = 0.0;
+                axis.p00            = m_config.measurementNoise * m_config.measurementNoise;
+                axis.p01            = 0.0;
+                axis.p11            = INITIAL_VELOCITY_VARIANCE;
+                euro                = value;
+                kal                 = value;
+            } else {
+                const double dt = elapsed * 1e-6;
+                euro            = euroValues ? oneEuro( axis, value, dt ) : value;
+                kal             = kalmanValues ? kalman( axis, value, dt ) : value;
+            }
+            axis.lastMicroSec = sampleMicroSec;
+        }
+        if ( euroValues ) {
+            euroValues[ i ] = euro;
+        }
+        if ( kalmanValues ) {
+            kalmanValues[ i ] = kal;
+        }
+    }
+}
+
+double
+GazeFilter::oneEuro( AxisState& axis, double value, double dt ) const
+{
+    const double derivative = ( value - axis.euroValue ) / dt;
+    axis.euroDerivative +=
+        smoothingFactor( m_config.derivativeCutoff, dt ) * ( derivative - axis.euroDerivative );
+    const double cutoff = m_config.minCutoff + m_config.beta * std::abs( axis.euroDerivative );
+    axis.euroValue += smoothingFactor( cutoff, dt ) * ( value - axis.euroValue );
+    return axis.euroValue;
+}
+
+double
+GazeFilter::kalman( AxisState& axis, double value, double dt ) const
+{
+    // predict with constant velocity, the acceleration is white noise
+    const double q = m_config.processNoise;
+    axis.position += axis.velocity * dt;
+    axis.p00 += dt * ( 2.0 * axis.p01 + dt * axis.p11 ) + q * dt * dt * dt / 3.0;
+    axis.p01 += dt * axis.p11 + q * dt * dt / 2.0;
+    axis.p11 += q * dt;
+
+    // correct with the measured position
+    const double s          = axis.p00 + m_config.measurementNoise * m_config.measurementNoise;
+    const double k0         = axis.p00 / s;
+    const double k1         = axis.p01 / s;
+    const double innovation = value - axis.position;
+    axis.position += k0 * innovation;
+    axis.velocity += k1 * innovation;
+    axis.p11 -= k1 * axis.p01;
+    axis.p00 *= 1.0 - k0;
+    axis.p01 *= 1.0 - k0;
+    return axis.position;
+}
+
+bool
+ellsl::parseFilter( const std::string& text, FilterConfig& config )
+{
+    std::istringstream stream( text );
+    std::string        name;
+    std::getline( stream, name, ':' );
+    FilterConfig parsed = config;
+    if ( name == "oneeuro" ) {
+        double parameters[ 2 ] = { parsed.minCutoff, parsed.beta };
+        if ( !parseParameters( stream, parameters, 2 ) ) {
+            return false;
+        }
+        parsed.oneEuro   = true;
+        parsed.minCutoff = parameters[ 0 ];
+        parsed.beta      = parameters[ 1 ];
+    } else if ( name == "kalman" ) {
+        double parameters[ 2 ] = { parsed.processNoise, parsed.measurementNoise };
+        if ( !parseParameters( stream, parameters, 2 ) ) {
+            return false;
+        }
+        parsed.kalman           = true;
+        parsed.processNoise     = parameters[ 0 ];
+        parsed.measurementNoise = parameters[ 1 ];
+    } else {
+        return false;
+    }
+    config = parsed;
+    return true;
+}
+
+void
+ellsl::describeFilterChannels( const FilterConfig& config, lsl::xml_element channels )
+{
+    if ( config.oneEuro ) {
+        describeAxes( channels, "oneeuro", "one_euro" );
+    }
+    if ( config.kalman ) {
+        describeAxes( channels, "kalman", "kalman" );
+    }
+}
+
+void
+ellsl::describeFilters( const FilterConfig& config, lsl::xml_element desc )
+{
+    if ( config.channelCount( ) == 0 ) {
+        return;
+    }
+    lsl::xml_element filters = desc.append_child( "filters" );
+    if ( config.oneEuro ) {
+        filters.append_child( "filter" )
+            .append_child_value( "type", "one_euro" )
+            .append_child_value( "input", "raw binocular and monocular POR" )
+            .append_child_value( "min_cutoff_hz", std::to_string( config.minCutoff ) )
+            .append_child_value( "beta", std::to_string( config.beta ) )
+            .append_child_value( "derivative_cutoff_hz",
+                                 std::to_string( config.derivativeCutoff ) );
+    }
+    if ( config.kalman ) {
+        filters.append_child( "filter" )
+            .append_child_value( "type", "kalman" )
+            .append_child_value( "model", "constant velocity, white-noise acceleration" )
+            .append_child_value( "input", "raw binocular and monocular POR" )
+            .append_child_value( "process_noise_px2_s3", std::to_string( config.processNoise ) )
+            .append_child_value( "measurement_noise_px",
+                                 std::to_string( config.measurementNoise ) );
+    }
+}
@@ -0,0 +1,118 @@
+// -----------------------------------------------------------------------
+// Copyright (C) 2019-2023, EyeLogic GmbH
+//
+// Permission is hereby granted, free of charge, to any person or
+// organization obtaining a copy of the software and accompanying
+// documentation covered by this license (the "Software") to use,
+// reproduce, display, distribute, execute, and transmit the Software,
+// and to prepare derivative works of the Software, and to permit
+// third-parties to whom the Software is furnished to do so.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, TITLE AND
+// NON-INFRINGEMENT. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR ANYONE
+// DISTRIBUTING THE SOFTWARE BE LIABLE FOR ANY DAMAGES OR OTHER
+// LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+// OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+// -----------------------------------------------------------------------
+
+
+#pragma once
+
+#include <cstdint>
+
+using int32  = int32_t;
+using int64  = int64_t;
+using uint32 = uint32_t;
+using uint64 = uint64_t;
+
+#include "elapi/ELGazeSample.h"
+#include "lsl_cpp.h"
+
+#include <string>
+
+namespace ellsl
+{
+/** @brief online smoothing filters added to the gaze stream as extra channels */
+struct FilterConfig {
+    bool oneEuro = false;
+    /** @brief One-Euro: cutoff frequency at rest [Hz] */
+    double minCutoff = 1.0;
+    /** @brief One-Euro: increase of the cutoff with speed [1/px] */
+    double beta = 0.007;
+    /** @brief One-Euro: cutoff frequency of the speed estimate [Hz] */
+    double derivativeCutoff = 1.0;
+
+    bool kalman = false;
+    /** @brief Kalman: spectral density of the white-noise acceleration [px^2/s^3] */
+    double processNoise = 1e6;
+    /** @brief Kalman: standard deviation of the measured position [px] */
+    double measurementNoise = 10.0;
+
+    /** @brief number of extra channels, 6 per enabled filter */
+    int32 channelCount( ) const;
+
+    bool operator==( const FilterConfig& other ) const;
+    bool operator!=( const FilterConfig& other ) const { return !( *this == other ); }
+};
+
+/**
+ * @brief runs the enabled filters over the binocular raw POR and the POR of both eyes
+ *
+ * The state of every axis fits into one cache line, apply( ) neither allocates nor blocks.
+ * Filters are (re-)initialized with the first valid position after a gap of more than
+ * MAX_GAP_MICROSEC. Not thread-safe, the owner has to serialize all calls.
+ */
+class GazeFilter
+{
+public:
+    /** @brief binocular, left and right x and y */
+    static constexpr int32 AXES = 6;
+    /** @brief longest gap the filters predict across */
+    static constexpr int64 MAX_GAP_MICROSEC = 100000;
+
+    explicit GazeFilter( const FilterConfig& config );
+
+    const FilterConfig& config( ) const;
+    int32               channelCount( ) const;
+
+    /** @brief writes channelCount( ) values, NaN for invalid positions */
+    void apply( const elapi::ELGazeSample& gazeSample, double* values );
+
+private:
+    struct alignas( 64 ) AxisState {
+        // INT64_MIN until the first valid position
+        int64  lastMicroSec;
+        double euroValue;
+        double euroDerivative;
+        double position;
+        double velocity;
+        // symmetric covariance of position and velocity
+        double p00;
+        double p01;
+        double p11;
+    };
+    static_assert( sizeof( AxisState ) == 64, "the state of an axis must fit into a cache line" );
+
+    double oneEuro( AxisState& axis, double value, double dt ) const;
+    double kalman( AxisState& axis, double value, double dt ) const;
+
+    const FilterConfig m_config;
+    AxisState          m_axes[ AXES ];
+};
+
+/**
+ * @brief parses "oneeuro[:<mincutoff>[:<beta>]]" or "kalman[:<processnoise>[:<measurementnoise>]]"
+ * and enables the filter in 'config'
+ */
+bool parseFilter( const std::string& text, FilterConfig& config );
+
+/** @brief appends the channels of the enabled filters to 'channels' */
+void describeFilterChannels( const FilterConfig& config, lsl::xml_element channels );
+
+/** @brief appends the parameters of the enabled filters to the stream meta-data */
+void describeFilters( const FilterConfig& config, lsl::xml_element desc );
+
+}  // namespace ellsl
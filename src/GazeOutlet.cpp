@@ -0,0 +1,403 @@
+// -----------------------------------------------------------------------
+// Copyright (C) 2019-2023, EyeLogic GmbH
+//
+// Permission is hereby granted, free of charge, to any person or
+// organization obtaining a copy of the software and accompanying
+// documentation covered by this license (the "Software") to use,
+// reproduce, display, distribute, execute, and transmit the Software,
+// and to prepare derivative works of the Software, and to permit
+// third-parties to whom the Software is furnished to do so.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, TITLE AND
+// NON-INFRINGEMENT. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR ANYONE
+// DISTRIBUTING THE SOFTWARE BE LIABLE FOR ANY DAMAGES OR OTHER
+// LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+// OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+// -----------------------------------------------------------------------
+
+
+#include "GazeOutlet.h"
+#include "ConversionKernel.h"
+#include "Log.h"
+
+#include <algorithm>
+
+using namespace ellsl;
+
+namespace
+{
+template< typename Value, ChannelSelection Selection >
+class ProfileOutlet final : public GazeOutlet
+{
+public:
+    static constexpr int32 CHANNELS =
+        ellsl::channelCount( typename ChannelSet< Selection >::Channels{ } );
+
+    ProfileOutlet( const StreamProfile& profile, const lsl::stream_info& info,
+                   const DerivedChannels& derived )
+        : GazeOutlet( profile, info, derived )
+    {
+        resizeChunk( );
+    }
+
+    ~ProfileOutlet( ) override { flush( ); }
+
+    void push( const elapi::ELGazeSample& gazeSample, double timestamp ) override
+    {
+        double* derived = append( gazeSample, timestamp );
+        if ( derived ) {
+            if ( m_filter ) {
+                m_filter->apply( gazeSample, derived );
+                derived += m_filter->channelCount( );
+            }
+            if ( m_angles ) {
+                m_angles->apply( gazeSample, derived );
+            }
+        }
+        if ( ++m_chunkFill >= m_chunkSamples ) {
+            flush( );
+        }
+    }
+
+    void push( const elapi::ELGazeSample& gazeSample, const double* values,
+               double timestamp ) override
+    {
+        double* derived = append( gazeSample, timestamp );
+        if ( derived ) {
+            std::copy( values, values + derivedChannels( ), derived );
+        }
+        if ( ++m_chunkFill >= m_chunkSamples ) {
+            flush( );
+        }
+    }
+
+    void flush( ) override
+    {
+        if ( m_chunkFill == 0 ) {
+            return;
+        }
+        // the whole chunk is converted at once so the kernel runs over contiguous values
+        convertBatch< Value, Selection >( m_chunkRaw.data( ), m_chunkFill, m_chunkData.data( ),
+                                          m_chunkScratch.data( ) );
+        const Value* data = m_channels > CHANNELS ? appendDerived( ) : m_chunkData.data( );
+#ifdef ELLSL_ENABLE_DIAGNOSTICS
+        const int64 converted = m_diagnostics ? Diagnostics::clock( ) : 0;
+#endif
+        if ( m_chunkFill == 1 ) {
+            m_outlet.push_sample( data, m_chunkTimestamps[ 0 ] );
+        } else {
+            m_outlet.push_chunk_multiplexed( data, m_chunkTimestamps.data( ),
+                                             static_cast< size_t >( m_chunkFill ) * m_channels );
+        }
+        if ( m_journal ) {
+            m_journal->appendSamples( m_chunkTimestamps.data( ), data, m_chunkFill,
+                                      sizeof( Value ) * m_channels );
+        }
+        if ( m_xdf ) {
+            m_xdf->appendSamples( m_chunkTimestamps.data( ), data, m_chunkFill,
+                                  sizeof( Value ) * m_channels );
+        }
+#ifdef ELLSL_ENABLE_DIAGNOSTICS
+        if ( m_diagnostics ) {
+            m_diagnostics->recordChunk( m_chunkRaw.data( ), m_chunkCallback.data( ), m_chunkFill,
+                                        converted, Diagnostics::clock( ) );
+        }
+#endif
+        m_chunkFill = 0;
+    }
+
+private:
+    int32 derivedChannels( ) const { return m_channels - CHANNELS; }
+
+    // stores the sample of the next chunk row, returns the row of its derived channels if any
+    double* append( const elapi::ELGazeSample& gazeSample, double timestamp )
+    {
+        if ( m_chunkFill == 0 ) {
+            m_chunkBegin = std::chrono::steady_clock::now( );
+        }
+        if ( std::is_same< Value, float >::value && !m_inexactIndex &&
+             gazeSample.index > FLOAT32_EXACT_INDEX ) {
+            m_inexactIndex = true;
+            Log::warning( "frame numbers above " + std::to_string( FLOAT32_EXACT_INDEX ) +
+                          " are rounded in float32 streams - use a double64 profile for long "
+                          "sessions" );
+        }
+        m_chunkRaw[ m_chunkFill ]        = gazeSample;
+        m_chunkTimestamps[ m_chunkFill ] = timestamp;
+        // the derived buffer is empty without filters and visual angles
+        if ( m_channels == CHANNELS ) {
+            return nullptr;
+        }
+        return m_chunkDerived.data( ) + static_cast< size_t >( m_chunkFill ) * derivedChannels( );
+    }
+
+    // interleaves the converted channels with the derived ones
+    const Value* appendDerived( )
+    {
+        const int32 nderived = derivedChannels( );
+        for ( int32 i = 0; i < m_chunkFill; i++ ) {
+            Value*        row      = &m_chunkCombined[ static_cast< size_t >( i ) * m_channels ];
+            const Value*  data     = &m_chunkData[ static_cast< size_t >( i ) * CHANNELS ];
+            const double* derived  = m_chunkDerived.data( ) + static_cast< size_t >( i ) * nderived;
+            std::copy( data, data + CHANNELS, row );
+            for ( int32 j = 0; j < nderived; j++ ) {
+                row[ CHANNELS + j ] = static_cast< Value >( derived[ j ] );
+            }
+        }
+        return m_chunkCombined.data( );
+    }
+
+    void resizeChunk( ) override
+    {
+        const size_t nvalues = static_cast< size_t >( m_chunkSamples ) * CHANNELS;
+        m_chunkRaw.resize( m_chunkSamples );
+        m_chunkData.assign( nvalues, Value( 0 ) );
+        m_chunkScratch.assign( std::is_same< Value, double >::value ? 0 : nvalues, 0.0 );
+        m_chunkTimestamps.assign( m_chunkSamples, 0.0 );
+        if ( m_channels > CHANNELS ) {
+            m_chunkDerived.assign( static_cast< size_t >( m_chunkSamples ) * derivedChannels( ),
+                                    0.0 );
+            m_chunkCombined.assign( static_cast< size_t >( m_chunkSamples ) * m_channels,
+                                    Value( 0 ) );
+        }
+#ifdef ELLSL_ENABLE_DIAGNOSTICS
+        m_chunkCallback.assign( m_chunkSamples, 0 );
+#endif
+    }
+
+    std::vector< elapi::ELGazeSample > m_chunkRaw;
+    // [m_chunkSamples][CHANNELS]
+    std::vector< Value >               m_chunkData;
+    std::vector< double >              m_chunkScratch;
+    // [m_chunkSamples][derivedChannels( )] and [m_chunkSamples][m_channels]
+    std::vector< double >              m_chunkDerived;
+    std::vector< Value >               m_chunkCombined;
+    bool                               m_inexactIndex = false;
+};
+
+template< typename Value >
+std::unique_ptr< GazeOutlet >
+createForValue( const StreamProfile& profile, const lsl::stream_info& info,
+                const DerivedChannels& derived )
+{
+    switch ( profile.channels ) {
+        case ChannelSelection::POR:
+            return std::make_unique< ProfileOutlet< Value, ChannelSelection::POR > >(
+                profile, info, derived );
+        case ChannelSelection::FILTERED:
+            return std::make_unique< ProfileOutlet< Value, ChannelSelection::FILTERED > >(
+                profile, info, derived );
+        case ChannelSelection::EYES:
+            return std::make_unique< ProfileOutlet< Value, ChannelSelection::EYES > >(
+                profile, info, derived );
+        case ChannelSelection::FULL:
+        default:
+            return std::make_unique< ProfileOutlet< Value, ChannelSelection::FULL > >(
+                profile, info, derived );
+    }
+}
+
+std::string
+sourceId( uint64 deviceSerial, const std::string& suffix )
+{
+    return "EyeLogic One | " + std::to_string( deviceSerial ) + suffix;
+}
+}  // namespace
+
+int32
+DerivedChannels::count( ) const
+{
+    return filter.channelCount( ) + ( visualAngles ? VisualAngle::CHANNELS : 0 );
+}
+
+bool
+DerivedChannels::operator==( const DerivedChannels& other ) const
+{
+    if ( filter != other.filter || visualAngles != other.visualAngles ) {
+        return false;
+    }
+    // the geometry only matters for the angles
+    return !visualAngles || geometry == other.geometry;
+}
+
+lsl::stream_info
+ellsl::makeGazeStreamInfo( const StreamProfile& profile, int32 samplerate, uint64 deviceSerial,
+                           const ClockMapping* clockMapping, const std::string& name,
+                           const DerivedChannels& derived, const std::string& sourceSuffix )
+{
+    int32       indices[ NCHANNELS ];
+    const int32 nchannels = channelIndices( profile.channels, indices );
+
+    // create streaminfo
+    lsl::stream_info lslInfo(
+        name, "Gaze", nchannels + derived.count( ), samplerate,
+        profile.format == ValueFormat::FLOAT32 ? lsl::cf_float32 : lsl::cf_double64,
+        sourceId( deviceSerial, sourceSuffix ) );
+
+    // append some (optional) meta-data
+    lsl::xml_element channels = lslInfo.desc( ).append_child( "channels" );
+    for ( int32 i = 0; i < nchannels; i++ ) {
+        const ChannelInfo& channelInfo = CHANNEL_INFO[ indices[ i ] ];
+        lsl::xml_element   channel     = channels.append_child( "channel" );
+        channel.append_child_value( "label", channelInfo.label );
+        if ( channelInfo.eye ) {
+            channel.append_child_value( "eye", channelInfo.eye );
+        }
+        channel.append_child_value( "type", channelInfo.type );
+        channel.append_child_value( "unit", channelInfo.unit );
+        if ( channelInfo.coordinateSystem ) {
+            channel.append_child_value( "coordinate_system", channelInfo.coordinateSystem );
+        }
+    }
+    describeFilterChannels( derived.filter, channels );
+    if ( derived.visualAngles ) {
+        describeAngleChannels( channels );
+    }
+
+    lslInfo.desc( )
+        .append_child( "acquisition" )
+        .append_child_value( "manufacturer", "EyeLogic" )
+        .append_child_value( "model", "One" )
+        .append_child_value( "serial number", std::to_string( deviceSerial ) )
+        .append_child_value( "stream_profile", toString( profile ) );
+
+    if ( clockMapping ) {
+        clockMapping->describe( lslInfo.desc( ) );
+    }
+    describeFilters( derived.filter, lslInfo.desc( ) );
+    if ( derived.visualAngles ) {
+        describeAngles( derived.geometry, lslInfo.desc( ) );
+    }
+
+    return lslInfo;
+}
+
+std::unique_ptr< GazeOutlet >
+GazeOutlet::create( const StreamProfile& profile, int32 samplerate, uint64 deviceSerial,
+                    const ClockMapping* clockMapping, const std::string& name,
+                    const DerivedChannels& derived )
+{
+    const lsl::stream_info info =
+        makeGazeStreamInfo( profile, samplerate, deviceSerial, clockMapping, name, derived );
+    if ( profile.format == ValueFormat::FLOAT32 ) {
+        return createForValue< float >( profile, info, derived );
+    }
+    return createForValue< double >( profile, info, derived );
+}
+
+GazeOutlet::GazeOutlet( const StreamProfile& profile, const lsl::stream_info& info,
+                        const DerivedChannels& derived )
+    : m_profile( profile ),
+      m_channels( info.channel_count( ) ),
+      m_samplerate( static_cast< int32 >( info.nominal_srate( ) ) ),
+      m_derived( derived ),
+      m_name( info.name( ) ),
+      m_sourceId( info.source_id( ) ),
+      m_filter( derived.filter.channelCount( ) > 0 ? std::make_unique< GazeFilter >( derived.filter )
+                                                   : nullptr ),
+      m_angles( derived.visualAngles ? std::make_unique< VisualAngle >( ) : nullptr ),
+      m_outlet( info )
+{
+}
+
+const StreamProfile&
+GazeOutlet::profile( ) const
+{
+    return m_profile;
+}
+
+void
+GazeOutlet::setScreen( const elapi::ELApi::ScreenConfig& screen )
+{
+    if ( m_angles ) {
+        m_angles->setScreen( screen, m_derived.geometry );
+    }
+}
+
+int32
+GazeOutlet::channelCount( ) const
+{
+    return m_channels;
+}
+
+int32
+GazeOutlet::samplerate( ) const
+{
+    return m_samplerate;
+}
+
+lsl::stream_info
+GazeOutlet::info( ) const
+{
+    return m_outlet.info( );
+}
+
+const DerivedChannels&
+GazeOutlet::derived( ) const
+{
+    return m_derived;
+}
+
+bool
+GazeOutlet::haveConsumers( )
+{
+    return m_outlet.have_consumers( );
+}
+
+bool
+GazeOutlet::sameStream( const StreamProfile& profile, int32 samplerate, uint64 deviceSerial,
+                        const std::string& name, const DerivedChannels& derived ) const
+{
+    return profile == m_profile && samplerate == m_samplerate && name == m_name &&
+           sourceId( deviceSerial, "" ) == m_sourceId && derived == m_derived;
+}
+
+void
+GazeOutlet::setChunking( int32 samples, std::chrono::microseconds duration )
+{
+    flush( );
+    m_chunkSamples  = samples;
+    m_chunkDuration = duration;
+    resizeChunk( );
+}
+
+void
+GazeOutlet::setJournal( RecordingJournal* journal )
+{
+    m_journal = journal;
+}
+
+void
+GazeOutlet::setXdfWriter( XdfWriter* xdf )
+{
+    m_xdf = xdf;
+}
+
+#ifdef ELLSL_ENABLE_DIAGNOSTICS
+void
+GazeOutlet::setDiagnostics( Diagnostics* diagnostics )
+{
+    m_diagnostics = diagnostics;
+}
+
+void
+GazeOutlet::stampCallback( int64 callbackMicroSec )
+{
+    m_chunkCallback[ m_chunkFill ] = callbackMicroSec;
+}
+#endif
+
+bool
+GazeOutlet::chunkPending( ) const
+{
+    return m_chunkFill > 0 && m_chunkDuration.count( ) > 0;
+}
+
+bool
+GazeOutlet::chunkExpired( ) const
+{
+    return chunkPending( ) && std::chrono::steady_clock::now( ) - m_chunkBegin >= m_chunkDuration;
+}
@@ -0,0 +1,161 @@
+// -----------------------------------------------------------------------
+// Copyright (C) 2019-2023, EyeLogic GmbH
+//
+// Permission is hereby granted, free of charge, to any person or
+// organization obtaining a copy of the software and accompanying
+// documentation covered by this license (the "Software") to use,
+// reproduce, display, distribute, execute, and transmit the Software,
+// and to prepare derivative works of the Software, and to permit
+// third-parties to whom the Software is furnished to do so.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, TITLE AND
+// NON-INFRINGEMENT. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR ANYONE
+// DISTRIBUTING THE SOFTWARE BE LIABLE FOR ANY DAMAGES OR OTHER
+// LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+// OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+// -----------------------------------------------------------------------
+
+
+#pragma once
+
+#include "ClockMapping.h"
+#include "GazeFilter.h"
+#include "RecordingJournal.h"
+#include "StreamProfile.h"
+#include "VisualAngle.h"
+#include "XdfWriter.h"
+#ifdef ELLSL_ENABLE_DIAGNOSTICS
+#include "Diagnostics.h"
+#endif
+
+#include <chrono>
+#include <memory>
+#include <vector>
+
+namespace ellsl
+{
+/** @brief default name of the gaze stream */
+constexpr char GAZE_STREAM_NAME[] = "EyeLogic";
+
+/** @brief channels computed from every sample, appended to those of the profile in this order */
+struct DerivedChannels {
+    FilterConfig    filter;
+    bool            visualAngles = false;
+    TrackerGeometry geometry;
+
+    int32 count( ) const;
+
+    bool operator==( const DerivedChannels& other ) const;
+    bool operator!=( const DerivedChannels& other ) const { return !( *this == other ); }
+};
+
+/**
+ * @brief builds the stream info, including the channel meta-data, of the gaze outlet
+ * @param clockMapping if given, its method and current fit are added to the meta-data
+ * @param derived its channels follow those of the profile
+ * @param sourceSuffix appended to the source id, which has to be unique per stream of a device
+ */
+lsl::stream_info makeGazeStreamInfo( const StreamProfile& profile, int32 samplerate,
+                                     uint64 deviceSerial,
+                                     const ClockMapping*    clockMapping = nullptr,
+                                     const std::string&     name         = GAZE_STREAM_NAME,
+                                     const DerivedChannels& derived      = { },
+                                     const std::string&     sourceSuffix = "" );
+
+/**
+ * @brief LSL outlet of the gaze stream, converts and chunks samples according to its profile
+ *
+ * The channels of the profile are followed by the derived channels.
+ *
+ * Not thread-safe, the owner has to serialize all calls.
+ */
+class GazeOutlet
+{
+public:
+    static std::unique_ptr< GazeOutlet > create( const StreamProfile& profile, int32 samplerate,
+                                                 uint64              deviceSerial,
+                                                 const ClockMapping* clockMapping = nullptr,
+                                                 const std::string&  name = GAZE_STREAM_NAME,
+                                                 const DerivedChannels& derived = { } );
+    virtual ~GazeOutlet( ) = default;
+
+    GazeOutlet( const GazeOutlet& ) = delete;
+    GazeOutlet& operator=( const GazeOutlet& ) = delete;
+
+    const StreamProfile&   profile( ) const;
+    /** @brief channels of the profile and derived channels */
+    int32                  channelCount( ) const;
+    int32                  samplerate( ) const;
+    lsl::stream_info       info( ) const;
+    const DerivedChannels& derived( ) const;
+    bool                   haveConsumers( );
+    /**
+     * @brief whether create( ) with these arguments would publish the very same stream, which
+     * can then be kept - consumers stay connected and recorders in the same segment
+     */
+    bool sameStream( const StreamProfile& profile, int32 samplerate, uint64 deviceSerial,
+                     const std::string& name, const DerivedChannels& derived ) const;
+
+    /** @see LSLClient::setChunking */
+    void setChunking( int32 samples, std::chrono::microseconds duration );
+    /** @brief whether a partially filled chunk waits for its time limit */
+    bool chunkPending( ) const;
+    /** @brief whether the time limit of the partially filled chunk has passed */
+    bool chunkExpired( ) const;
+
+    /** @brief appends the converted sample to the chunk, pushes the chunk once it is full */
+    virtual void push( const elapi::ELGazeSample& gazeSample, double timestamp ) = 0;
+    /** @brief as push( ), with the derived channels given instead of computed, e.g. on replay */
+    virtual void push( const elapi::ELGazeSample& gazeSample, const double* derived,
+                       double timestamp ) = 0;
+    /** @brief pushes the partially filled chunk */
+    virtual void flush( ) = 0;
+
+    /** @brief screen the visual angles of the following samples refer to */
+    void setScreen( const elapi::ELApi::ScreenConfig& screen );
+
+    /** @brief appends every pushed chunk to the journal, nullptr disables */
+    void setJournal( RecordingJournal* journal );
+    /** @brief appends every pushed chunk to the XDF file, nullptr disables */
+    void setXdfWriter( XdfWriter* xdf );
+
+#ifdef ELLSL_ENABLE_DIAGNOSTICS
+    /** @brief records the timings of every pushed sample, nullptr disables */
+    void setDiagnostics( Diagnostics* diagnostics );
+    /** @brief callback entry time of the sample passed to the next push( ) */
+    void stampCallback( int64 callbackMicroSec );
+#endif
+
+protected:
+    GazeOutlet( const StreamProfile& profile, const lsl::stream_info& info,
+                const DerivedChannels& derived );
+
+    virtual void resizeChunk( ) = 0;
+
+    const StreamProfile                   m_profile;
+    const int32                           m_channels;
+    const int32                           m_samplerate;
+    const DerivedChannels                 m_derived;
+    const std::string                     m_name;
+    const std::string                     m_sourceId;
+    // nullptr without the respective derived channels
+    std::unique_ptr< GazeFilter >         m_filter;
+    std::unique_ptr< VisualAngle >        m_angles;
+    lsl::stream_outlet                    m_outlet;
+    int32                                 m_chunkSamples = 1;
+    std::chrono::microseconds             m_chunkDuration{ 0 };
+    int32                                 m_chunkFill = 0;
+    std::chrono::steady_clock::time_point m_chunkBegin;
+    std::vector< double >                 m_chunkTimestamps;
+    RecordingJournal*                     m_journal = nullptr;
+    XdfWriter*                            m_xdf     = nullptr;
+#ifdef ELLSL_ENABLE_DIAGNOSTICS
+    Diagnostics*         m_diagnostics = nullptr;
+    std::vector< int64 > m_chunkCallback;
+#endif
+};
+
+}  // namespace ellsl
@@ -0,0 +1,169 @@
+// -----------------------------------------------------------------------
+// Copyright (C) 2019-2023, EyeLogic GmbH
+//
+// Permission is hereby granted, free of charge, to any person or
+// organization obtaining a copy of the software and accompanying
+// documentation covered by this license (the "Software") to use,
+// reproduce, display, distribute, execute, and transmit the Software,
+// and to prepare derivative works of the Software, and to permit
+// third-parties to whom the Software is furnished to do so.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, TITLE AND
+// NON-INFRINGEMENT. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR ANYONE
+// DISTRIBUTING THE SOFTWARE BE LIABLE FOR ANY DAMAGES OR OTHER
+// LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+// OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+// -----------------------------------------------------------------------
+
+
+#include "GazeSource.h"
+
+#include <cerrno>
+#include <cstdlib>
+
+#ifdef ELLSL_WITH_ELAPI
+#include "ELApiGazeSource.h"
+#else
+#include "SimulatedGazeSource.h"
+
+#include <limits>
+
+// the EyeLogic SDK library is not linked, provide its invalid value marker
+namespace elapi
+{
+const double ELInvalidValue = std::numeric_limits< double >::lowest( );
+}
+#endif
+
+std::shared_ptr< ellsl::GazeSource >
+ellsl::createDefaultGazeSource( const char* clientName )
+{
+#ifdef ELLSL_WITH_ELAPI
+    return std::make_shared< ELApiGazeSource >( clientName );
+#else
+    ( void )clientName;
+    return std::make_shared< SimulatedGazeSource >( );
+#endif
+}
+
+std::string
+ellsl::toString( const elapi::ELApi::ServerInfo& server )
+{
+    return std::string( server.ip ) + ":" + std::to_string( server.port );
+}
+
+bool
+ellsl::parseServer( const std::string& text, elapi::ELApi::ServerInfo& server )
+{
+    const size_t colon = text.rfind( ':' );
+    if ( colon == std::string::npos || colon == 0 || colon >= sizeof( server.ip ) ) {
+        return false;
+    }
+    // port 0 is valid, the simulated servers count from there
+    const std::string sport = text.substr( colon + 1 );
+    char*             end   = nullptr;
+    errno                   = 0;
+    const long port         = std::strtol( sport.c_str( ), &end, 10 );
+    if ( sport.empty( ) || *end != '\0' || errno != 0 || port < 0 || port > 0xffff ) {
+        return false;
+    }
+    server = { };
+    text.copy( server.ip, colon );
+    server.port = static_cast< uint16_t >( port );
+    return true;
+}
+
+const char*
+ellsl::toString( elapi::ELApi::Event event )
+{
+    switch ( event ) {
+        case elapi::ELApi::Event::SCREEN_CHANGED:
+            return "SCREEN_CHANGED";
+        case elapi::ELApi::Event::CONNECTION_CLOSED:
+            return "CONNECTION_CLOSED";
+        case elapi::ELApi::Event::DEVICE_CONNECTED:
+            return "DEVICE_CONNECTED";
+        case elapi::ELApi::Event::DEVICE_DISCONNECTED:
+            return "DEVICE_DISCONNECTED";
+        case elapi::ELApi::Event::TRACKING_STOPPED:
+            return "TRACKING_STOPPED";
+    }
+    return "UNKNOWN";
+}
+
+const char*
+ellsl::toString( elapi::ELApi::ReturnConnect value )
+{
+    switch ( value ) {
+        case elapi::ELApi::ReturnConnect::SUCCESS:
+            return "SUCCESS";
+        case elapi::ELApi::ReturnConnect::FAILURE:
+            return "FAILURE";
+        case elapi::ELApi::ReturnConnect::VERSION_MISMATCH:
+            return "VERSION_MISMATCH";
+    }
+    return "UNKNOWN";
+}
+
+const char*
+ellsl::toString( elapi::ELApi::ReturnStart value )
+{
+    switch ( value ) {
+        case elapi::ELApi::ReturnStart::SUCCESS:
+            return "SUCCESS";
+        case elapi::ELApi::ReturnStart::NOT_CONNECTED:
+            return "NOT_CONNECTED";
+        case elapi::ELApi::ReturnStart::DEVICE_MISSING:
+            return "DEVICE_MISSING";
+        case elapi::ELApi::ReturnStart::INVALID_FRAMERATE_MODE:
+            return "INVALID_FRAMERATE_MODE";
+        case elapi::ELApi::ReturnStart::ALREADY_RUNNING_DIFFERENT_FRAMERATE:
+            return "ALREADY_RUNNING_DIFFERENT_FRAMERATE";
+        case elapi::ELApi::ReturnStart::FAILURE:
+            return "FAILURE";
+    }
+    return "UNKNOWN";
+}
+
+const char*
+ellsl::toString( elapi::ELApi::ReturnCalibrate value )
+{
+    switch ( value ) {
+        case elapi::ELApi::ReturnCalibrate::SUCCESS:
+            return "SUCCESS";
+        case elapi::ELApi::ReturnCalibrate::NOT_CONNECTED:
+            return "NOT_CONNECTED";
+        case elapi::ELApi::ReturnCalibrate::NOT_TRACKING:
+            return "NOT_TRACKING";
+        case elapi::ELApi::ReturnCalibrate::INVALID_CALIBRATION_MODE:
+            return "INVALID_CALIBRATION_MODE";
+        case elapi::ELApi::ReturnCalibrate::ALREADY_BUSY:
+            return "ALREADY_BUSY";
+        case elapi::ELApi::ReturnCalibrate::FAILURE:
+            return "FAILURE";
+    }
+    return "UNKNOWN";
+}
+
+const char*
+ellsl::toString( elapi::ELApi::ReturnValidate value )
+{
+    switch ( value ) {
+        case elapi::ELApi::ReturnValidate::SUCCESS:
+            return "SUCCESS";
+        case elapi::ELApi::ReturnValidate::NOT_CONNECTED:
+            return "NOT_CONNECTED";
+        case elapi::ELApi::ReturnValidate::NOT_TRACKING:
+            return "NOT_TRACKING";
+        case elapi::ELApi::ReturnValidate::NOT_CALIBRATED:
+            return "NOT_CALIBRATED";
+        case elapi::ELApi::ReturnValidate::ALREADY_BUSY:
+            return "ALREADY_BUSY";
+        case elapi::ELApi::ReturnValidate::FAILURE:
+            return "FAILURE";
+    }
+    return "UNKNOWN";
+}
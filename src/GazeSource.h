@@ -0,0 +1,109 @@
+// -----------------------------------------------------------------------
+// Copyright (C) 2019-2023, EyeLogic GmbH
+//
+// Permission is hereby granted, free of charge, to any person or
+// organization obtaining a copy of the software and accompanying
+// documentation covered by this license (the "Software") to use,
+// reproduce, display, distribute, execute, and transmit the Software,
+// and to prepare derivative works of the Software, and to permit
+// third-parties to whom the Software is furnished to do so.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, TITLE AND
+// NON-INFRINGEMENT. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR ANYONE
+// DISTRIBUTING THE SOFTWARE BE LIABLE FOR ANY DAMAGES OR OTHER
+// LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+// OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+// -----------------------------------------------------------------------
+
+
+#pragma once
+
+#include <cstdint>
+
+using int32  = int32_t;
+using int64  = int64_t;
+using uint32 = uint32_t;
+using uint64 = uint64_t;
+
+#include "elapi/ELApi.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace ellsl
+{
+/**
+ * @brief device configuration of a gaze source
+ *
+ * Same content as elapi::ELApi::DeviceConfig, but frame rates are not limited to uint8_t.
+ */
+struct DeviceInfo {
+    uint64               deviceSerial = 0;
+    std::vector< int32 > frameRates;
+    std::vector< int32 > calibrationMethods;
+};
+
+/**
+ * @brief source of gaze samples and device events the LSL client is written against
+ *
+ * Mirrors the subset of elapi::ELApi used by the client, with the same semantics and return
+ * values. Implemented by the EyeLogic server connection (ELApiGazeSource, Windows only) and by a
+ * simulated device (SimulatedGazeSource).
+ */
+class GazeSource
+{
+public:
+    virtual ~GazeSource( ) = default;
+
+    virtual void registerEventListener( elapi::ELApi::ELEventCallback* callback ) = 0;
+    virtual void registerGazeSampleListener( elapi::ELApi::ELGazeSampleCallback* callback ) = 0;
+
+    virtual elapi::ELApi::ReturnConnect connect( ) = 0;
+    virtual elapi::ELApi::ReturnConnect connectRemote( elapi::ELApi::ServerInfo server ) = 0;
+    virtual int32 requestServerList( int32 blockingDurationMS, elapi::ELApi::ServerInfo* serverList,
+                                     int32 serverListLength ) = 0;
+    virtual void disconnect( ) = 0;
+    virtual bool isConnected( ) const = 0;
+
+    virtual void getActiveScreen( elapi::ELApi::ScreenConfig& screenConfig ) const = 0;
+    virtual void getDeviceInfo( DeviceInfo& deviceInfo ) const = 0;
+
+    virtual elapi::ELApi::ReturnNextData getNextEvent( elapi::ELApi::Event& event,
+                                                       int32 timeoutMillis ) = 0;
+    virtual elapi::ELApi::ReturnNextData getNextGazeSample( elapi::ELGazeSample& gazeSample,
+                                                            int32 timeoutMillis ) = 0;
+
+    virtual elapi::ELApi::ReturnStart requestTracking( int32 frameRateModeInd ) = 0;
+    virtual void unrequestTracking( ) = 0;
+
+    virtual elapi::ELApi::ReturnCalibrate calibrate( int32 calibrationModeInd ) = 0;
+    virtual void abortCalibValidation( ) = 0;
+    virtual elapi::ELApi::ReturnValidate validate(
+        elapi::ELApi::ELValidationResult& validationResult ) = 0;
+};
+
+/**
+ * @brief the EyeLogic server connection if the client was built with the EyeLogic SDK
+ * (ELLSL_WITH_ELAPI), the simulated device otherwise
+ */
+std::shared_ptr< GazeSource > createDefaultGazeSource( const char* clientName );
+
+/** @brief "<IP>:<PORT>" */
+std::string toString( const elapi::ELApi::ServerInfo& server );
+/** @brief parses "<IP>:<PORT>" */
+bool parseServer( const std::string& text, elapi::ELApi::ServerInfo& server );
+
+/** @brief enumerator name of the event, e.g. "TRACKING_STOPPED" */
+const char* toString( elapi::ELApi::Event event );
+
+/** @brief enumerator names of the return values, e.g. "NOT_TRACKING" */
+const char* toString( elapi::ELApi::ReturnConnect value );
+const char* toString( elapi::ELApi::ReturnStart value );
+const char* toString( elapi::ELApi::ReturnCalibrate value );
+const char* toString( elapi::ELApi::ReturnValidate value );
+
+}  // namespace ellsl
@@ -0,0 +1,92 @@
+// -----------------------------------------------------------------------
+// Copyright (C) 2019-2023, EyeLogic GmbH
+//
+// Permission is hereby granted, free of charge, to any person or
+// organization obtaining a copy of the software and accompanying
+// documentation covered by this license (the "Software") to use,
+// reproduce, display, distribute, execute, and transmit the Software,
+// and to prepare derivative works of the Software, and to permit
+// third-parties to whom the Software is furnished to do so.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, TITLE AND
+// NON-INFRINGEMENT. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR ANYONE
+// DISTRIBUTING THE SOFTWARE BE LIABLE FOR ANY DAMAGES OR OTHER
+// LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+// OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+// -----------------------------------------------------------------------
+
+
+#include "IndexContinuity.h"
+#include "StreamProfile.h"
+
+#include <cstring>
+
+using namespace ellsl;
+
+void
+IndexContinuity::reset( int64 restartThreshold )
+{
+    m_statistics       = { };
+    m_restartThreshold = restartThreshold;
+    m_lastIndex        = -1;
+    m_lastMicroSec     = 0;
+}
+
+IndexContinuity::Verdict
+IndexContinuity::check( const elapi::ELGazeSample& gazeSample, Gap& gap )
+{
+    const int64 index = gazeSample.index;
+    Verdict     verdict = Verdict::NEXT;
+    if ( m_lastIndex >= 0 ) {
+        if ( index <= m_lastIndex ) {
+            if ( m_lastIndex - index <= m_restartThreshold ) {
+                m_statistics.duplicates++;
+                return Verdict::DUPLICATE;
+            }
+            m_statistics.restarts++;
+            verdict = Verdict::RESTART;
+        } else if ( index > m_lastIndex + 1 ) {
+            gap.firstIndex    = static_cast< int32 >( m_lastIndex + 1 );
+            gap.count         = index - m_lastIndex - 1;
+            gap.beginMicroSec = m_lastMicroSec;
+            gap.endMicroSec   = gazeSample.timestampMicroSec;
+            m_statistics.gaps++;
+            m_statistics.missing += gap.count;
+            verdict = Verdict::GAP;
+        }
+    }
+    m_lastIndex    = index;
+    m_lastMicroSec = gazeSample.timestampMicroSec;
+    m_statistics.samples++;
+    return verdict;
+}
+
+void
+IndexContinuity::countFilled( uint64 count )
+{
+    m_statistics.filled += count;
+}
+
+const IndexContinuity::Statistics&
+IndexContinuity::statistics( ) const
+{
+    return m_statistics;
+}
+
+elapi::ELGazeSample
+IndexContinuity::placeholder( const Gap& gap, int64 offset )
+{
+    elapi::ELGazeSample gazeSample{ };
+    gazeSample.index = static_cast< int32 >( gap.firstIndex + offset );
+    // the missing samples are spread evenly between their neighbours
+    gazeSample.timestampMicroSec =
+        gap.beginMicroSec + ( gap.endMicroSec - gap.beginMicroSec ) * ( offset + 1 ) / ( gap.count + 1 );
+    for ( int32 channel = 1; channel < NCHANNELS; channel++ ) {
+        std::memcpy( reinterpret_cast< char* >( &gazeSample ) + CHANNEL_OFFSET[ channel ],
+                     &elapi::ELInvalidValue, sizeof( double ) );
+    }
+    return gazeSample;
+}
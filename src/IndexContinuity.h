@@ -0,0 +1,92 @@
+// -----------------------------------------------------------------------
+// Copyright (C) 2019-2023, EyeLogic GmbH
+//
+// Permission is hereby granted, free of charge, to any person or
+// organization obtaining a copy of the software and accompanying
+// documentation covered by this license (the "Software") to use,
+// reproduce, display, distribute, execute, and transmit the Software,
+// and to prepare derivative works of the Software, and to permit
+// third-parties to whom the Software is furnished to do so.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, TITLE AND
+// NON-INFRINGEMENT. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR ANYONE
+// DISTRIBUTING THE SOFTWARE BE LIABLE FOR ANY DAMAGES OR OTHER
+// LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+// OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+// -----------------------------------------------------------------------
+
+
+#pragma once
+
+#include <cstdint>
+
+using int32  = int32_t;
+using int64  = int64_t;
+using uint32 = uint32_t;
+using uint64 = uint64_t;
+
+#include "elapi/ELGazeSample.h"
+
+namespace ellsl
+{
+/**
+ * @brief tracks the continuity of ELGazeSample::index within a streaming session
+ *
+ * Not thread-safe, the owner has to serialize all calls.
+ */
+class IndexContinuity
+{
+public:
+    struct Statistics {
+        uint64 samples    = 0;
+        /** @brief number of gaps and of indices missing within them */
+        uint64 gaps       = 0;
+        uint64 missing    = 0;
+        /** @brief samples whose index was not larger than the previous one, they are dropped */
+        uint64 duplicates = 0;
+        /** @brief the index jumped back by more than the restart threshold */
+        uint64 restarts   = 0;
+        /** @brief placeholder samples inserted into gaps */
+        uint64 filled     = 0;
+    };
+
+    enum class Verdict {
+        NEXT,
+        GAP,
+        DUPLICATE,
+        RESTART,
+    };
+
+    /** @brief missing indices firstIndex ... firstIndex + count - 1 between two timestamps */
+    struct Gap {
+        int32 firstIndex;
+        int64 count;
+        int64 beginMicroSec;
+        int64 endMicroSec;
+    };
+
+    /** @brief starts a new session, an index decrease of more than restartThreshold restarts */
+    void reset( int64 restartThreshold );
+
+    /** @brief classifies the next sample, gap is filled in for Verdict::GAP */
+    Verdict check( const elapi::ELGazeSample& gazeSample, Gap& gap );
+
+    /** @brief counts placeholder samples inserted by the owner */
+    void countFilled( uint64 count );
+
+    const Statistics& statistics( ) const;
+
+    /** @brief sample of the gap with all channels but the frame number invalid */
+    static elapi::ELGazeSample placeholder( const Gap& gap, int64 offset );
+
+private:
+    Statistics m_statistics;
+    int64      m_restartThreshold = 0;
+    int64      m_lastIndex        = -1;
+    int64      m_lastMicroSec     = 0;
+};
+
+}  // namespace ellsl
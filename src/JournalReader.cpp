@@ -0,0 +1,157 @@
+// -----------------------------------------------------------------------
+// Copyright (C) 2019-2023, EyeLogic GmbH
+//
+// Permission is hereby granted, free of charge, to any person or
+// organization obtaining a copy of the software and accompanying
+// documentation covered by this license (the "Software") to use,
+// reproduce, display, distribute, execute, and transmit the Software,
+// and to prepare derivative works of the Software, and to permit
+// third-parties to whom the Software is furnished to do so.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, TITLE AND
+// NON-INFRINGEMENT. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR ANYONE
+// DISTRIBUTING THE SOFTWARE BE LIABLE FOR ANY DAMAGES OR OTHER
+// LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+// OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+// -----------------------------------------------------------------------
+
+
+#include "JournalReader.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <tuple>
+
+using namespace ellsl;
+
+namespace
+{
+// read pages are dropped from memory in steps of this size
+constexpr uint64 RELEASE_BYTES = uint64( 4 ) << 20;
+
+/** @brief splits <prefix>_<session>_<number>.eljournal into session and segment number */
+std::tuple< std::string, uint64 >
+segmentName( const std::filesystem::path& path )
+{
+    const std::string stem      = path.stem( ).string( );
+    const size_t      separator = stem.rfind( '_' );
+    if ( separator == std::string::npos ) {
+        return { stem, 0 };
+    }
+    const std::string number = stem.substr( separator + 1 );
+    const auto digit = []( char c ) { return c >= '0' && c <= '9'; };
+    if ( number.empty( ) || !std::all_of( number.begin( ), number.end( ), digit ) ) {
+        return { stem, 0 };
+    }
+    return { stem.substr( 0, separator ), std::stoull( number ) };
+}
+}  // namespace
+
+bool
+JournalReader::open( const std::string& path )
+{
+    namespace fs = std::filesystem;
+
+    m_paths.clear( );
+    m_nextPath = 0;
+    m_segment  = nullptr;
+
+    std::error_code ec;
+    const fs::path  origin( path );
+    const bool      directory = fs::is_directory( origin, ec );
+    if ( !directory && !fs::is_regular_file( origin, ec ) ) {
+        return false;
+    }
+
+    // a file selects its session from its segment onwards
+    std::string session;
+    uint64      first = 0;
+    if ( !directory ) {
+        std::tie( session, first ) = segmentName( origin );
+    }
+
+    std::vector< std::tuple< std::string, uint64, std::string > > found;
+    for ( const auto& entry :
+          fs::directory_iterator( directory ? origin : origin.parent_path( ), ec ) ) {
+        if ( !entry.is_regular_file( ec ) ||
+             entry.path( ).extension( ) != RecordingJournal::EXTENSION ) {
+            continue;
+        }
+        const auto name = segmentName( entry.path( ) );
+        if ( directory || ( std::get< 0 >( name ) == session && std::get< 1 >( name ) >= first ) ) {
+            found.emplace_back( std::get< 0 >( name ), std::get< 1 >( name ),
+                                entry.path( ).string( ) );
+        }
+    }
+    // sessions are named by their start time, so they sort chronologically
+    std::sort( found.begin( ), found.end( ) );
+    for ( const auto& segment : found ) {
+        m_paths.push_back( std::get< 2 >( segment ) );
+    }
+    return !m_paths.empty( );
+}
+
+bool
+JournalReader::next( Record& record )
+{
+    while ( true ) {
+        if ( m_segment && m_offset + sizeof( RecordingJournal::RecordHeader ) <= m_end ) {
+            RecordingJournal::RecordHeader header;
+            std::memcpy( &header, m_segment->data( ) + m_offset, sizeof( header ) );
+            const uint64 bytes = ( sizeof( header ) + header.bytes + 7 ) & ~uint64( 7 );
+            if ( header.type != 0 && m_offset + bytes <= m_end ) {
+                // the previous records are done with
+                if ( m_offset - m_released >= RELEASE_BYTES ) {
+                    m_segment->release( m_released, m_offset - m_released );
+                    m_released = m_offset;
+                }
+                record.type    = static_cast< RecordingJournal::RecordType >( header.type );
+                record.payload = m_segment->data( ) + m_offset + sizeof( header );
+                record.bytes   = header.bytes;
+                m_offset += bytes;
+                return true;
+            }
+        }
+        if ( !openSegment( ) ) {
+            return false;
+        }
+    }
+}
+
+const std::vector< std::string >&
+JournalReader::segments( ) const
+{
+    return m_paths;
+}
+
+bool
+JournalReader::openSegment( )
+{
+    m_segment = nullptr;
+    while ( m_nextPath < m_paths.size( ) ) {
+        m_segment = MappedFile::open( m_paths[ m_nextPath++ ], false );
+        if ( !m_segment || m_segment->size( ) < sizeof( RecordingJournal::SegmentHeader ) ) {
+            continue;
+        }
+        const auto* header =
+            reinterpret_cast< const RecordingJournal::SegmentHeader* >( m_segment->data( ) );
+        if ( std::memcmp( header->magic, RecordingJournal::MAGIC,
+                          sizeof( RecordingJournal::MAGIC ) ) != 0 ||
+             header->version != RecordingJournal::VERSION ) {
+            continue;
+        }
+        // a segment that is still being written, or was never recovered, ends at its commit
+        m_offset   = header->headerBytes;
+        m_end      = std::min( header->commitOffset.load( std::memory_order_acquire ),
+                               m_segment->size( ) );
+        m_released = 0;
+        m_segment->adviseSequential( );
+        return true;
+    }
+    m_segment = nullptr;
+    return false;
+}
@@ -0,0 +1,80 @@
+// -----------------------------------------------------------------------
+// Copyright (C) 2019-2023, EyeLogic GmbH
+//
+// Permission is hereby granted, free of charge, to any person or
+// organization obtaining a copy of the software and accompanying
+// documentation covered by this license (the "Software") to use,
+// reproduce, display, distribute, execute, and transmit the Software,
+// and to prepare derivative works of the Software, and to permit
+// third-parties to whom the Software is furnished to do so.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, TITLE AND
+// NON-INFRINGEMENT. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR ANYONE
+// DISTRIBUTING THE SOFTWARE BE LIABLE FOR ANY DAMAGES OR OTHER
+// LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+// OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+// -----------------------------------------------------------------------
+
+
+#pragma once
+
+#include <cstdint>
+
+using int32  = int32_t;
+using int64  = int64_t;
+using uint32 = uint32_t;
+using uint64 = uint64_t;
+
+#include "MappedFile.h"
+#include "RecordingJournal.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace ellsl
+{
+/**
+ * @brief reads the records of recording journal segments in order
+ *
+ * One segment is mapped at a time and pages are dropped from memory once they have been read, so
+ * recordings of any length are read in constant memory.
+ */
+class JournalReader
+{
+public:
+    struct Record {
+        RecordingJournal::RecordType type;
+        /** @brief valid until the next call of next( ) */
+        const char* payload;
+        uint32      bytes;
+    };
+
+    /**
+     * @brief opens a segment file and the following segments of its session, or all segments in
+     * a directory
+     * @return false if no segment was found
+     */
+    bool open( const std::string& path );
+
+    /** @return false after the last record of the last segment */
+    bool next( Record& record );
+
+    /** @brief the segment files to read, in order */
+    const std::vector< std::string >& segments( ) const;
+
+private:
+    bool openSegment( );
+
+    std::vector< std::string >    m_paths;
+    size_t                        m_nextPath = 0;
+    std::unique_ptr< MappedFile > m_segment;
+    uint64                        m_offset   = 0;
+    uint64                        m_end      = 0;
+    uint64                        m_released = 0;
+};
+
+}  // namespace ellsl
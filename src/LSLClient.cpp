@@ -19,8 +19,9 @@
 // -----------------------------------------------------------------------
 
 #include "LSLClient.h"
+#include "Log.h"
 
-#include <iostream>
+#include <algorithm>
 #include <iomanip>
 #include <sstream>
 #include <chrono>
@@ -33,11 +34,25 @@ using namespace ellsl;
 
 namespace
 {
-const int32 NCHANNELS = 17;
+// 4 seconds of samples at the highest framerate of the device
+const size_t SAMPLE_RING_CAPACITY = 4096;
+// the reader re-checks whether it should stop at least this often
+const int32                     READER_POLL_TIMEOUT_MS = 100;
+const std::chrono::milliseconds READER_DISCONNECTED_WAIT( 100 );
+// the publisher re-checks a partially filled chunk this often until its time limit has passed
+const std::chrono::milliseconds PUBLISHER_CHUNK_TIMEOUT( 1 );
+// otherwise the idle publisher only wakes up this often, e.g. for the diagnostics stream
+const std::chrono::milliseconds PUBLISHER_IDLE_TIMEOUT( 100 );
+// interval at which the consumers of the outlet are checked
+const std::chrono::milliseconds CONSUMER_POLL_INTERVAL( 100 );
 }
 
-LSLClient::LSLClient( )
+LSLClient::LSLClient( std::shared_ptr< GazeSource > source )
+    : m_api( std::move( source ) ), m_sampleRing( SAMPLE_RING_CAPACITY )
 {
+    startPublisher( );
+    startWatcher( );
+    startReconnector( );
 }
 
 LSLClient::~LSLClient( )
@@ -63,14 +78,173 @@ bool
 LSLClient::hasConsumers( ) const
 {
     std::unique_lock< std::mutex > lock( m_resourceMutex );
-    return m_outlet && m_outlet->have_consumers( );
+    return m_outlet && m_outlet->haveConsumers( );
+}
+
+SampleRing< LSLClient::QueuedSample >::Statistics
+LSLClient::ringStatistics( ) const
+{
+    return m_sampleRing.statistics( );
+}
+
+IndexContinuity::Statistics
+LSLClient::continuityStatistics( ) const
+{
+    std::unique_lock< std::mutex > lock( m_resourceMutex );
+    return m_continuity.statistics( );
+}
+
+void
+LSLClient::setGapFilling( bool enabled )
+{
+    std::unique_lock< std::mutex > lock( m_resourceMutex );
+    m_fillGaps = enabled;
+}
+
+bool
+LSLClient::gapFilling( ) const
+{
+    std::unique_lock< std::mutex > lock( m_resourceMutex );
+    return m_fillGaps;
+}
+
+bool
+LSLClient::setChunking( int32 samples, int64 microseconds )
+{
+    if ( samples < 1 || samples > MAX_CHUNK_SAMPLES || microseconds < 0 ) {
+        return false;
+    }
+
+    std::unique_lock< std::mutex > lock( m_resourceMutex );
+    m_chunkSamples  = samples;
+    m_chunkDuration = std::chrono::microseconds( microseconds );
+    if ( m_outlet ) {
+        m_outlet->setChunking( m_chunkSamples, m_chunkDuration );
+    }
+    return true;
+}
+
+std::tuple< int32, int64 >
+LSLClient::chunking( ) const
+{
+    std::unique_lock< std::mutex > lock( m_resourceMutex );
+    return { m_chunkSamples, m_chunkDuration.count( ) };
+}
+
+void
+LSLClient::setStreamProfile( const StreamProfile& profile )
+{
+    std::unique_lock< std::mutex > lock( m_resourceMutex );
+    m_streamProfile = profile;
+}
+
+StreamProfile
+LSLClient::streamProfile( ) const
+{
+    std::unique_lock< std::mutex > lock( m_resourceMutex );
+    return m_streamProfile;
+}
+
+void
+LSLClient::setEventDetection( bool enabled, const EventDetector::Config& config )
+{
+    std::unique_lock< std::mutex > lock( m_resourceMutex );
+    m_detectEvents   = enabled;
+    m_detectorConfig = config;
+}
+
+bool
+LSLClient::eventStatistics( MarkerOutlet::Statistics& statistics ) const
+{
+    std::unique_lock< std::mutex > lock( m_resourceMutex );
+    if ( !m_events ) {
+        return false;
+    }
+    statistics = m_events->statistics( );
+    return true;
+}
+
+void
+LSLClient::setGazeFilter( const FilterConfig& filter )
+{
+    std::unique_lock< std::mutex > lock( m_resourceMutex );
+    m_filterConfig = filter;
+}
+
+FilterConfig
+LSLClient::gazeFilter( ) const
+{
+    std::unique_lock< std::mutex > lock( m_resourceMutex );
+    return m_filterConfig;
+}
+
+void
+LSLClient::setVisualAngles( bool enabled, const TrackerGeometry& geometry )
+{
+    std::unique_lock< std::mutex > lock( m_resourceMutex );
+    m_visualAngles   = enabled;
+    m_trackerGeometry = geometry;
+}
+
+bool
+LSLClient::visualAngles( ) const
+{
+    std::unique_lock< std::mutex > lock( m_resourceMutex );
+    return m_visualAngles;
+}
+
+void
+LSLClient::setDecimatedRates( const std::vector< int32 >& rates )
+{
+    std::unique_lock< std::mutex > lock( m_resourceMutex );
+    m_decimatedRates = rates;
+}
+
+std::vector< int32 >
+LSLClient::decimatedRates( ) const
+{
+    std::unique_lock< std::mutex > lock( m_resourceMutex );
+    return m_decimatedRates;
+}
+
+void
+LSLClient::setIdleGrace( std::chrono::milliseconds grace )
+{
+    std::unique_lock< std::mutex > lock( m_resourceMutex );
+    m_idleGrace = grace;
+}
+
+std::chrono::milliseconds
+LSLClient::idleGrace( ) const
+{
+    std::unique_lock< std::mutex > lock( m_resourceMutex );
+    return m_idleGrace;
+}
+
+bool
+LSLClient::isIdle( ) const
+{
+    std::unique_lock< std::mutex > lock( m_resourceMutex );
+    return m_idle;
+}
+
+void
+LSLClient::setReconnect( std::chrono::milliseconds initial, std::chrono::milliseconds maximum )
+{
+    std::unique_lock< std::mutex > lock( m_reconnectMutex );
+    m_reconnectInitial = initial;
+    m_reconnectMaximum = std::max( initial, maximum );
 }
 
 void
 LSLClient::shutdown( )
 {
+    stopReconnector( );
+    stopWatcher( );
+    stopCalibrationTask( );
     disconnectELApi( );
     closeStream( );
+    stopPublisher( );
 }
 
 void
@@ -79,175 +253,304 @@ LSLClient::closeStream( )
     stopTracking( );
 
     std::unique_lock< std::mutex > lock( m_resourceMutex );
-    m_outlet = nullptr;
+    if ( m_outlet ) {
+        postMarker( lsl::local_clock( ), "STREAM_CLOSE" );
+    }
+    m_outletOpen    = false;
+    m_haveConsumers = false;
+    m_idle          = false;
+    m_trackingRate  = 0;
+    m_outlet        = nullptr;
+    m_detector      = nullptr;
+    m_events        = nullptr;
+    m_decimated.clear( );
+    if ( m_xdf ) {
+        m_xdf->endStream( );
+    }
+#ifdef ELLSL_ENABLE_DIAGNOSTICS
+    m_diagnostics = nullptr;
+#endif
 }
 
-std::unique_lock< std::mutex >
-LSLClient::openStream( int32 samplerate, std::unique_lock< std::mutex >&& lock )
+LSLClient::StreamSettings
+LSLClient::streamSettings( int32 samplerate ) const
 {
-    assert( lock.owns_lock( ) );
+    StreamSettings settings{ samplerate,
+                             m_streamProfile,
+                             { m_filterConfig, m_visualAngles, m_trackerGeometry },
+                             m_deviceConfig->deviceSerial,
+                             streamSuffix( ),
+                             m_clockMapping,
+                             m_chunkSamples,
+                             m_chunkDuration,
+                             m_decimatedRates,
+                             m_detectEvents,
+                             m_detectorConfig,
+                             m_screenConfig != nullptr,
+                             m_screenConfig ? *m_screenConfig : elapi::ELApi::ScreenConfig{ },
+                             m_sampleRing.statistics( ).overflows };
+    return settings;
+}
 
-    if ( !m_api ) {
-        return std::move( lock );
+LSLClient::StreamOutlets
+LSLClient::buildStream( const StreamSettings& settings )
+{
+    // the meta-data carries the clock mapping of a previous stream
+    StreamOutlets outlets;
+    outlets.gaze = GazeOutlet::create( settings.profile, settings.samplerate, settings.deviceSerial,
+                                       &settings.clockMapping, GAZE_STREAM_NAME + settings.suffix,
+                                       settings.derived );
+    outlets.gaze->setChunking( settings.chunkSamples, settings.chunkDuration );
+    for ( const int32 rate : settings.decimatedRates ) {
+        if ( rate >= settings.samplerate || settings.samplerate % rate != 0 ) {
+            Log::warning( "skipping decimated stream at " + std::to_string( rate ) +
+                          " Hz - not an integer fraction of " +
+                          std::to_string( settings.samplerate ) + " Hz" );
+            continue;
+        }
+        outlets.decimated.push_back( std::make_unique< DecimatedOutlet >(
+            settings.profile, settings.samplerate, settings.samplerate / rate,
+            settings.deviceSerial, &settings.clockMapping,
+            GAZE_STREAM_NAME + settings.suffix + "_" + std::to_string( rate ) + "Hz" ) );
+    }
+    if ( settings.detectEvents && settings.haveScreen ) {
+        outlets.detector = std::make_unique< EventDetector >( settings.detectorConfig,
+                                                              settings.screen, settings.samplerate );
+        outlets.events   = std::make_unique< MarkerOutlet >(
+            settings.deviceSerial, EVENT_STREAM_NAME + settings.suffix, "events" );
     }
+#ifdef ELLSL_ENABLE_DIAGNOSTICS
+    outlets.diagnostics = std::make_unique< Diagnostics >(
+        settings.samplerate, settings.deviceSerial, settings.overflows,
+        "EyeLogicDiagnostics" + settings.suffix );
+    outlets.gaze->setDiagnostics( outlets.diagnostics.get( ) );
+#endif
+    return outlets;
+}
 
+void
+LSLClient::installStream( StreamOutlets& outlets, double switchClock )
+{
+    // the ring is only ever popped while m_resourceMutex is held, so this thread may stand in for
+    // the publisher: samples acquired before the switch go to the previous outlet
+    QueuedSample queued;
+    bool         switched = false;
+    while ( m_sampleRing.pop( queued ) ) {
+        if ( queued.callbackClock >= switchClock ) {
+            switched = true;
+            break;
+        }
+        publishSample( queued );
+    }
     if ( m_outlet ) {
-        m_outlet = nullptr;
-    }
-
-    // create streaminfo
-    lsl::stream_info lslInfo( "EyeLogic",
-                              "Gaze",
-                              NCHANNELS,
-                              samplerate,
-                              lsl::cf_double64,
-                              "EyeLogic One | " + std::to_string( m_deviceConfig->deviceSerial ) );
-
-    // append some (optional) meta-data
-    lsl::xml_element channels = lslInfo.desc( ).append_child( "channels" );
-
-    channels.append_child( "channel" )
-        .append_child_value( "label", "FrameNumber" )
-        .append_child_value( "type", "FrameNumber" )
-        .append_child_value( "unit", "number" );
-
-    channels.append_child( "channel" )
-        .append_child_value( "label", "Screen_X_raw" )
-        .append_child_value( "eye", "both" )
-        .append_child_value( "type", "ScreenX" )
-        .append_child_value( "unit", "pixels" )
-        .append_child_value( "coordinate_system", "image-space" );
-    channels.append_child( "channel" )
-        .append_child_value( "label", "Screen_Y_raw" )
-        .append_child_value( "eye", "both" )
-        .append_child_value( "type", "ScreenY" )
-        .append_child_value( "unit", "pixels" )
-        .append_child_value( "coordinate_system", "image-space" );
-    channels.append_child( "channel" )
-        .append_child_value( "label", "Screen_X_filtered" )
-        .append_child_value( "eye", "both" )
-        .append_child_value( "type", "ScreenX" )
-        .append_child_value( "unit", "pixels" )
-        .append_child_value( "coordinate_system", "image-space" );
-    channels.append_child( "channel" )
-        .append_child_value( "label", "Screen_Y_filtered" )
-        .append_child_value( "eye", "both" )
-        .append_child_value( "type", "ScreenY" )
-        .append_child_value( "unit", "pixels" )
-        .append_child_value( "coordinate_system", "image-space" );
-
-    channels.append_child( "channel" )
-        .append_child_value( "label", "Screen_X_left" )
-        .append_child_value( "eye", "left" )
-        .append_child_value( "type", "ScreenX" )
-        .append_child_value( "unit", "pixels" )
-        .append_child_value( "coordinate_system", "image-space" );
-    channels.append_child( "channel" )
-        .append_child_value( "label", "Screen_Y_left" )
-        .append_child_value( "eye", "left" )
-        .append_child_value( "type", "ScreenY" )
-        .append_child_value( "unit", "pixels" )
-        .append_child_value( "coordinate_system", "image-space" );
-    channels.append_child( "channel" )
-        .append_child_value( "label", "Screen_X_right" )
-        .append_child_value( "eye", "right" )
-        .append_child_value( "type", "ScreenX" )
-        .append_child_value( "unit", "pixels" )
-        .append_child_value( "coordinate_system", "image-space" );
-    channels.append_child( "channel" )
-        .append_child_value( "label", "Screen_Y_right" )
-        .append_child_value( "eye", "right" )
-        .append_child_value( "type", "ScreenY" )
-        .append_child_value( "unit", "pixels" )
-        .append_child_value( "coordinate_system", "image-space" );
-
-    channels.append_child( "channel" )
-        .append_child_value( "label", "Diameter_left" )
-        .append_child_value( "eye", "left" )
-        .append_child_value( "type", "Diameter" )
-        .append_child_value( "unit", "millimeters" );
-    channels.append_child( "channel" )
-        .append_child_value( "label", "Diameter_right" )
-        .append_child_value( "eye", "right" )
-        .append_child_value( "type", "Diameter" )
-        .append_child_value( "unit", "millimeters" );
-
-    channels.append_child( "channel" )
-        .append_child_value( "label", "EyePosition_X_left" )
-        .append_child_value( "eye", "left" )
-        .append_child_value( "type", "PositionX" )
-        .append_child_value( "unit", "millimeters" )
-        .append_child_value( "coordinate_system", "world-space" );
-    channels.append_child( "channel" )
-        .append_child_value( "label", "EyePosition_Y_left" )
-        .append_child_value( "eye", "left" )
-        .append_child_value( "type", "PositionY" )
-        .append_child_value( "unit", "millimeters" )
-        .append_child_value( "coordinate_system", "world-space" );
-    channels.append_child( "channel" )
-        .append_child_value( "label", "EyePosition_Z_left" )
-        .append_child_value( "eye", "left" )
-        .append_child_value( "type", "PositionZ" )
-        .append_child_value( "unit", "millimeters" )
-        .append_child_value( "coordinate_system", "world-space" );
-    channels.append_child( "channel" )
-        .append_child_value( "label", "EyePosition_X_right" )
-        .append_child_value( "eye", "right" )
-        .append_child_value( "type", "PositionX" )
-        .append_child_value( "unit", "millimeters" )
-        .append_child_value( "coordinate_system", "world-space" );
-    channels.append_child( "channel" )
-        .append_child_value( "label", "EyePosition_Y_right" )
-        .append_child_value( "eye", "right" )
-        .append_child_value( "type", "PositionY" )
-        .append_child_value( "unit", "millimeters" )
-        .append_child_value( "coordinate_system", "world-space" );
-    channels.append_child( "channel" )
-        .append_child_value( "label", "EyePosition_Z_right" )
-        .append_child_value( "eye", "right" )
-        .append_child_value( "type", "PositionZ" )
-        .append_child_value( "unit", "millimeters" )
-        .append_child_value( "coordinate_system", "world-space" );
-
-    lslInfo.desc( )
-        .append_child( "acquisition" )
-        .append_child_value( "manufacturer", "EyeLogic" )
-        .append_child_value( "model", "One" )
-        .append_child_value( "serial number", std::to_string( m_deviceConfig->deviceSerial ) );
-
-    // instantiate new m_outlet
-    m_outlet = std::make_unique< lsl::stream_outlet >( lslInfo );
+        m_outlet->flush( );
+        m_outlet->setJournal( nullptr );
+        m_outlet->setXdfWriter( nullptr );
+#ifdef ELLSL_ENABLE_DIAGNOSTICS
+        m_outlet->setDiagnostics( nullptr );
+#endif
+    }
 
-    return std::move( lock );
+    std::swap( m_outlet, outlets.gaze );
+    std::swap( m_decimated, outlets.decimated );
+    std::swap( m_detector, outlets.detector );
+    std::swap( m_events, outlets.events );
+#ifdef ELLSL_ENABLE_DIAGNOSTICS
+    std::swap( m_diagnostics, outlets.diagnostics );
+#endif
+    // the screen may have changed while the outlets were built
+    if ( m_screenConfig ) {
+        m_outlet->setScreen( *m_screenConfig );
+        if ( m_detector ) {
+            m_detector->setScreen( *m_screenConfig );
+        }
+    }
+
+    const int32 samplerate = m_outlet->samplerate( );
+    if ( m_journal ) {
+        m_journal->beginStream( m_streamProfile, m_outlet->channelCount( ), samplerate,
+                                m_deviceConfig->deviceSerial, m_outlet->info( ).as_xml( ),
+                                m_outlet->derived( ) );
+        m_outlet->setJournal( m_journal.get( ) );
+    }
+    if ( m_xdf ) {
+        m_xdf->beginStream( m_outlet->info( ).as_xml( ) );
+        m_outlet->setXdfWriter( m_xdf.get( ) );
+    }
+    // a new session - an index falling back by more than a second means the device restarted
+    m_continuity.reset( samplerate );
+    m_haveConsumers = false;
+    m_outletOpen    = true;
+    postMarker( lsl::local_clock( ), "STREAM_OPEN samplerate=" + std::to_string( samplerate ) +
+                                         " profile=" + toString( m_streamProfile ) );
+    if ( switched ) {
+        publishSample( queued );
+    }
+}
+
+bool
+LSLClient::setJournal( const std::string& directory, uint64 segmentBytes )
+{
+    std::unique_ptr< RecordingJournal > journal;
+    if ( !directory.empty( ) ) {
+        // recovery and preallocation of the first segment happen outside the lock
+        journal = RecordingJournal::open( directory, segmentBytes );
+        if ( !journal ) {
+            return false;
+        }
+    }
+
+    std::unique_lock< std::mutex > lock( m_resourceMutex );
+    if ( m_outlet ) {
+        m_outlet->flush( );
+        if ( journal ) {
+            journal->beginStream( m_outlet->profile( ), m_outlet->channelCount( ),
+                                  m_outlet->samplerate( ),
+                                  m_deviceConfig ? m_deviceConfig->deviceSerial : 0,
+                                  m_outlet->info( ).as_xml( ), m_outlet->derived( ) );
+        }
+        m_outlet->setJournal( journal.get( ) );
+    }
+    std::swap( m_journal, journal );
+    lock.unlock( );
+    // the previous journal, if any, is closed without holding the lock
+    return true;
+}
+
+bool
+LSLClient::journalStatistics( RecordingJournal::Statistics& statistics ) const
+{
+    std::unique_lock< std::mutex > lock( m_resourceMutex );
+    if ( !m_journal ) {
+        return false;
+    }
+    statistics = m_journal->statistics( );
+    return true;
+}
+
+bool
+LSLClient::setXdfRecording( const std::string& path )
+{
+    std::unique_ptr< XdfWriter > xdf;
+    if ( !path.empty( ) ) {
+        xdf = XdfWriter::open( path );
+        if ( !xdf ) {
+            return false;
+        }
+    }
+
+    std::unique_lock< std::mutex > lock( m_resourceMutex );
+    if ( m_outlet ) {
+        m_outlet->flush( );
+        if ( xdf ) {
+            xdf->beginStream( m_outlet->info( ).as_xml( ) );
+        }
+        m_outlet->setXdfWriter( xdf.get( ) );
+    }
+    std::swap( m_xdf, xdf );
+    lock.unlock( );
+    // the previous file, if any, gets its footer and is closed without holding the lock
+    return true;
+}
+
+bool
+LSLClient::xdfStatistics( XdfWriter::Statistics& statistics ) const
+{
+    std::unique_lock< std::mutex > lock( m_resourceMutex );
+    if ( !m_xdf ) {
+        return false;
+    }
+    statistics = m_xdf->statistics( );
+    return true;
+}
+
+void
+LSLClient::setAcquisition( Acquisition acquisition, const ThreadConfig& readerConfig )
+{
+    std::unique_lock< std::mutex > lock( m_resourceMutex );
+    m_acquisition  = acquisition;
+    m_readerConfig = readerConfig;
 }
 
 void
 LSLClient::disconnectELApi( )
 {
     std::unique_lock< std::mutex > lock( m_resourceMutex );
+    stopReader( );
+    if ( !m_api ) {
+        return;
+    }
+    m_api->registerEventListener( nullptr );
+    m_api->registerGazeSampleListener( nullptr );
     m_api->disconnect( );
 }
 
+void
+LSLClient::setDeviceStreamNames( bool enabled )
+{
+    std::unique_lock< std::mutex > lock( m_resourceMutex );
+    m_deviceStreamNames = enabled;
+}
+
+uint64
+LSLClient::deviceSerial( ) const
+{
+    std::unique_lock< std::mutex > lock( m_resourceMutex );
+    return m_deviceConfig ? m_deviceConfig->deviceSerial : 0;
+}
+
 elapi::ELApi::ReturnConnect
 LSLClient::connectELApi( )
+{
+    return connect( nullptr );
+}
+
+elapi::ELApi::ReturnConnect
+LSLClient::connectRemote( const elapi::ELApi::ServerInfo& server )
+{
+    return connect( &server );
+}
+
+elapi::ELApi::ReturnConnect
+LSLClient::connect( const elapi::ELApi::ServerInfo* server )
 {
     std::unique_lock< std::mutex > lock( m_resourceMutex );
 
     if ( !m_api ) {
-        m_api = std::make_unique< elapi::ELApi >( "LSL Client" );
+        m_api = createDefaultGazeSource( "LSL Client" );
     }
-    // connect to server
-    const auto retConnect = m_api->connect( );
+    // connect to the local or the given remote server
+    const auto retConnect = server ? m_api->connectRemote( *server ) : m_api->connect( );
     if ( retConnect != elapi::ELApi::ReturnConnect::SUCCESS ) {
         return retConnect;
     }
+    m_server = server ? std::make_unique< elapi::ELApi::ServerInfo >( *server ) : nullptr;
 
-    // register ELApi callback handlers
+    // register ELApi callback handlers - events are always received through the listener since
+    // polling getNextEvent may miss events
     m_api->registerEventListener( this );
-    m_api->registerGazeSampleListener( this );
+    if ( m_acquisition == Acquisition::POLLING ) {
+        m_api->registerGazeSampleListener( nullptr );
+        startReader( );
+    } else {
+        stopReader( );
+        m_api->registerGazeSampleListener( this );
+    }
 
     lock = updateDevice( std::move( lock ) );
 
+    // device and session events of this device
+    if ( !m_markers || m_markers->deviceSerial( ) != m_deviceConfig->deviceSerial ) {
+        m_markers = nullptr;
+        m_markers = std::make_unique< MarkerOutlet >( m_deviceConfig->deviceSerial,
+                                                      MARKER_STREAM_NAME + streamSuffix( ) );
+    }
+    if ( !m_validation || m_validation->deviceSerial( ) != m_deviceConfig->deviceSerial ) {
+        m_validation = nullptr;
+        m_validation = std::make_unique< ValidationOutlet >(
+            m_deviceConfig->deviceSerial, VALIDATION_STREAM_NAME + streamSuffix( ) );
+    }
+
     return retConnect;
 }
 
@@ -263,20 +566,39 @@ LSLClient::requestTracking( int32 samplerate )
         return elapi::ELApi::ReturnStart::INVALID_FRAMERATE_MODE;
     }
 
-    auto retTracking = m_api->requestTracking( m_hz2Mode[ samplerate ] );
-    if ( retTracking != elapi::ELApi::ReturnStart::SUCCESS ) {
-        return retTracking;
+    // the same stream is kept, e.g. when tracking resumes after a reconnect - the outlets of
+    // another layout are built without the lock while the current ones keep publishing
+    StreamOutlets outlets;
+    if ( !m_outlet ||
+         !m_outlet->sameStream( m_streamProfile, samplerate, m_deviceConfig->deviceSerial,
+                                GAZE_STREAM_NAME + streamSuffix( ),
+                                { m_filterConfig, m_visualAngles, m_trackerGeometry } ) ) {
+        const StreamSettings settings = streamSettings( samplerate );
+        lock.unlock( );
+        outlets = buildStream( settings );
+        lock.lock( );
+        if ( !m_api || m_hz2Mode.count( samplerate ) == 0 ) {
+            lock.unlock( );
+            return elapi::ELApi::ReturnStart::FAILURE;
+        }
     }
 
-    if ( !m_outlet || m_outlet->info( ).nominal_srate( ) != samplerate ) {
-        lock = openStream( samplerate, std::move( lock ) );
+    const double switchClock = lsl::local_clock( );
+    const auto   retTracking = m_api->requestTracking( m_hz2Mode[ samplerate ] );
+    if ( retTracking == elapi::ELApi::ReturnStart::SUCCESS ) {
+        m_idle         = false;
+        m_trackingRate = samplerate;
+        if ( outlets.gaze ) {
+            installStream( outlets, switchClock );
+        }
     }
-
+    // unused or replaced outlets are closed without holding the lock
+    lock.unlock( );
     return retTracking;
 }
 
 elapi::ELApi::ReturnCalibrate
-LSLClient::requestCalibration( int32 calibration )
+LSLClient::requestCalibration( int32 calibration, CalibrationFinished finished )
 {
     std::unique_lock< std::mutex > lock( m_resourceMutex );
     if ( !m_api ) {
@@ -285,7 +607,108 @@ LSLClient::requestCalibration( int32 calibration )
     if ( m_pt2Mode.count( calibration ) == 0 ) {
         return elapi::ELApi::ReturnCalibrate::INVALID_CALIBRATION_MODE;
     }
-    return m_api->calibrate( m_pt2Mode[ calibration ] );
+    if ( !claimCalibrationTask( ) ) {
+        return elapi::ELApi::ReturnCalibrate::ALREADY_BUSY;
+    }
+    // the stream is not valid while the subject follows the calibration points
+    postMarker( lsl::local_clock( ), "CALIBRATION_BEGIN mode=" + std::to_string( calibration ) );
+    m_calibrationTask = std::thread( &LSLClient::runCalibration, this, m_api,
+                                     m_pt2Mode[ calibration ], std::move( finished ) );
+    return elapi::ELApi::ReturnCalibrate::SUCCESS;
+}
+
+elapi::ELApi::ReturnValidate
+LSLClient::requestValidation( ValidationFinished finished )
+{
+    std::unique_lock< std::mutex > lock( m_resourceMutex );
+    if ( !m_api ) {
+        return elapi::ELApi::ReturnValidate::FAILURE;
+    }
+    if ( !claimCalibrationTask( ) ) {
+        return elapi::ELApi::ReturnValidate::ALREADY_BUSY;
+    }
+    postMarker( lsl::local_clock( ), "VALIDATION_BEGIN" );
+    m_calibrationTask =
+        std::thread( &LSLClient::runValidation, this, m_api, std::move( finished ) );
+    return elapi::ELApi::ReturnValidate::SUCCESS;
+}
+
+void
+LSLClient::abortCalibration( )
+{
+    std::shared_ptr< GazeSource > source;
+    {
+        std::unique_lock< std::mutex > lock( m_resourceMutex );
+        source = m_api;
+    }
+    // the task holds no lock while it waits in the ELApi
+    if ( source && m_calibrating ) {
+        source->abortCalibValidation( );
+    }
+}
+
+bool
+LSLClient::isCalibrating( ) const
+{
+    return m_calibrating;
+}
+
+bool
+LSLClient::claimCalibrationTask( )
+{
+    if ( m_calibrating.exchange( true ) ) {
+        return false;
+    }
+    // the previous task has left all locks behind once it cleared m_calibrating
+    if ( m_calibrationTask.joinable( ) ) {
+        m_calibrationTask.join( );
+    }
+    return true;
+}
+
+void
+LSLClient::stopCalibrationTask( )
+{
+    abortCalibration( );
+    if ( m_calibrationTask.joinable( ) ) {
+        m_calibrationTask.join( );
+    }
+}
+
+void
+LSLClient::runCalibration( std::shared_ptr< GazeSource > source, int32 mode,
+                           CalibrationFinished finished )
+{
+    const auto retCalibrate = source->calibrate( mode );
+    {
+        std::unique_lock< std::mutex > lock( m_resourceMutex );
+        postMarker( lsl::local_clock( ), std::string( "CALIBRATION_END result=" ) +
+                                             toString( retCalibrate ) );
+    }
+    if ( finished ) {
+        finished( retCalibrate );
+    }
+    m_calibrating = false;
+}
+
+void
+LSLClient::runValidation( std::shared_ptr< GazeSource > source, ValidationFinished finished )
+{
+    elapi::ELApi::ELValidationResult validation;
+    const auto                       retValidate = source->validate( validation );
+    {
+        std::unique_lock< std::mutex > lock( m_resourceMutex );
+        const double                   timestamp = lsl::local_clock( );
+        postMarker( timestamp,
+                    std::string( "VALIDATION_END result=" ) + toString( retValidate ) );
+        if ( retValidate == elapi::ELApi::ReturnValidate::SUCCESS && m_validation ) {
+            m_validation->publish( validation, timestamp );
+        }
+    }
+    if ( finished ) {
+        finished( retValidate, validation );
+    }
+    m_calibrating = false;
 }
 
 void
@@ -316,26 +739,54 @@ LSLClient::listCalibrations( )
     return values;
 }
 
+std::vector< int32 >
+LSLClient::framerates( ) const
+{
+    std::lock_guard< std::mutex > lock( m_resourceMutex );
+    std::vector< int32 >          values;
+    for ( const auto& value_mode : m_hz2Mode ) {
+        values.push_back( value_mode.first );
+    }
+    return values;
+}
+
+std::vector< int32 >
+LSLClient::calibrations( ) const
+{
+    std::lock_guard< std::mutex > lock( m_resourceMutex );
+    std::vector< int32 >          values;
+    for ( const auto& value_mode : m_pt2Mode ) {
+        values.push_back( value_mode.first );
+    }
+    return values;
+}
+
 void STDCALL
 LSLClient::onEvent( elapi::ELApi::Event event )
 {
     if ( !m_api ) {
         return;
     }
-    std::string out = "\n";
+    const double timestamp = lsl::local_clock( );
+    std::string  out;
+    bool         restore = false;
     switch ( event ) {
-        case elapi::ELApi::Event::SCREEN_CHANGED:
+        case elapi::ELApi::Event::SCREEN_CHANGED: {
             out += "stimulus screen has changed";
-            break;
+            std::unique_lock< std::mutex > lock( m_resourceMutex );
+            updateDevice( std::move( lock ) );
+        } break;
         case elapi::ELApi::Event::CONNECTION_CLOSED: {
             out += "server has closed the connection";
             std::unique_lock< std::mutex > lock( m_resourceMutex );
             updateDevice( std::move( lock ) );
+            restore = true;
         } break;
         case elapi::ELApi::Event::DEVICE_CONNECTED: {
             out += "a new device has connected";
             std::unique_lock< std::mutex > lock( m_resourceMutex );
             updateDevice( std::move( lock ) );
+            restore = true;
         } break;
         case elapi::ELApi::Event::DEVICE_DISCONNECTED: {
             out += "device has disconnected";
@@ -346,87 +797,463 @@ LSLClient::onEvent( elapi::ELApi::Event event )
             out += "tracking has stopped";
             break;
     }
-    std::cout << out + "\n>> ";
-    std::cout << std::flush;
+    {
+        std::unique_lock< std::mutex > lock( m_resourceMutex );
+        postMarker( timestamp, toString( event ) );
+        if ( m_journal ) {
+            m_journal->appendEvent( timestamp, static_cast< int32 >( event ), out );
+        }
+    }
+    Log::info( out );
+    // the callback thread of the ELApi must not wait for the server
+    if ( restore ) {
+        requestRestore( );
+    }
 }
 
 void STDCALL
 LSLClient::onGazeSample( const elapi::ELGazeSample& gazeSample )
 {
-    std::unique_lock< std::mutex > lock( m_resourceMutex );
+    enqueueSample( gazeSample );
+}
+
+void
+LSLClient::enqueueSample( const elapi::ELGazeSample& gazeSample )
+{
+    // runs on the ELApi or reader thread: only hand the sample over to the publisher, never block
+    const double callbackClock = lsl::local_clock( );
+#ifdef ELLSL_ENABLE_DIAGNOSTICS
+    const int64 callbackMicroSec = Diagnostics::clock( );
+#endif
+    if ( !m_outletOpen.load( std::memory_order_relaxed ) ) {
+        return;
+    }
+#ifdef ELLSL_ENABLE_DIAGNOSTICS
+    m_sampleRing.push( { gazeSample, callbackClock, callbackMicroSec } );
+#else
+    m_sampleRing.push( { gazeSample, callbackClock } );
+#endif
+
+    // pairs with the fence in runPublisher( ): either the publisher sees the new sample or we see
+    // that it went idle and wake it up
+    std::atomic_thread_fence( std::memory_order_seq_cst );
+    if ( m_publisherIdle.load( std::memory_order_relaxed ) ) {
+        // the publisher holds the mutex from its last check until it waits, so the notification
+        // cannot get lost in between
+        {
+            std::lock_guard< std::mutex > lock( m_publisherMutex );
+        }
+        m_publisherWakeup.notify_one( );
+    }
+}
+
+void
+LSLClient::startReader( )
+{
+    if ( m_reader.joinable( ) ) {
+        return;
+    }
+    m_readerRun = true;
+    m_reader    = std::thread( &LSLClient::runReader, this, m_api, m_readerConfig );
+}
+
+void
+LSLClient::stopReader( )
+{
+    if ( !m_reader.joinable( ) ) {
+        return;
+    }
+    m_readerRun = false;
+    m_reader.join( );
+}
+
+void
+LSLClient::runReader( std::shared_ptr< GazeSource > source, ThreadConfig config )
+{
+    if ( !configureCurrentThread( config ) ) {
+        Log::warning( "cannot apply priority " + toString( config.priority ) + " / cpu " +
+                      std::to_string( config.cpu ) + " to the reader thread" );
+    }
+
+    elapi::ELGazeSample gazeSample;
+    while ( m_readerRun ) {
+        switch ( source->getNextGazeSample( gazeSample, READER_POLL_TIMEOUT_MS ) ) {
+            case elapi::ELApi::ReturnNextData::SUCCESS:
+                enqueueSample( gazeSample );
+                break;
+            case elapi::ELApi::ReturnNextData::TIMEOUT:
+                break;
+            case elapi::ELApi::ReturnNextData::CONNECTION_CLOSED:
+                std::this_thread::sleep_for( READER_DISCONNECTED_WAIT );
+                break;
+        }
+    }
+}
+
+void
+LSLClient::startWatcher( )
+{
+    m_watcherRun = true;
+    m_watcher    = std::thread( &LSLClient::runWatcher, this );
+}
+
+void
+LSLClient::stopWatcher( )
+{
+    if ( !m_watcher.joinable( ) ) {
+        return;
+    }
+    {
+        std::unique_lock< std::mutex > lock( m_watcherMutex );
+        m_watcherRun = false;
+    }
+    m_watcherWakeup.notify_all( );
+    m_watcher.join( );
+}
+
+void
+LSLClient::runWatcher( )
+{
+    const GazeOutlet* watched      = nullptr;
+    const GazeOutlet* missingRate  = nullptr;
+    auto              lastConsumer = std::chrono::steady_clock::now( );
+
+    std::unique_lock< std::mutex > watcherLock( m_watcherMutex );
+    while ( m_watcherRun ) {
+        m_watcherWakeup.wait_for( watcherLock, CONSUMER_POLL_INTERVAL,
+                                  [ this ] { return !m_watcherRun; } );
+        if ( !m_watcherRun ) {
+            break;
+        }
 
+        std::unique_lock< std::mutex > lock( m_resourceMutex );
+        m_haveConsumers.store( m_outlet && m_outlet->haveConsumers( ), std::memory_order_relaxed );
+        // consumers of the streams derived from the gaze samples keep the tracking going as well
+        bool consumers = m_haveConsumers.load( std::memory_order_relaxed );
+        for ( const auto& decimated : m_decimated ) {
+            consumers = consumers || decimated->haveConsumers( );
+        }
+        consumers = consumers || ( m_events && m_events->haveConsumers( ) );
+
+        const auto now = std::chrono::steady_clock::now( );
+        if ( consumers || m_outlet.get( ) != watched ) {
+            lastConsumer = now;
+            watched      = m_outlet.get( );
+        }
+        if ( !m_outlet || !m_api ) {
+            continue;
+        }
+
+        if ( consumers && m_idle ) {
+            // the device may have changed meanwhile and lack the rate of the outlet
+            const auto mode = m_hz2Mode.find( m_outlet->samplerate( ) );
+            if ( mode == m_hz2Mode.end( ) ) {
+                if ( missingRate != m_outlet.get( ) ) {
+                    missingRate = m_outlet.get( );
+                    Log::warning( "device does not support " +
+                                  std::to_string( m_outlet->samplerate( ) ) +
+                                  " hz - tracking stays paused, restart the stream" );
+                }
+                continue;
+            }
+            const auto retTracking = m_api->requestTracking( mode->second );
+            if ( retTracking == elapi::ELApi::ReturnStart::SUCCESS ) {
+                m_idle = false;
+                Log::info( "LSL consumer connected - tracking resumed" );
+            }
+        } else if ( !consumers && !m_idle && !recording( ) && m_idleGrace.count( ) > 0 &&
+                    now - lastConsumer >= m_idleGrace ) {
+            m_api->unrequestTracking( );
+            m_idle = true;
+            Log::info( "no LSL consumer for " + std::to_string( m_idleGrace.count( ) ) +
+                       " ms - tracking paused" );
+        }
+    }
+}
+
+void
+LSLClient::startReconnector( )
+{
+    m_reconnectRun = true;
+    m_reconnector  = std::thread( &LSLClient::runReconnector, this );
+}
+
+void
+LSLClient::stopReconnector( )
+{
+    if ( !m_reconnector.joinable( ) ) {
+        return;
+    }
+    {
+        std::unique_lock< std::mutex > lock( m_reconnectMutex );
+        m_reconnectRun = false;
+    }
+    m_reconnectWakeup.notify_all( );
+    m_reconnector.join( );
+}
+
+void
+LSLClient::requestRestore( )
+{
+    {
+        std::unique_lock< std::mutex > lock( m_reconnectMutex );
+        m_restorePending = true;
+    }
+    m_reconnectWakeup.notify_all( );
+}
+
+void
+LSLClient::runReconnector( )
+{
+    std::unique_lock< std::mutex > reconnectLock( m_reconnectMutex );
+    while ( m_reconnectRun ) {
+        m_reconnectWakeup.wait( reconnectLock,
+                                [ this ] { return m_restorePending || !m_reconnectRun; } );
+
+        // exponential backoff, every loss starts over with the initial delay
+        auto backoff = m_reconnectInitial;
+        while ( m_reconnectRun && m_restorePending && backoff.count( ) > 0 ) {
+            m_restorePending = false;
+            reconnectLock.unlock( );
+            const bool restored = restoreSession( );
+            reconnectLock.lock( );
+            if ( restored ) {
+                break;
+            }
+            Log::warning( "cannot restore the session - retrying in " +
+                          std::to_string( backoff.count( ) ) + " ms" );
+            m_restorePending = true;
+            m_reconnectWakeup.wait_for( reconnectLock, backoff,
+                                        [ this ] { return !m_reconnectRun; } );
+            backoff = std::min( backoff * 2, m_reconnectMaximum );
+        }
+        m_restorePending = false;
+    }
+}
+
+bool
+LSLClient::restoreSession( )
+{
+    std::unique_ptr< elapi::ELApi::ServerInfo > server;
+    bool                                        connected;
+    {
+        std::unique_lock< std::mutex > lock( m_resourceMutex );
+        if ( !m_api ) {
+            return true;
+        }
+        connected = m_api->isConnected( );
+        if ( m_server ) {
+            server = std::make_unique< elapi::ELApi::ServerInfo >( *m_server );
+        }
+    }
+
+    if ( !connected ) {
+        if ( connect( server.get( ) ) != elapi::ELApi::ReturnConnect::SUCCESS ) {
+            return false;
+        }
+        Log::info( "reconnected to the server" );
+    }
+
+    // while idle the watcher requests tracking once a consumer connects
+    int32 samplerate;
+    {
+        std::unique_lock< std::mutex > lock( m_resourceMutex );
+        samplerate = m_idle ? 0 : m_trackingRate;
+    }
+    if ( samplerate > 0 ) {
+        if ( requestTracking( samplerate ) != elapi::ELApi::ReturnStart::SUCCESS ) {
+            return false;
+        }
+        Log::info( "tracking resumed at " + std::to_string( samplerate ) + " Hz" );
+    }
+    return true;
+}
+
+void
+LSLClient::startPublisher( )
+{
+    m_publisherRun = true;
+    m_publisher    = std::thread( &LSLClient::runPublisher, this );
+}
+
+void
+LSLClient::stopPublisher( )
+{
+    if ( !m_publisher.joinable( ) ) {
+        return;
+    }
+    {
+        std::unique_lock< std::mutex > lock( m_publisherMutex );
+        m_publisherRun = false;
+    }
+    m_publisherWakeup.notify_all( );
+    m_publisher.join( );
+}
+
+void
+LSLClient::runPublisher( )
+{
+    QueuedSample queued;
+    while ( m_publisherRun ) {
+        if ( m_sampleRing.empty( ) ) {
+            bool chunkPending = false;
+            {
+                // a partially filled chunk is sent once its time limit has passed
+                std::unique_lock< std::mutex > lock( m_resourceMutex );
+                if ( m_outlet && m_outlet->chunkExpired( ) ) {
+                    m_outlet->flush( );
+                }
+                chunkPending = m_outlet && m_outlet->chunkPending( );
+#ifdef ELLSL_ENABLE_DIAGNOSTICS
+                if ( m_diagnostics ) {
+                    m_diagnostics->publishIfDue( m_sampleRing.statistics( ).overflows,
+                                                 m_clockMapping.fit( ),
+                                                 m_continuity.statistics( ) );
+                }
+#endif
+            }
+            std::unique_lock< std::mutex > lock( m_publisherMutex );
+            m_publisherIdle.store( true, std::memory_order_relaxed );
+            std::atomic_thread_fence( std::memory_order_seq_cst );
+            if ( m_sampleRing.empty( ) && m_publisherRun ) {
+                m_publisherWakeup.wait_for( lock, chunkPending ? PUBLISHER_CHUNK_TIMEOUT
+                                                               : PUBLISHER_IDLE_TIMEOUT );
+            }
+            m_publisherIdle.store( false, std::memory_order_relaxed );
+            continue;
+        }
+
+        // drain at most one ring's worth per lock so console commands are not starved
+        std::unique_lock< std::mutex > lock( m_resourceMutex );
+        for ( size_t i = 0; i < m_sampleRing.capacity( ) && m_sampleRing.pop( queued ); i++ ) {
+            publishSample( queued );
+        }
+        if ( m_outlet && m_outlet->chunkExpired( ) ) {
+            m_outlet->flush( );
+        }
+#ifdef ELLSL_ENABLE_DIAGNOSTICS
+        if ( m_diagnostics ) {
+            m_diagnostics->publishIfDue( m_sampleRing.statistics( ).overflows,
+                                         m_clockMapping.fit( ), m_continuity.statistics( ) );
+        }
+#endif
+    }
+}
+
+void
+LSLClient::publishSample( const QueuedSample& queued )
+{
+    const elapi::ELGazeSample& gazeSample = queued.gazeSample;
     if ( !m_outlet ) {
         return;
     }
-    if ( !m_outlet->have_consumers( ) ) {
+
+    IndexContinuity::Gap gap;
+    const auto           verdict = m_continuity.check( gazeSample, gap );
+    if ( verdict == IndexContinuity::Verdict::DUPLICATE ) {
         return;
     }
+    if ( verdict == IndexContinuity::Verdict::GAP ) {
+        postMarker( m_clockMapping.map( gap.beginMicroSec ),
+                    "SAMPLE_GAP first=" + std::to_string( gap.firstIndex ) +
+                        " missing=" + std::to_string( gap.count ) );
+    } else if ( verdict == IndexContinuity::Verdict::RESTART ) {
+        postMarker( queued.callbackClock,
+                    "INDEX_RESTART index=" + std::to_string( gazeSample.index ) );
+    }
+
+    // the fit follows the device clock even while nobody consumes the stream - the journal and
+    // the XDF recording keep everything regardless of consumers
+    const double timestamp =
+        m_clockMapping.update( gazeSample.timestampMicroSec, queued.callbackClock );
+    if ( !m_decimated.empty( ) ) {
+        decimateSample( gazeSample, timestamp, verdict, gap );
+    }
+    if ( m_detector ) {
+        EventDetector::Event events[ EventDetector::MAX_EVENTS ];
+        const int32          count = m_detector->process( gazeSample, timestamp, events );
+        for ( int32 i = 0; i < count; i++ ) {
+            m_events->post( events[ i ].timestamp, toString( events[ i ] ) );
+        }
+    }
+    if ( !m_haveConsumers.load( std::memory_order_relaxed ) && !recording( ) ) {
+        return;
+    }
+
+    // keep the stream on a regular grid, longer outages are left as they are
+    if ( verdict == IndexContinuity::Verdict::GAP && m_fillGaps &&
+         gap.count <= m_outlet->samplerate( ) ) {
+        for ( int64 i = 0; i < gap.count; i++ ) {
+            const auto placeholder = IndexContinuity::placeholder( gap, i );
+#ifdef ELLSL_ENABLE_DIAGNOSTICS
+            m_outlet->stampCallback( 0 );
+#endif
+            m_outlet->push( placeholder, m_clockMapping.map( placeholder.timestampMicroSec ) );
+        }
+        m_continuity.countFilled( gap.count );
+    }
+
+    // convert and push into LSL once the chunk is full - immediately in per-sample mode
+#ifdef ELLSL_ENABLE_DIAGNOSTICS
+    m_outlet->stampCallback( queued.callbackMicroSec );
+#endif
+    m_outlet->push( gazeSample, timestamp );
+}
+
+void
+LSLClient::decimateSample( const elapi::ELGazeSample& gazeSample, double timestamp,
+                           IndexContinuity::Verdict verdict, const IndexContinuity::Gap& gap )
+{
+    // the decimators expect every index - short gaps are filled with invalid samples regardless
+    // of gap filling, after longer outages and restarts the filters start over
+    const bool restart = verdict == IndexContinuity::Verdict::RESTART ||
+                         ( verdict == IndexContinuity::Verdict::GAP &&
+                           gap.count > m_outlet->samplerate( ) );
+    for ( auto& decimated : m_decimated ) {
+        if ( restart ) {
+            decimated->reset( );
+        } else if ( verdict == IndexContinuity::Verdict::GAP ) {
+            for ( int64 i = 0; i < gap.count; i++ ) {
+                const auto placeholder = IndexContinuity::placeholder( gap, i );
+                decimated->push( placeholder, m_clockMapping.map( placeholder.timestampMicroSec ) );
+            }
+        }
+        decimated->push( gazeSample, timestamp );
+    }
+}
+
+bool
+LSLClient::recording( ) const
+{
+    return m_journal || m_xdf;
+}
 
-    double sample[ NCHANNELS ];
-
-    sample[ 0 ] =
-        ( gazeSample.index == elapi::ELInvalidValue ? std::numeric_limits< double >::quiet_NaN( )
-                                                    : gazeSample.index );
-    // raw, averaged por
-    sample[ 1 ] =
-        ( gazeSample.porRawX == elapi::ELInvalidValue ? std::numeric_limits< double >::quiet_NaN( )
-                                                      : gazeSample.porRawX );
-    sample[ 2 ] =
-        ( gazeSample.porRawY == elapi::ELInvalidValue ? std::numeric_limits< double >::quiet_NaN( )
-                                                      : gazeSample.porRawY );
-    // filtered, averaged por
-    sample[ 3 ] = ( gazeSample.porFilteredX == elapi::ELInvalidValue
-                        ? std::numeric_limits< double >::quiet_NaN( )
-                        : gazeSample.porFilteredX );
-    sample[ 4 ] = ( gazeSample.porFilteredY == elapi::ELInvalidValue
-                        ? std::numeric_limits< double >::quiet_NaN( )
-                        : gazeSample.porFilteredY );
-    // eye por
-    sample[ 5 ] =
-        ( gazeSample.porLeftY == elapi::ELInvalidValue ? std::numeric_limits< double >::quiet_NaN( )
-                                                       : gazeSample.porLeftX );
-    sample[ 6 ] =
-        ( gazeSample.porLeftY == elapi::ELInvalidValue ? std::numeric_limits< double >::quiet_NaN( )
-                                                       : gazeSample.porLeftY );
-    sample[ 7 ] = ( gazeSample.porRightX == elapi::ELInvalidValue
-                        ? std::numeric_limits< double >::quiet_NaN( )
-                        : gazeSample.porRightX );
-    sample[ 8 ] = ( gazeSample.porRightY == elapi::ELInvalidValue
-                        ? std::numeric_limits< double >::quiet_NaN( )
-                        : gazeSample.porRightY );
-    // pupil diameter
-    sample[ 9 ]  = ( gazeSample.pupilRadiusLeft == elapi::ELInvalidValue
-                         ? std::numeric_limits< double >::quiet_NaN( )
-                         : gazeSample.pupilRadiusLeft );
-    sample[ 10 ] = ( gazeSample.pupilRadiusRight == elapi::ELInvalidValue
-                         ? std::numeric_limits< double >::quiet_NaN( )
-                         : gazeSample.pupilRadiusRight );
-    // eye world-position
-    sample[ 11 ] = ( gazeSample.eyePositionLeftX == elapi::ELInvalidValue
-                         ? std::numeric_limits< double >::quiet_NaN( )
-                         : gazeSample.eyePositionLeftX );
-    sample[ 12 ] = ( gazeSample.eyePositionLeftY == elapi::ELInvalidValue
-                         ? std::numeric_limits< double >::quiet_NaN( )
-                         : gazeSample.eyePositionLeftY );
-    sample[ 13 ] = ( gazeSample.eyePositionLeftZ == elapi::ELInvalidValue
-                         ? std::numeric_limits< double >::quiet_NaN( )
-                         : gazeSample.eyePositionLeftZ );
-    sample[ 14 ] = ( gazeSample.eyePositionRightX == elapi::ELInvalidValue
-                         ? std::numeric_limits< double >::quiet_NaN( )
-                         : gazeSample.eyePositionRightX );
-    sample[ 15 ] = ( gazeSample.eyePositionRightY == elapi::ELInvalidValue
-                         ? std::numeric_limits< double >::quiet_NaN( )
-                         : gazeSample.eyePositionRightY );
-    sample[ 16 ] = ( gazeSample.eyePositionRightZ == elapi::ELInvalidValue
-                         ? std::numeric_limits< double >::quiet_NaN( )
-                         : gazeSample.eyePositionRightZ );
-
-    // calc sample age
-    auto   timestamp        = gazeSample.timestampMicroSec;
-    double timestampSeconds = timestamp / 1000000.0;  // lsl expects time in seconds
-
-    // push into LSL
-    m_outlet->push_sample( sample, timestampSeconds );
+std::string
+LSLClient::streamSuffix( ) const
+{
+    if ( !m_deviceStreamNames || !m_deviceConfig ) {
+        return "";
+    }
+    return "_" + std::to_string( m_deviceConfig->deviceSerial );
+}
+
+void
+LSLClient::postMarker( double timestamp, std::string text )
+{
+    if ( m_markers ) {
+        m_markers->post( timestamp, std::move( text ) );
+    }
+}
+
+bool
+LSLClient::markerStatistics( MarkerOutlet::Statistics& statistics ) const
+{
+    std::unique_lock< std::mutex > lock( m_resourceMutex );
+    if ( !m_markers ) {
+        return false;
+    }
+    statistics = m_markers->statistics( );
+    return true;
 }
 
 std::unique_lock< std::mutex >
@@ -446,19 +1273,25 @@ LSLClient::updateDevice( std::unique_lock< std::mutex >&& lock )
         m_screenConfig = std::make_unique< elapi::ELApi::ScreenConfig >( );
     }
     if ( !m_deviceConfig ) {
-        m_deviceConfig = std::make_unique< elapi::ELApi::DeviceConfig >( );
+        m_deviceConfig = std::make_unique< DeviceInfo >( );
     }
 
     m_api->getActiveScreen( *m_screenConfig );
-    m_api->getDeviceConfig( *m_deviceConfig );
+    m_api->getDeviceInfo( *m_deviceConfig );
+    if ( m_detector ) {
+        m_detector->setScreen( *m_screenConfig );
+    }
+    if ( m_outlet ) {
+        m_outlet->setScreen( *m_screenConfig );
+    }
 
     m_hz2Mode.clear( );
-    for ( int32 i = 0; i < m_deviceConfig->numFrameRates; i++ ) {
+    for ( int32 i = 0; i < static_cast< int32 >( m_deviceConfig->frameRates.size( ) ); i++ ) {
         m_hz2Mode[ m_deviceConfig->frameRates[ i ] ] = i;
     }
 
     m_pt2Mode.clear( );
-    for ( int32 i = 0; i < m_deviceConfig->numCalibrationMethods; i++ ) {
+    for ( int32 i = 0; i < static_cast< int32 >( m_deviceConfig->calibrationMethods.size( ) ); i++ ) {
         m_pt2Mode[ m_deviceConfig->calibrationMethods[ i ] ] = i;
     }
     return std::move( lock );
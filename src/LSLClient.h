@@ -29,56 +29,365 @@ using uint64 = uint64_t;
 
 #include "elapi/ELApi.h"
 #include "lsl_cpp.h"
+#include "ClockMapping.h"
+#include "DecimatedOutlet.h"
+#include "Diagnostics.h"
+#include "EventDetector.h"
+#include "GazeOutlet.h"
+#include "GazeSource.h"
+#include "IndexContinuity.h"
+#include "MarkerOutlet.h"
+#include "RecordingJournal.h"
+#include "SampleRing.h"
+#include "ThreadConfig.h"
+#include "ValidationOutlet.h"
+#include "XdfWriter.h"
 
 #include <map>
 #include <tuple>
+#include <chrono>
 #include <mutex>
+#include <atomic>
+#include <thread>
 #include <condition_variable>
+#include <functional>
+#include <vector>
 
 namespace ellsl
 {
 class LSLClient : public elapi::ELApi::ELEventCallback, public elapi::ELApi::ELGazeSampleCallback
 {
 public:
-    LSLClient( );
+    /** @brief element of the ring handing samples over to the publisher thread */
+    struct QueuedSample {
+        elapi::ELGazeSample gazeSample;
+        /** @brief lsl::local_clock( ) at entry of the gaze sample callback */
+        double callbackClock;
+#ifdef ELLSL_ENABLE_DIAGNOSTICS
+        /** @brief entry of the gaze sample callback, see Diagnostics::clock( ) */
+        int64 callbackMicroSec;
+#endif
+    };
+
+    enum class Acquisition {
+        /** @brief samples are delivered on the ELApi callback thread */
+        LISTENER,
+        /** @brief a reader thread of the client polls ELApi::getNextGazeSample */
+        POLLING,
+    };
+
+    /** @param source gaze source to acquire from, the default source if nullptr */
+    explicit LSLClient( std::shared_ptr< GazeSource > source = nullptr );
     virtual ~LSLClient( );
 
     bool isConnected( ) const;
     bool isStreaming( ) const;
     bool hasConsumers( ) const;
 
+    SampleRing< QueuedSample >::Statistics ringStatistics( ) const;
+    /** @brief index continuity of the current stream */
+    IndexContinuity::Statistics continuityStatistics( ) const;
+
+    /** @brief inserts NaN placeholder samples for missing indices of up to one second */
+    void setGapFilling( bool enabled );
+    bool gapFilling( ) const;
+
+    /** @brief largest chunk size, about 2 s at the highest frame rate */
+    static constexpr int32 MAX_CHUNK_SAMPLES = 4096;
+
+    /**
+     * @brief push samples in chunks of up to 'samples' samples, or of whatever arrived within
+     * 'microseconds' after the first sample of the chunk (0: no time limit). A chunk size of 1
+     * pushes every sample immediately.
+     * @return false if 'samples' is not within 1..MAX_CHUNK_SAMPLES or 'microseconds' is negative
+     */
+    bool setChunking( int32 samples, int64 microseconds );
+    std::tuple< int32, int64 > chunking( ) const;
+
+    /** @brief layout of the gaze outlet, applied when the stream is (re-)started */
+    void          setStreamProfile( const StreamProfile& profile );
+    StreamProfile streamProfile( ) const;
+
+    /** @brief smoothing filters appended to the gaze outlet, applied on stream (re-)start */
+    void         setGazeFilter( const FilterConfig& filter );
+    FilterConfig gazeFilter( ) const;
+
+    /**
+     * @brief appends the gaze angles of both eyes and the pixels per degree to the gaze outlet,
+     * applied on stream (re-)start - 'geometry' is the mounting and size of the tracker
+     */
+    void setVisualAngles( bool enabled, const TrackerGeometry& geometry = { } );
+    bool visualAngles( ) const;
+
+    /**
+     * @brief opens a decimated secondary outlet "<gaze stream>_<rate>Hz" for each rate, applied on
+     * stream (re-)start - rates that do not divide the tracking rate are skipped
+     */
+    void                 setDecimatedRates( const std::vector< int32 >& rates );
+    std::vector< int32 > decimatedRates( ) const;
+
+    /**
+     * @brief stops tracking once the gaze, decimated and eye movement event streams had no
+     * consumers for 'grace' and requests it again as soon as a consumer connects (0: keep
+     * tracking) - markers and validation results alone do not need the tracking
+     */
+    void                      setIdleGrace( std::chrono::milliseconds grace );
+    std::chrono::milliseconds idleGrace( ) const;
+    /** @brief whether tracking is paused for lack of consumers */
+    bool isIdle( ) const;
+
+    /**
+     * @brief reconnects once the server closed the connection, first after 'initial' and then
+     * twice as long after every failed attempt up to 'maximum' (0: no reconnects). Tracking
+     * resumes at the previous rate after reconnects and after the device reconnected, the gaze
+     * outlet is kept unless its layout changed.
+     */
+    void setReconnect( std::chrono::milliseconds initial, std::chrono::milliseconds maximum );
+
+    /**
+     * @brief records all pushed samples and device events to memory-mapped segment files in
+     * 'directory' - an empty directory stops recording. Idle mode is suspended while recording.
+     * @return false if the journal cannot be opened
+     */
+    bool setJournal( const std::string& directory,
+                     uint64             segmentBytes = RecordingJournal::DEFAULT_SEGMENT_BYTES );
+    /** @return false if no journal is recording */
+    bool journalStatistics( RecordingJournal::Statistics& statistics ) const;
+
+    /**
+     * @brief records all pushed samples to an XDF file at 'path', which is overwritten - an empty
+     * path ends the recording. Idle mode is suspended while recording.
+     * @return false if the file cannot be created
+     */
+    bool setXdfRecording( const std::string& path );
+    /** @return false if no XDF file is being recorded */
+    bool xdfStatistics( XdfWriter::Statistics& statistics ) const;
+
+    /**
+     * @brief detects fixations, saccades and blinks and publishes their onsets and offsets on the
+     * event stream - applied when the stream is (re-)started
+     */
+    void setEventDetection( bool enabled, const EventDetector::Config& config = { } );
+    /** @return false if there is no event outlet, it is opened with the stream */
+    bool eventStatistics( MarkerOutlet::Statistics& statistics ) const;
+
+    /** @return false if there is no marker outlet, it is opened on the first connect */
+    bool markerStatistics( MarkerOutlet::Statistics& statistics ) const;
+
+    /** @brief selects how samples are acquired, applied on the next connectELApi( ) */
+    void setAcquisition( Acquisition acquisition, const ThreadConfig& readerConfig = { } );
+
+    /**
+     * @brief appends the device serial to the stream names ("EyeLogic_<serial>"), which keeps
+     * the streams of several trackers apart - applied when the stream is (re-)started
+     */
+    void setDeviceStreamNames( bool enabled );
+    /** @brief serial of the connected device, 0 if never connected */
+    uint64 deviceSerial( ) const;
+
     elapi::ELApi::ReturnConnect connectELApi( );
+    /** @brief connects to the server of a remote device, see GazeSource::requestServerList */
+    elapi::ELApi::ReturnConnect connectRemote( const elapi::ELApi::ServerInfo& server );
     void                        closeStream( );
 
-    elapi::ELApi::ReturnStart     requestTracking( int32 samplerate );
-    elapi::ELApi::ReturnCalibrate requestCalibration( int32 calibration );
+    /** @brief called on the calibration task thread once it has finished */
+    using CalibrationFinished = std::function< void( elapi::ELApi::ReturnCalibrate ) >;
+    using ValidationFinished  = std::function< void( elapi::ELApi::ReturnValidate,
+                                                    const elapi::ELApi::ELValidationResult& ) >;
+
+    elapi::ELApi::ReturnStart requestTracking( int32 samplerate );
+
+    /**
+     * @brief starts a calibration on a task thread, samples keep streaming meanwhile
+     * @return SUCCESS once the calibration has started
+     */
+    elapi::ELApi::ReturnCalibrate requestCalibration( int32               calibration,
+                                                      CalibrationFinished finished = nullptr );
+    /**
+     * @brief starts a validation on a task thread, the result of every validation point is
+     * published on the validation stream
+     * @return SUCCESS once the validation has started
+     */
+    elapi::ELApi::ReturnValidate requestValidation( ValidationFinished finished = nullptr );
+    /** @brief aborts a running calibration or validation, its finished callback is still called */
+    void abortCalibration( );
+    bool isCalibrating( ) const;
 
     std::string listFramerates( );
     std::string listCalibrations( );
+    /** @brief frame rates [hz] and calibration modes of the connected device, ascending */
+    std::vector< int32 > framerates( ) const;
+    std::vector< int32 > calibrations( ) const;
 
 private:
-    void                           disconnectELApi( );
-    std::unique_lock< std::mutex > openStream( int32                            samplerate,
-                                               std::unique_lock< std::mutex >&& lock = { } );
-    void                           shutdown( );
+    elapi::ELApi::ReturnConnect connect( const elapi::ELApi::ServerInfo* server );
+    void                        disconnectELApi( );
+    void                        shutdown( );
 
     void STDCALL onEvent( elapi::ELApi::Event event ) override;
     void STDCALL onGazeSample( const elapi::ELGazeSample& gazeSample ) override;
 
     void stopTracking( );
+    // requires m_resourceMutex to be held
+    bool recording( ) const;
+    // requires m_resourceMutex to be held - "_<serial>" if device stream names are enabled
+    std::string streamSuffix( ) const;
+    // requires m_resourceMutex to be held
+    void postMarker( double timestamp, std::string text );
+
+    void enqueueSample( const elapi::ELGazeSample& gazeSample );
+
+    // require m_resourceMutex to be held, the reader itself never takes it
+    void startReader( );
+    void stopReader( );
+    void runReader( std::shared_ptr< GazeSource > source, ThreadConfig config );
+
+    void startWatcher( );
+    void stopWatcher( );
+    void runWatcher( );
+
+    void startReconnector( );
+    void stopReconnector( );
+    void runReconnector( );
+    // wakes the reconnector after a connection loss or a device reconnect
+    void requestRestore( );
+    // reconnects if the connection is lost and resumes tracking, false if it has to be retried
+    bool restoreSession( );
+
+    // joins a finished calibration task, false while one is running
+    bool claimCalibrationTask( );
+    void stopCalibrationTask( );
+    void runCalibration( std::shared_ptr< GazeSource > source, int32 mode,
+                         CalibrationFinished finished );
+    void runValidation( std::shared_ptr< GazeSource > source, ValidationFinished finished );
+
+    void startPublisher( );
+    void stopPublisher( );
+    void runPublisher( );
+    // requires m_resourceMutex to be held
+    void publishSample( const QueuedSample& queued );
+    // requires m_resourceMutex to be held - feeds the decimated outlets
+    void decimateSample( const elapi::ELGazeSample& gazeSample, double timestamp,
+                         IndexContinuity::Verdict verdict, const IndexContinuity::Gap& gap );
 
     std::tuple< std::string, std::unique_lock< std::mutex > > listReadable(
         std::map< int32, int32 >& map, std::unique_lock< std::mutex >&& lock );
     std::unique_lock< std::mutex > updateDevice( std::unique_lock< std::mutex >&& );
 
+    using DecimatedOutlets = std::vector< std::unique_ptr< DecimatedOutlet > >;
+
+    // everything the outlets of a stream are built from
+    struct StreamSettings {
+        int32                      samplerate;
+        StreamProfile              profile;
+        DerivedChannels            derived;
+        uint64                     deviceSerial;
+        std::string                suffix;
+        ClockMapping               clockMapping;
+        int32                      chunkSamples;
+        std::chrono::microseconds  chunkDuration;
+        std::vector< int32 >       decimatedRates;
+        bool                       detectEvents;
+        EventDetector::Config      detectorConfig;
+        bool                       haveScreen;
+        elapi::ELApi::ScreenConfig screen;
+        uint64                     overflows;
+    };
+
+    // outlets of a stream, swapped in and out as a whole
+    struct StreamOutlets {
+        std::unique_ptr< GazeOutlet >    gaze;
+        DecimatedOutlets                 decimated;
+        std::unique_ptr< EventDetector > detector;
+        std::unique_ptr< MarkerOutlet >  events;
+#ifdef ELLSL_ENABLE_DIAGNOSTICS
+        std::unique_ptr< Diagnostics > diagnostics;
+#endif
+    };
+
+    // requires m_resourceMutex to be held
+    StreamSettings       streamSettings( int32 samplerate ) const;
+    // creates the outlets, takes no lock and may take a while
+    static StreamOutlets buildStream( const StreamSettings& settings );
+    // requires m_resourceMutex to be held - replaces the current outlets, which are handed back
+    // in 'outlets', samples acquired before 'switchClock' are still published by them
+    void installStream( StreamOutlets& outlets, double switchClock );
+
     // mutex secures all access to the resources below
     mutable std::mutex                            m_resourceMutex;
     std::unique_ptr< elapi::ELApi::ScreenConfig > m_screenConfig;
-    std::unique_ptr< elapi::ELApi::DeviceConfig > m_deviceConfig;
+    std::unique_ptr< DeviceInfo >                 m_deviceConfig;
     std::map< int32, int32 >                      m_hz2Mode;
     std::map< int32, int32 >                      m_pt2Mode;
-    std::shared_ptr< elapi::ELApi >               m_api;
-    std::unique_ptr< lsl::stream_outlet >         m_outlet;
+    std::shared_ptr< GazeSource >                 m_api;
+    // declared before the outlet, which flushes into them on destruction
+    std::unique_ptr< RecordingJournal >           m_journal;
+    std::unique_ptr< XdfWriter >                  m_xdf;
+    std::unique_ptr< GazeOutlet >                 m_outlet;
+    std::unique_ptr< MarkerOutlet >               m_markers;
+    std::unique_ptr< ValidationOutlet >           m_validation;
+    std::unique_ptr< EventDetector >              m_detector;
+    std::unique_ptr< MarkerOutlet >               m_events;
+    DecimatedOutlets                              m_decimated;
+    ClockMapping                                  m_clockMapping;
+    IndexContinuity                               m_continuity;
+    bool                                          m_fillGaps = false;
+#ifdef ELLSL_ENABLE_DIAGNOSTICS
+    std::unique_ptr< Diagnostics > m_diagnostics;
+#endif
+    StreamProfile                                 m_streamProfile;
+    FilterConfig                                  m_filterConfig;
+    bool                                          m_visualAngles = false;
+    TrackerGeometry                               m_trackerGeometry;
+    std::vector< int32 >                          m_decimatedRates;
+    // rate tracking was last requested at, 0 once the stream is closed
+    int32                                         m_trackingRate = 0;
+    // server of the last connect, nullptr for the local server
+    std::unique_ptr< elapi::ELApi::ServerInfo >   m_server;
+    bool                                          m_deviceStreamNames = false;
+    bool                                          m_detectEvents      = false;
+    EventDetector::Config                         m_detectorConfig;
+    int32                                         m_chunkSamples = 1;
+    std::chrono::microseconds                     m_chunkDuration{ 0 };
+    Acquisition                                   m_acquisition = Acquisition::LISTENER;
+    ThreadConfig                                  m_readerConfig;
+
+    // consumer watcher, caches the consumer state of the outlet and pauses tracking while there is
+    // none
+    std::chrono::milliseconds m_idleGrace{ 0 };
+    bool                      m_idle = false;
+    std::atomic< bool >       m_haveConsumers{ false };
+    std::atomic< bool >       m_watcherRun{ false };
+    std::mutex                m_watcherMutex;
+    std::condition_variable   m_watcherWakeup;
+    std::thread               m_watcher;
+
+    // reconnector, restores the session after connection losses and device reconnects
+    std::chrono::milliseconds m_reconnectInitial{ 500 };
+    std::chrono::milliseconds m_reconnectMaximum{ 30000 };
+    bool                      m_restorePending = false;
+    std::atomic< bool >       m_reconnectRun{ false };
+    std::mutex                m_reconnectMutex;
+    std::condition_variable   m_reconnectWakeup;
+    std::thread               m_reconnector;
+
+    // calibration or validation task, the ELApi calls block until they are finished
+    std::atomic< bool > m_calibrating{ false };
+    std::thread         m_calibrationTask;
+
+    // polling reader, only running in Acquisition::POLLING - started and stopped under
+    // m_resourceMutex
+    std::atomic< bool > m_readerRun{ false };
+    std::thread         m_reader;
+
+    // lock-free hand-over of samples from the acquiring thread to the publisher thread
+    SampleRing< QueuedSample > m_sampleRing;
+    std::atomic< bool >        m_outletOpen{ false };
+    std::atomic< bool >        m_publisherIdle{ false };
+    std::atomic< bool >        m_publisherRun{ false };
+    std::mutex                 m_publisherMutex;
+    std::condition_variable    m_publisherWakeup;
+    std::thread                m_publisher;
 };
 
 }  // namespace ellsl
\ No newline at end of file
@@ -0,0 +1,140 @@
+// -----------------------------------------------------------------------
+// Copyright (C) 2019-2023, EyeLogic GmbH
+//
+// Permission is hereby granted, free of charge, to any person or
+// organization obtaining a copy of the software and accompanying
+// documentation covered by this license (the "Software") to use,
+// reproduce, display, distribute, execute, and transmit the Software,
+// and to prepare derivative works of the Software, and to permit
+// third-parties to whom the Software is furnished to do so.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, TITLE AND
+// NON-INFRINGEMENT. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR ANYONE
+// DISTRIBUTING THE SOFTWARE BE LIABLE FOR ANY DAMAGES OR OTHER
+// LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+// OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+// -----------------------------------------------------------------------
+
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace ellsl
+{
+/**
+ * @brief lock-free log-linear histogram of non-negative integer values, e.g. latencies in [us]
+ *
+ * Values below 2 * SUB_BUCKETS are counted exactly, larger values in buckets with a relative
+ * width of at most 1 / SUB_BUCKETS (HDR histogram layout). record( ) never allocates, locks or
+ * blocks and may run concurrently with snapshot( ) on another thread.
+ */
+class LatencyHistogram
+{
+public:
+    static constexpr int32_t SUB_BITS    = 5;
+    static constexpr int32_t SUB_BUCKETS = 1 << SUB_BITS;
+    // values up to 2^32 - 1 are resolved, larger ones are counted in the last bucket
+    static constexpr int32_t VALUE_BITS = 32;
+    static constexpr size_t  BUCKETS    = ( VALUE_BITS - SUB_BITS + 1 ) * SUB_BUCKETS;
+
+    /** @brief counts of a histogram at one point in time */
+    struct Snapshot {
+        std::array< uint64_t, BUCKETS > counts{ };
+        uint64_t                        count = 0;
+        uint64_t                        max   = 0;
+
+        /** @brief upper bound of the bucket containing the given quantile, 0 if empty */
+        uint64_t percentile( double quantile ) const
+        {
+            if ( count == 0 ) {
+                return 0;
+            }
+            const uint64_t rank   = static_cast< uint64_t >( quantile * ( count - 1 ) ) + 1;
+            uint64_t       summed = 0;
+            for ( size_t i = 0; i < BUCKETS; i++ ) {
+                summed += counts[ i ];
+                if ( summed >= rank ) {
+                    return std::min( upperBound( i ), max );
+                }
+            }
+            return max;
+        }
+    };
+
+    LatencyHistogram( ) = default;
+
+    LatencyHistogram( const LatencyHistogram& ) = delete;
+    LatencyHistogram& operator=( const LatencyHistogram& ) = delete;
+
+    /** @brief counts a value, negative values are counted as 0 */
+    void record( int64_t value )
+    {
+        const uint64_t clamped = value < 0 ? 0 : static_cast< uint64_t >( value );
+        m_counts[ bucket( clamped ) ].fetch_add( 1, std::memory_order_relaxed );
+        uint64_t max = m_max.load( std::memory_order_relaxed );
+        while ( clamped > max &&
+                !m_max.compare_exchange_weak( max, clamped, std::memory_order_relaxed ) ) {
+        }
+    }
+
+    /**
+     * @brief copies all counts, optionally resetting them - a value recorded concurrently ends up
+     * in either this or the next snapshot
+     */
+    Snapshot snapshot( bool reset )
+    {
+        Snapshot result;
+        for ( size_t i = 0; i < BUCKETS; i++ ) {
+            result.counts[ i ] = reset ? m_counts[ i ].exchange( 0, std::memory_order_relaxed )
+                                       : m_counts[ i ].load( std::memory_order_relaxed );
+            result.count += result.counts[ i ];
+        }
+        result.max = reset ? m_max.exchange( 0, std::memory_order_relaxed )
+                           : m_max.load( std::memory_order_relaxed );
+        return result;
+    }
+
+    static size_t bucket( uint64_t value )
+    {
+        if ( value < 2 * SUB_BUCKETS ) {
+            return static_cast< size_t >( value );
+        }
+        const int32_t shift = msb( value ) - SUB_BITS;
+        const size_t  index = static_cast< size_t >( shift + 1 ) * SUB_BUCKETS +
+                             static_cast< size_t >( ( value >> shift ) - SUB_BUCKETS );
+        return std::min( index, BUCKETS - 1 );
+    }
+
+    /** @brief largest value counted in the bucket */
+    static uint64_t upperBound( size_t index )
+    {
+        if ( index < 2 * SUB_BUCKETS ) {
+            return index;
+        }
+        const int32_t shift = static_cast< int32_t >( index / SUB_BUCKETS ) - 1;
+        return ( ( index % SUB_BUCKETS + SUB_BUCKETS + 1 ) << shift ) - 1;
+    }
+
+private:
+    static int32_t msb( uint64_t value )
+    {
+        int32_t result = 0;
+        while ( value >>= 1 ) {
+            result++;
+        }
+        return result;
+    }
+
+    std::array< std::atomic< uint64_t >, BUCKETS > m_counts{ };
+    std::atomic< uint64_t >                        m_max{ 0 };
+};
+
+}  // namespace ellsl
@@ -0,0 +1,372 @@
+// -----------------------------------------------------------------------
+// Copyright (C) 2019-2023, EyeLogic GmbH
+//
+// Permission is hereby granted, free of charge, to any person or
+// organization obtaining a copy of the software and accompanying
+// documentation covered by this license (the "Software") to use,
+// reproduce, display, distribute, execute, and transmit the Software,
+// and to prepare derivative works of the Software, and to permit
+// third-parties to whom the Software is furnished to do so.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, TITLE AND
+// NON-INFRINGEMENT. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR ANYONE
+// DISTRIBUTING THE SOFTWARE BE LIABLE FOR ANY DAMAGES OR OTHER
+// LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+// OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+// -----------------------------------------------------------------------
+
+
+#include "Log.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+using namespace ellsl;
+
+namespace
+{
+// the writer checks the queue at least this often, writing never wakes it up
+const std::chrono::milliseconds WRITER_POLL_INTERVAL( 10 );
+// upper bound for flush( ), e.g. if the console is blocked
+const std::chrono::seconds FLUSH_TIMEOUT( 1 );
+
+const char* const LEVEL_NAMES[] = { "verbose", "info", "warning", "error" };
+
+/**
+ * @brief bounded multi-producer single-consumer queue and the thread writing it out
+ *
+ * Every slot carries a sequence number: a producer claims the next position with a single
+ * compare-exchange and publishes the slot by advancing its sequence, the writer takes slots in
+ * position order and hands them back by advancing the sequence by the capacity.
+ */
+class Logger
+{
+public:
+    Logger( ) : m_slots( std::make_unique< Slot[] >( Log::QUEUE_CAPACITY ) )
+    {
+        for ( size_t i = 0; i < Log::QUEUE_CAPACITY; i++ ) {
+            m_slots[ i ].sequence.store( i, std::memory_order_relaxed );
+        }
+        m_writer = std::thread( &Logger::run, this );
+    }
+
+    ~Logger( )
+    {
+        {
+            std::unique_lock< std::mutex > lock( m_mutex );
+            m_run = false;
+        }
+        m_wakeup.notify_all( );
+        m_writer.join( );
+    }
+
+    void write( LogLevel level, const std::string& message )
+    {
+        if ( level < m_level.load( std::memory_order_relaxed ) ) {
+            return;
+        }
+        size_t position = m_enqueuePosition.load( std::memory_order_relaxed );
+        Slot*  slot;
+        while ( true ) {
+            slot                  = &m_slots[ position & MASK ];
+            const size_t sequence = slot->sequence.load( std::memory_order_acquire );
+            if ( sequence == position ) {
+                if ( m_enqueuePosition.compare_exchange_weak( position, position + 1,
+                                                              std::memory_order_relaxed ) ) {
+                    break;
+                }
+            } else if ( sequence < position ) {
+                // the writer has not handed this slot back yet - the queue is full
+                m_dropped.fetch_add( 1, std::memory_order_relaxed );
+                return;
+            } else {
+                position = m_enqueuePosition.load( std::memory_order_relaxed );
+            }
+        }
+
+        slot->level    = level;
+        slot->microSec = std::chrono::duration_cast< std::chrono::microseconds >(
+                             std::chrono::system_clock::now( ).time_since_epoch( ) )
+                             .count( );
+        slot->length = std::min( message.size( ), Log::MAX_MESSAGE );
+        std::memcpy( slot->text, message.data( ), slot->length );
+        slot->sequence.store( position + 1, std::memory_order_release );
+    }
+
+    void flush( )
+    {
+        const size_t target   = m_enqueuePosition.load( std::memory_order_acquire );
+        const auto   deadline = std::chrono::steady_clock::now( ) + FLUSH_TIMEOUT;
+        std::unique_lock< std::mutex > lock( m_mutex );
+        m_wakeup.notify_all( );
+        m_flushed.wait_until( lock, deadline, [ this, target ] {
+            return m_writtenPosition.load( std::memory_order_acquire ) >= target;
+        } );
+    }
+
+    bool setFile( const std::string& path, uint64 maxBytes, int32 files )
+    {
+        std::unique_lock< std::mutex > lock( m_fileMutex );
+        m_file.close( );
+        m_filePath = path;
+        if ( path.empty( ) ) {
+            return true;
+        }
+        m_file.open( path, std::ios::binary | std::ios::app );
+        m_fileBytes    = m_file.is_open( ) ? static_cast< uint64 >( m_file.tellp( ) ) : 0;
+        m_fileMaxBytes = maxBytes;
+        m_files        = std::max( files, 1 );
+        return m_file.is_open( );
+    }
+
+    void setPrompt( const std::string& prompt )
+    {
+        std::unique_lock< std::mutex > lock( m_fileMutex );
+        m_prompt = prompt;
+    }
+
+    Log::Statistics statistics( ) const
+    {
+        Log::Statistics statistics;
+        statistics.written = m_writtenPosition.load( std::memory_order_relaxed );
+        statistics.dropped = m_dropped.load( std::memory_order_relaxed );
+        return statistics;
+    }
+
+    std::atomic< LogLevel > m_level{ LogLevel::INFO };
+    std::atomic< bool >     m_console{ true };
+    std::atomic< bool >     m_awaitingInput{ false };
+
+private:
+    struct Slot {
+        std::atomic< size_t > sequence;
+        LogLevel              level;
+        int64                 microSec;
+        size_t                length;
+        char                  text[ Log::MAX_MESSAGE ];
+    };
+
+    static constexpr size_t MASK = Log::QUEUE_CAPACITY - 1;
+    static_assert( ( Log::QUEUE_CAPACITY & MASK ) == 0, "capacity must be a power of two" );
+
+    void run( )
+    {
+        std::unique_lock< std::mutex > lock( m_mutex );
+        while ( true ) {
+            lock.unlock( );
+            const bool written = drain( );
+            lock.lock( );
+            m_flushed.notify_all( );
+            if ( !m_run && !written ) {
+                return;
+            }
+            if ( !written ) {
+                m_wakeup.wait_for( lock, WRITER_POLL_INTERVAL );
+            }
+        }
+    }
+
+    // writes all published slots, returns whether there were any
+    bool drain( )
+    {
+        std::unique_lock< std::mutex > lock( m_fileMutex );
+        bool                           written = false;
+        while ( true ) {
+            Slot& slot = m_slots[ m_dequeuePosition & MASK ];
+            if ( slot.sequence.load( std::memory_order_acquire ) != m_dequeuePosition + 1 ) {
+                break;
+            }
+            writeMessage( slot );
+            slot.sequence.store( m_dequeuePosition + Log::QUEUE_CAPACITY,
+                                 std::memory_order_release );
+            m_dequeuePosition++;
+            m_writtenPosition.store( m_dequeuePosition, std::memory_order_release );
+            written = true;
+        }
+        if ( written ) {
+            std::cout << std::flush;
+            m_file << std::flush;
+        }
+        return written;
+    }
+
+    void writeMessage( const Slot& slot )
+    {
+        const std::string text( slot.text, slot.length );
+        if ( m_console.load( std::memory_order_relaxed ) ) {
+            const bool prompt = !m_prompt.empty( ) &&
+                                m_awaitingInput.load( std::memory_order_relaxed );
+            if ( prompt ) {
+                std::cout << '\n';
+            }
+            if ( slot.level >= LogLevel::WARNING ) {
+                std::cout << toString( slot.level ) << ": ";
+            }
+            std::cout << text << '\n';
+            if ( prompt ) {
+                std::cout << m_prompt;
+            }
+        }
+        if ( !m_file.is_open( ) ) {
+            return;
+        }
+
+        const std::time_t seconds = static_cast< std::time_t >( slot.microSec / 1000000 );
+        std::tm           local{ };
+#ifdef _WIN32
+        localtime_s( &local, &seconds );
+#else
+        localtime_r( &seconds, &local );
+#endif
+        char stamp[ 32 ];
+        const size_t length = std::strftime( stamp, sizeof( stamp ), "%Y-%m-%d %H:%M:%S", &local );
+        std::snprintf( stamp + length, sizeof( stamp ) - length, ".%03d",
+                       static_cast< int >( slot.microSec / 1000 % 1000 ) );
+
+        const std::string line =
+            std::string( stamp ) + " " + toString( slot.level ) + " " + text + "\n";
+        m_file << line;
+        m_fileBytes += line.size( );
+        if ( m_fileBytes >= m_fileMaxBytes ) {
+            rotate( );
+        }
+    }
+
+    // requires m_fileMutex to be held
+    void rotate( )
+    {
+        namespace fs = std::filesystem;
+        m_file.close( );
+        std::error_code ec;
+        fs::remove( m_filePath + "." + std::to_string( m_files - 1 ), ec );
+        for ( int32 i = m_files - 2; i >= 1; i-- ) {
+            fs::rename( m_filePath + "." + std::to_string( i ),
+                        m_filePath + "." + std::to_string( i + 1 ), ec );
+        }
+        if ( m_files > 1 ) {
+            fs::rename( m_filePath, m_filePath + ".1", ec );
+        } else {
+            fs::remove( m_filePath, ec );
+        }
+        m_file.open( m_filePath, std::ios::binary | std::ios::trunc );
+        m_fileBytes = 0;
+    }
+
+    std::unique_ptr< Slot[] > m_slots;
+    // producer and consumer positions live on separate cache lines to avoid false sharing
+    alignas( 64 ) std::atomic< size_t > m_enqueuePosition{ 0 };
+    std::atomic< uint64 > m_dropped{ 0 };
+    alignas( 64 ) size_t m_dequeuePosition = 0;
+    std::atomic< size_t > m_writtenPosition{ 0 };
+
+    // mutex secures m_run and the wakeup of the writer and of flush( )
+    std::mutex              m_mutex;
+    std::condition_variable m_wakeup;
+    std::condition_variable m_flushed;
+    bool                    m_run = true;
+
+    // mutex secures the file and the prompt, it is held by the writer while writing
+    std::mutex    m_fileMutex;
+    std::ofstream m_file;
+    std::string   m_filePath;
+    uint64        m_fileBytes    = 0;
+    uint64        m_fileMaxBytes = Log::DEFAULT_FILE_BYTES;
+    int32         m_files        = Log::DEFAULT_FILES;
+    std::string   m_prompt;
+
+    std::thread m_writer;
+};
+
+Logger&
+logger( )
+{
+    static Logger instance;
+    return instance;
+}
+}  // namespace
+
+void
+Log::write( LogLevel level, const std::string& message )
+{
+    logger( ).write( level, message );
+}
+
+void
+Log::setLevel( LogLevel level )
+{
+    logger( ).m_level = level;
+}
+
+LogLevel
+Log::level( )
+{
+    return logger( ).m_level;
+}
+
+void
+Log::setConsole( bool enabled )
+{
+    logger( ).m_console = enabled;
+}
+
+bool
+Log::setFile( const std::string& path, uint64 maxBytes, int32 files )
+{
+    return logger( ).setFile( path, maxBytes, files );
+}
+
+void
+Log::setPrompt( const std::string& prompt )
+{
+    logger( ).setPrompt( prompt );
+}
+
+void
+Log::setAwaitingInput( bool awaiting )
+{
+    logger( ).m_awaitingInput = awaiting;
+}
+
+void
+Log::flush( )
+{
+    logger( ).flush( );
+}
+
+Log::Statistics
+Log::statistics( )
+{
+    return logger( ).statistics( );
+}
+
+bool
+ellsl::parseLogLevel( const std::string& text, LogLevel& level )
+{
+    for ( size_t i = 0; i < sizeof( LEVEL_NAMES ) / sizeof( LEVEL_NAMES[ 0 ] ); i++ ) {
+        if ( text == LEVEL_NAMES[ i ] ) {
+            level = static_cast< LogLevel >( i );
+            return true;
+        }
+    }
+    return false;
+}
+
+std::string
+ellsl::toString( LogLevel level )
+{
+    return LEVEL_NAMES[ static_cast< size_t >( level ) ];
+}
@@ -0,0 +1,105 @@
+// -----------------------------------------------------------------------
+// Copyright (C) 2019-2023, EyeLogic GmbH
+//
+// Permission is hereby granted, free of charge, to any person or
+// organization obtaining a copy of the software and accompanying
+// documentation covered by this license (the "Software") to use,
+// reproduce, display, distribute, execute, and transmit the Software,
+// and to prepare derivative works of the Software, and to permit
+// third-parties to whom the Software is furnished to do so.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, TITLE AND
+// NON-INFRINGEMENT. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR ANYONE
+// DISTRIBUTING THE SOFTWARE BE LIABLE FOR ANY DAMAGES OR OTHER
+// LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+// OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+// -----------------------------------------------------------------------
+
+
+#pragma once
+
+#include <cstdint>
+
+using int32  = int32_t;
+using int64  = int64_t;
+using uint32 = uint32_t;
+using uint64 = uint64_t;
+
+#include <string>
+
+namespace ellsl
+{
+/** @brief severity of a log message - FAILURE, since ERROR is a macro of windows.h */
+enum class LogLevel {
+    VERBOSE,
+    INFO,
+    WARNING,
+    FAILURE,
+};
+
+/**
+ * @brief asynchronous log of the client, written to the console and an optional rotating file
+ *
+ * Writing a message copies it into a bounded lock-free queue and returns - it never locks, blocks
+ * or waits for the console, so it is safe on the ELApi callback threads. If the queue is full, the
+ * message is dropped and counted. A background thread writes the queued messages in order.
+ */
+class Log
+{
+public:
+    struct Statistics {
+        uint64 written = 0;
+        /** @brief messages dropped because the queue was full */
+        uint64 dropped = 0;
+    };
+
+    /** @brief number of messages the queue holds */
+    static constexpr size_t QUEUE_CAPACITY = 1024;
+    /** @brief longer messages are truncated */
+    static constexpr size_t MAX_MESSAGE = 256;
+
+    static constexpr uint64 DEFAULT_FILE_BYTES = uint64( 10 ) << 20;
+    static constexpr int32  DEFAULT_FILES      = 5;
+
+    static void write( LogLevel level, const std::string& message );
+    static void verbose( const std::string& message ) { write( LogLevel::VERBOSE, message ); }
+    static void info( const std::string& message ) { write( LogLevel::INFO, message ); }
+    static void warning( const std::string& message ) { write( LogLevel::WARNING, message ); }
+    static void failure( const std::string& message ) { write( LogLevel::FAILURE, message ); }
+
+    /** @brief messages below 'level' are discarded, INFO by default */
+    static void     setLevel( LogLevel level );
+    static LogLevel level( );
+
+    /** @brief whether messages are written to the console, on by default */
+    static void setConsole( bool enabled );
+
+    /**
+     * @brief appends all messages to 'path' as well - once it exceeds 'maxBytes', it is renamed to
+     * 'path'.1 and older files are shifted up to 'path'.<files - 1>. An empty path closes the file.
+     * @return false if the file cannot be opened
+     */
+    static bool setFile( const std::string& path, uint64 maxBytes = DEFAULT_FILE_BYTES,
+                         int32 files = DEFAULT_FILES );
+
+    /**
+     * @brief while the console waits for input, messages are written on a line of their own,
+     * followed by 'prompt' again
+     */
+    static void setPrompt( const std::string& prompt );
+    static void setAwaitingInput( bool awaiting );
+
+    /** @brief waits until all messages written so far are out */
+    static void flush( );
+
+    static Statistics statistics( );
+};
+
+/** @brief "verbose", "info", "warning" or "error" */
+bool        parseLogLevel( const std::string& text, LogLevel& level );
+std::string toString( LogLevel level );
+
+}  // namespace ellsl
@@ -0,0 +1,268 @@
+// -----------------------------------------------------------------------
+// Copyright (C) 2019-2023, EyeLogic GmbH
+//
+// Permission is hereby granted, free of charge, to any person or
+// organization obtaining a copy of the software and accompanying
+// documentation covered by this license (the "Software") to use,
+// reproduce, display, distribute, execute, and transmit the Software,
+// and to prepare derivative works of the Software, and to permit
+// third-parties to whom the Software is furnished to do so.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, TITLE AND
+// NON-INFRINGEMENT. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR ANYONE
+// DISTRIBUTING THE SOFTWARE BE LIABLE FOR ANY DAMAGES OR OTHER
+// LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+// OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+// -----------------------------------------------------------------------
+
+
+#include "MappedFile.h"
+
+#include <algorithm>
+#include <filesystem>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace ellsl;
+
+namespace
+{
+// granularity at which pages are faulted in and released
+constexpr uint64 PAGE_BYTES = 4096;
+}  // namespace
+
+std::unique_ptr< MappedFile >
+MappedFile::create( const std::string& path, uint64 size )
+{
+    std::unique_ptr< MappedFile > file( new MappedFile( path, true ) );
+    if ( !file->openFile( true, size ) || !file->mapFile( size, true ) ) {
+        // a file that could not be opened exists already and belongs to someone else
+        const bool created = file->isOpen( );
+        file->closeFile( );
+        if ( created ) {
+            std::error_code ec;
+            std::filesystem::remove( path, ec );
+        }
+        return nullptr;
+    }
+#ifndef MAP_POPULATE
+    // fault the pages in before the writer gets to them, the file is all zeros already
+    for ( uint64 offset = 0; offset < size; offset += PAGE_BYTES ) {
+        file->m_data[ offset ] = 0;
+    }
+#endif
+    return file;
+}
+
+std::unique_ptr< MappedFile >
+MappedFile::open( const std::string& path, bool writable )
+{
+    std::error_code ec;
+    const uint64    size = std::filesystem::file_size( path, ec );
+    if ( ec || size == 0 ) {
+        return nullptr;
+    }
+    std::unique_ptr< MappedFile > file( new MappedFile( path, writable ) );
+    if ( !file->openFile( false, size ) || !file->mapFile( size, false ) ) {
+        file->closeFile( );
+        return nullptr;
+    }
+    return file;
+}
+
+MappedFile::MappedFile( const std::string& path, bool writable )
+    : m_path( path ), m_writable( writable )
+{
+}
+
+MappedFile::~MappedFile( )
+{
+    close( m_size );
+}
+
+void
+MappedFile::flush( bool wait )
+{
+    if ( !m_data || !m_writable ) {
+        return;
+    }
+#ifdef _WIN32
+    FlushViewOfFile( m_data, 0 );
+    if ( wait ) {
+        FlushFileBuffers( m_file );
+    }
+#else
+    msync( m_data, m_size, wait ? MS_SYNC : MS_ASYNC );
+#endif
+}
+
+void
+MappedFile::adviseSequential( )
+{
+#ifndef _WIN32
+    if ( m_data ) {
+        madvise( m_data, m_size, MADV_SEQUENTIAL );
+    }
+#endif
+}
+
+void
+MappedFile::release( uint64 offset, uint64 length )
+{
+    // whole pages within the range only
+    const uint64 begin = ( offset + PAGE_BYTES - 1 ) & ~( PAGE_BYTES - 1 );
+    const uint64 end   = std::min( offset + length, m_size ) & ~( PAGE_BYTES - 1 );
+    if ( !m_data || end <= begin ) {
+        return;
+    }
+#ifdef _WIN32
+    // unlocking pages that are not locked removes them from the working set
+    VirtualUnlock( m_data + begin, end - begin );
+#else
+    madvise( m_data + begin, end - begin, MADV_DONTNEED );
+#endif
+}
+
+void
+MappedFile::close( uint64 length )
+{
+    if ( m_data ) {
+        flush( true );
+#ifdef _WIN32
+        UnmapViewOfFile( m_data );
+#else
+        munmap( m_data, m_size );
+#endif
+        m_data = nullptr;
+    }
+    if ( m_writable && length < m_size ) {
+#ifdef _WIN32
+        // the mapping has to be gone before the file can shrink
+        CloseHandle( m_mapping );
+        m_mapping = nullptr;
+        LARGE_INTEGER end;
+        end.QuadPart = static_cast< LONGLONG >( length );
+        if ( m_file && SetFilePointerEx( m_file, end, nullptr, FILE_BEGIN ) ) {
+            SetEndOfFile( m_file );
+        }
+#else
+        if ( m_fd >= 0 ) {
+            ftruncate( m_fd, static_cast< off_t >( length ) );
+        }
+#endif
+        m_size = length;
+    }
+    closeFile( );
+}
+
+bool
+MappedFile::openFile( bool create, uint64 size )
+{
+#ifdef _WIN32
+    // writers share with readers only: no other process can modify the file while we write
+    const DWORD access = m_writable ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ;
+    const DWORD share  = m_writable ? FILE_SHARE_READ : FILE_SHARE_READ | FILE_SHARE_WRITE;
+    HANDLE      file   = CreateFileA( m_path.c_str( ), access, share, nullptr,
+                                      create ? CREATE_NEW : OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL,
+                                      nullptr );
+    if ( file == INVALID_HANDLE_VALUE ) {
+        return false;
+    }
+    m_file = file;
+    // the mapping extends a new file to its full size
+    m_mapping = CreateFileMappingA( file, nullptr, m_writable ? PAGE_READWRITE : PAGE_READONLY,
+                                    static_cast< DWORD >( size >> 32 ),
+                                    static_cast< DWORD >( size ), nullptr );
+    return m_mapping != nullptr;
+#else
+    const int flags = m_writable ? ( create ? O_RDWR | O_CREAT | O_EXCL : O_RDWR ) : O_RDONLY;
+    m_fd            = ::open( m_path.c_str( ), flags, 0644 );
+    if ( m_fd < 0 ) {
+        return false;
+    }
+    // advisory lock: no other process can modify the file while we write
+    if ( m_writable && flock( m_fd, LOCK_EX | LOCK_NB ) != 0 ) {
+        return false;
+    }
+    if ( !create ) {
+        return true;
+    }
+#ifdef __linux__
+    // allocate the blocks now, a sparse file would allocate them on the hot path
+    return posix_fallocate( m_fd, 0, static_cast< off_t >( size ) ) == 0;
+#else
+    return ftruncate( m_fd, static_cast< off_t >( size ) ) == 0;
+#endif
+#endif
+}
+
+bool
+MappedFile::isOpen( ) const
+{
+#ifdef _WIN32
+    return m_file != nullptr;
+#else
+    return m_fd >= 0;
+#endif
+}
+
+bool
+MappedFile::mapFile( uint64 size, bool populate )
+{
+#ifdef _WIN32
+    m_data = static_cast< char* >(
+        MapViewOfFile( m_mapping, m_writable ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, 0 ) );
+    if ( !m_data ) {
+        return false;
+    }
+#else
+    int flags = MAP_SHARED;
+#ifdef MAP_POPULATE
+    // fault the pages in before the writer gets to them
+    if ( populate ) {
+        flags |= MAP_POPULATE;
+    }
+#endif
+    void* data = mmap( nullptr, size, m_writable ? PROT_READ | PROT_WRITE : PROT_READ, flags,
+                       m_fd, 0 );
+    if ( data == MAP_FAILED ) {
+        return false;
+    }
+    m_data = static_cast< char* >( data );
+#endif
+    m_size = size;
+    return true;
+}
+
+void
+MappedFile::closeFile( )
+{
+#ifdef _WIN32
+    if ( m_mapping ) {
+        CloseHandle( m_mapping );
+        m_mapping = nullptr;
+    }
+    if ( m_file ) {
+        CloseHandle( m_file );
+        m_file = nullptr;
+    }
+#else
+    if ( m_fd >= 0 ) {
+        ::close( m_fd );
+        m_fd = -1;
+    }
+#endif
+}
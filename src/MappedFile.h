@@ -0,0 +1,96 @@
+// -----------------------------------------------------------------------
+// Copyright (C) 2019-2023, EyeLogic GmbH
+//
+// Permission is hereby granted, free of charge, to any person or
+// organization obtaining a copy of the software and accompanying
+// documentation covered by this license (the "Software") to use,
+// reproduce, display, distribute, execute, and transmit the Software,
+// and to prepare derivative works of the Software, and to permit
+// third-parties to whom the Software is furnished to do so.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, TITLE AND
+// NON-INFRINGEMENT. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR ANYONE
+// DISTRIBUTING THE SOFTWARE BE LIABLE FOR ANY DAMAGES OR OTHER
+// LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+// OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+// -----------------------------------------------------------------------
+
+
+#pragma once
+
+#include <cstdint>
+
+using int32  = int32_t;
+using int64  = int64_t;
+using uint32 = uint32_t;
+using uint64 = uint64_t;
+
+#include <memory>
+#include <string>
+
+namespace ellsl
+{
+/**
+ * @brief mapping of a whole file into memory
+ *
+ * Files opened for writing are locked against other writers - advisory on POSIX, by share mode on
+ * Windows - so a process cannot modify a file another process is still writing.
+ */
+class MappedFile
+{
+public:
+    /**
+     * @brief creates a new file of 'size' bytes, allocates its blocks and faults its pages in
+     * @return nullptr if the file exists already, it is left untouched
+     */
+    static std::unique_ptr< MappedFile > create( const std::string& path, uint64 size );
+
+    /** @brief maps an existing file, nullptr if it is empty or 'writable' and locked */
+    static std::unique_ptr< MappedFile > open( const std::string& path, bool writable );
+
+    ~MappedFile( );
+
+    MappedFile( const MappedFile& ) = delete;
+    MappedFile& operator=( const MappedFile& ) = delete;
+
+    char*              data( ) { return m_data; }
+    const char*        data( ) const { return m_data; }
+    uint64             size( ) const { return m_size; }
+    const std::string& path( ) const { return m_path; }
+
+    /** @brief schedules the dirty pages for writing, or waits for them if 'wait' */
+    void flush( bool wait );
+
+    /** @brief hints that the file is read front to back */
+    void adviseSequential( );
+
+    /** @brief drops the pages of a range read before from the working set of the process */
+    void release( uint64 offset, uint64 length );
+
+    /** @brief flushes and unmaps the file, a writable file is truncated to 'length' bytes */
+    void close( uint64 length );
+
+private:
+    MappedFile( const std::string& path, bool writable );
+
+    bool openFile( bool create, uint64 size );
+    bool mapFile( uint64 size, bool populate );
+    void closeFile( );
+    bool isOpen( ) const;
+
+    const std::string m_path;
+    const bool        m_writable;
+    char*             m_data = nullptr;
+    uint64            m_size = 0;
+#ifdef _WIN32
+    void* m_file    = nullptr;
+    void* m_mapping = nullptr;
+#else
+    int m_fd = -1;
+#endif
+};
+
+}  // namespace ellsl
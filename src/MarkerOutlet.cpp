@@ -0,0 +1,118 @@
+// -----------------------------------------------------------------------
+// Copyright (C) 2019-2023, EyeLogic GmbH
+//
+// Permission is hereby granted, free of charge, to any person or
+// organization obtaining a copy of the software and accompanying
+// documentation covered by this license (the "Software") to use,
+// reproduce, display, distribute, execute, and transmit the Software,
+// and to prepare derivative works of the Software, and to permit
+// third-parties to whom the Software is furnished to do so.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, TITLE AND
+// NON-INFRINGEMENT. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR ANYONE
+// DISTRIBUTING THE SOFTWARE BE LIABLE FOR ANY DAMAGES OR OTHER
+// LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+// OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+// -----------------------------------------------------------------------
+
+
+#include "MarkerOutlet.h"
+
+using namespace ellsl;
+
+namespace
+{
+lsl::stream_info
+makeMarkerStreamInfo( uint64 deviceSerial, const std::string& name, const std::string& kind )
+{
+    lsl::stream_info lslInfo( name, "Markers", 1, lsl::IRREGULAR_RATE, lsl::cf_string,
+                              "EyeLogic One | " + std::to_string( deviceSerial ) + " | " + kind );
+    lslInfo.desc( )
+        .append_child( "channels" )
+        .append_child( "channel" )
+        .append_child_value( "label", "Event" )
+        .append_child_value( "type", "Marker" );
+    lslInfo.desc( )
+        .append_child( "acquisition" )
+        .append_child_value( "manufacturer", "EyeLogic" )
+        .append_child_value( "model", "One" )
+        .append_child_value( "serial number", std::to_string( deviceSerial ) );
+    return lslInfo;
+}
+}  // namespace
+
+MarkerOutlet::MarkerOutlet( uint64 deviceSerial, const std::string& name,
+                            const std::string& kind )
+    : m_deviceSerial( deviceSerial ),
+      m_outlet( makeMarkerStreamInfo( deviceSerial, name, kind ) ),
+      m_thread( &MarkerOutlet::run, this )
+{
+}
+
+MarkerOutlet::~MarkerOutlet( )
+{
+    {
+        std::unique_lock< std::mutex > lock( m_mutex );
+        m_run = false;
+    }
+    m_wakeup.notify_one( );
+    m_thread.join( );
+}
+
+void
+MarkerOutlet::post( double timestamp, std::string text )
+{
+    {
+        std::unique_lock< std::mutex > lock( m_mutex );
+        if ( m_queue.size( ) >= MAX_QUEUED ) {
+            m_statistics.dropped++;
+            return;
+        }
+        m_queue.emplace_back( timestamp, std::move( text ) );
+        m_statistics.posted++;
+    }
+    m_wakeup.notify_one( );
+}
+
+uint64
+MarkerOutlet::deviceSerial( ) const
+{
+    return m_deviceSerial;
+}
+
+MarkerOutlet::Statistics
+MarkerOutlet::statistics( ) const
+{
+    std::unique_lock< std::mutex > lock( m_mutex );
+    return m_statistics;
+}
+
+bool
+MarkerOutlet::haveConsumers( )
+{
+    return m_outlet.have_consumers( );
+}
+
+void
+MarkerOutlet::run( )
+{
+    std::deque< std::pair< double, std::string > > pending;
+    std::unique_lock< std::mutex >                  lock( m_mutex );
+    while ( true ) {
+        m_wakeup.wait( lock, [ this ] { return !m_run || !m_queue.empty( ); } );
+        if ( m_queue.empty( ) ) {
+            return;
+        }
+        pending.swap( m_queue );
+
+        lock.unlock( );
+        for ( const auto& marker : pending ) {
+            m_outlet.push_sample( &marker.second, marker.first );
+        }
+        pending.clear( );
+        lock.lock( );
+    }
+}
@@ -0,0 +1,94 @@
+// -----------------------------------------------------------------------
+// Copyright (C) 2019-2023, EyeLogic GmbH
+//
+// Permission is hereby granted, free of charge, to any person or
+// organization obtaining a copy of the software and accompanying
+// documentation covered by this license (the "Software") to use,
+// reproduce, display, distribute, execute, and transmit the Software,
+// and to prepare derivative works of the Software, and to permit
+// third-parties to whom the Software is furnished to do so.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, TITLE AND
+// NON-INFRINGEMENT. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR ANYONE
+// DISTRIBUTING THE SOFTWARE BE LIABLE FOR ANY DAMAGES OR OTHER
+// LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+// OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+// -----------------------------------------------------------------------
+
+
+#pragma once
+
+#include <cstdint>
+
+using int32  = int32_t;
+using int64  = int64_t;
+using uint32 = uint32_t;
+using uint64 = uint64_t;
+
+#include "lsl_cpp.h"
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+
+namespace ellsl
+{
+/** @brief default name of the marker stream */
+constexpr char MARKER_STREAM_NAME[] = "EyeLogicMarkers";
+
+/**
+ * @brief irregular-rate string stream of device and session events
+ *
+ * post( ) only queues the marker together with its LSL timestamp, a background thread pushes it
+ * into the outlet - posting never waits for LSL. Thread-safe.
+ */
+class MarkerOutlet
+{
+public:
+    struct Statistics {
+        uint64 posted  = 0;
+        /** @brief markers dropped because MAX_QUEUED were still pending */
+        uint64 dropped = 0;
+    };
+
+    /** @brief maximum number of markers waiting for the background thread */
+    static constexpr size_t MAX_QUEUED = 1024;
+
+    /** @param kind last part of the source id, keeps several marker streams of a device apart */
+    explicit MarkerOutlet( uint64 deviceSerial, const std::string& name = MARKER_STREAM_NAME,
+                           const std::string& kind = "markers" );
+    /** @brief pushes the pending markers before the outlet closes */
+    ~MarkerOutlet( );
+
+    MarkerOutlet( const MarkerOutlet& ) = delete;
+    MarkerOutlet& operator=( const MarkerOutlet& ) = delete;
+
+    /** @brief queues 'text' for the LSL time 'timestamp' */
+    void post( double timestamp, std::string text );
+
+    uint64     deviceSerial( ) const;
+    Statistics statistics( ) const;
+    bool       haveConsumers( );
+
+private:
+    void run( );
+
+    const uint64       m_deviceSerial;
+    lsl::stream_outlet m_outlet;
+
+    // mutex secures the queue, it is never held while pushing into LSL
+    mutable std::mutex                              m_mutex;
+    std::condition_variable                         m_wakeup;
+    std::deque< std::pair< double, std::string > > m_queue;
+    bool                                            m_run = true;
+    Statistics                                      m_statistics;
+    std::thread                                     m_thread;
+};
+
+}  // namespace ellsl
@@ -0,0 +1,441 @@
+// -----------------------------------------------------------------------
+// Copyright (C) 2019-2023, EyeLogic GmbH
+//
+// Permission is hereby granted, free of charge, to any person or
+// organization obtaining a copy of the software and accompanying
+// documentation covered by this license (the "Software") to use,
+// reproduce, display, distribute, execute, and transmit the Software,
+// and to prepare derivative works of the Software, and to permit
+// third-parties to whom the Software is furnished to do so.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, TITLE AND
+// NON-INFRINGEMENT. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR ANYONE
+// DISTRIBUTING THE SOFTWARE BE LIABLE FOR ANY DAMAGES OR OTHER
+// LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+// OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+// -----------------------------------------------------------------------
+
+
+#include "RecordingJournal.h"
+#include "GazeOutlet.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+
+using namespace ellsl;
+
+namespace
+{
+// records start behind the header, aligned to a cache line
+constexpr uint64 HEADER_BYTES = 64;
+// records are padded to a multiple of 8 bytes
+constexpr uint64 RECORD_ALIGNMENT = 8;
+// interval at which the worker flushes the active segment to disk
+const std::chrono::seconds FLUSH_INTERVAL( 1 );
+// session names tried when journals are opened in the same directory within a millisecond
+constexpr int32 MAX_SESSION_ATTEMPTS = 100;
+
+static_assert( sizeof( RecordingJournal::SegmentHeader ) <= HEADER_BYTES,
+               "segment header exceeds its reserved space" );
+static_assert( std::atomic< uint64 >::is_always_lock_free,
+               "the commit offset has to be lock-free to live in a mapped file" );
+
+
+struct SamplesHead {
+    uint32 count;
+    uint32 reserved;
+};
+
+RecordingJournal::SegmentHeader&
+segmentHeader( MappedFile& segment )
+{
+    return *reinterpret_cast< RecordingJournal::SegmentHeader* >( segment.data( ) );
+}
+
+uint64
+padded( uint64 bytes )
+{
+    return ( bytes + RECORD_ALIGNMENT - 1 ) & ~( RECORD_ALIGNMENT - 1 );
+}
+
+std::string
+sessionName( )
+{
+    const auto        now     = std::chrono::system_clock::now( );
+    const std::time_t seconds = std::chrono::system_clock::to_time_t( now );
+    const auto        milliseconds =
+        std::chrono::duration_cast< std::chrono::milliseconds >( now.time_since_epoch( ) ) % 1000;
+    std::tm local{ };
+#ifdef _WIN32
+    localtime_s( &local, &seconds );
+#else
+    localtime_r( &seconds, &local );
+#endif
+    char         name[ 32 ];
+    const size_t length = std::strftime( name, sizeof( name ), "%Y%m%d-%H%M%S", &local );
+    std::snprintf( name + length, sizeof( name ) - length, "-%03d",
+                   static_cast< int >( milliseconds.count( ) ) );
+    return name;
+}
+}  // namespace
+
+std::unique_ptr< RecordingJournal >
+RecordingJournal::open( const std::string& directory, uint64 segmentBytes,
+                        const std::string& prefix )
+{
+    std::error_code ec;
+    std::filesystem::create_directories( directory, ec );
+    if ( !std::filesystem::is_directory( directory, ec ) ) {
+        return nullptr;
+    }
+    const uint64 recovered = recover( directory );
+
+    const std::string started = prefix + "_" + sessionName( );
+    for ( int32 attempt = 0; attempt < MAX_SESSION_ATTEMPTS; attempt++ ) {
+        // a session of the same name started meanwhile, the next one gets a counter
+        const std::string session =
+            attempt == 0 ? started : started + "-" + std::to_string( attempt );
+        std::unique_ptr< RecordingJournal > journal( new RecordingJournal(
+            directory, session, std::max( segmentBytes, MIN_SEGMENT_BYTES ), recovered ) );
+        if ( journal->rollOver( ) ) {
+            return journal;
+        }
+        if ( !std::filesystem::exists( journal->segmentPath( 0 ), ec ) ) {
+            return nullptr;
+        }
+    }
+    return nullptr;
+}
+
+uint64
+RecordingJournal::recover( const std::string& directory )
+{
+    uint64          recovered = 0;
+    std::error_code ec;
+    for ( const auto& entry : std::filesystem::directory_iterator( directory, ec ) ) {
+        if ( !entry.is_regular_file( ec ) || entry.path( ).extension( ) != EXTENSION ) {
+            continue;
+        }
+        std::unique_ptr< MappedFile > segment = MappedFile::open( entry.path( ).string( ), true );
+        if ( !segment || segment->size( ) < HEADER_BYTES ) {
+            continue;
+        }
+        SegmentHeader* header = &segmentHeader( *segment );
+        if ( std::memcmp( header->magic, MAGIC, sizeof( MAGIC ) ) != 0 ||
+             header->version != VERSION ||
+             header->state.load( ) != static_cast< uint32 >( SegmentState::OPEN ) ) {
+            continue;
+        }
+
+        // keep the complete records up to the commit offset
+        const uint64 commit = std::min( header->commitOffset.load( ), segment->size( ) );
+        uint64       end    = header->headerBytes;
+        while ( end + sizeof( RecordHeader ) <= commit ) {
+            RecordHeader record;
+            std::memcpy( &record, segment->data( ) + end, sizeof( record ) );
+            const uint64 next = end + padded( sizeof( RecordHeader ) + record.bytes );
+            if ( record.type == 0 || next > commit ) {
+                break;
+            }
+            end = next;
+        }
+        if ( end == header->headerBytes ) {
+            // a preallocated spare that never got a record
+            segment->close( 0 );
+            std::filesystem::remove( entry.path( ), ec );
+            continue;
+        }
+        header->commitOffset.store( end );
+        header->state.store( static_cast< uint32 >( SegmentState::RECOVERED ) );
+        segment->close( end );
+        recovered++;
+    }
+    return recovered;
+}
+
+RecordingJournal::RecordingJournal( const std::string& directory, const std::string& session,
+                                    uint64 segmentBytes, uint64 recovered )
+    : m_directory( directory ),
+      m_session( session ),
+      m_segmentBytes( segmentBytes ),
+      m_recovered( recovered )
+{
+    m_worker = std::thread( &RecordingJournal::runWorker, this );
+}
+
+RecordingJournal::~RecordingJournal( )
+{
+    {
+        std::unique_lock< std::mutex > lock( m_segmentMutex );
+        if ( m_active ) {
+            segmentHeader( *m_active ).state.store( static_cast< uint32 >( SegmentState::CLOSED ) );
+            m_retired.push_back( std::move( m_active ) );
+        }
+        m_current   = nullptr;
+        m_workerRun = false;
+    }
+    m_workerWakeup.notify_all( );
+    m_worker.join( );
+}
+
+DerivedChannels
+RecordingJournal::derivedChannels( const DerivedHead& head )
+{
+    DerivedChannels derived;
+    derived.filter.oneEuro                    = head.oneEuro != 0;
+    derived.filter.minCutoff                  = head.minCutoff;
+    derived.filter.beta                       = head.beta;
+    derived.filter.derivativeCutoff           = head.derivativeCutoff;
+    derived.filter.kalman                     = head.kalman != 0;
+    derived.filter.processNoise               = head.processNoise;
+    derived.filter.measurementNoise           = head.measurementNoise;
+    derived.visualAngles                      = head.visualAngles != 0;
+    derived.geometry.mmBelowScreen            = head.mmBelowScreen;
+    derived.geometry.mmTrackerInFrontOfScreen = head.mmTrackerInFrontOfScreen;
+    derived.geometry.mmHeight                 = head.mmHeight;
+    derived.geometry.mmDepth                  = head.mmDepth;
+    return derived;
+}
+
+void
+RecordingJournal::beginStream( const StreamProfile& profile, int32 channels, int32 samplerate,
+                               uint64 deviceSerial, const std::string& infoXml,
+                               const DerivedChannels& derived )
+{
+    const StreamHead head = { static_cast< uint32 >( channels ),
+                              static_cast< uint32 >( profile.format ),
+                              static_cast< uint32 >( profile.channels ),
+                              static_cast< uint32 >( sizeof( DerivedHead ) ),
+                              static_cast< double >( samplerate ),
+                              deviceSerial };
+    const DerivedHead derivedHead = { derived.filter.oneEuro ? 1u : 0u,
+                                      derived.filter.kalman ? 1u : 0u,
+                                      derived.visualAngles ? 1u : 0u,
+                                      0,
+                                      derived.filter.minCutoff,
+                                      derived.filter.beta,
+                                      derived.filter.derivativeCutoff,
+                                      derived.filter.processNoise,
+                                      derived.filter.measurementNoise,
+                                      derived.geometry.mmBelowScreen,
+                                      derived.geometry.mmTrackerInFrontOfScreen,
+                                      derived.geometry.mmHeight,
+                                      derived.geometry.mmDepth };
+    m_streamRecord.resize( sizeof( head ) + sizeof( derivedHead ) + infoXml.size( ) );
+    char* record = m_streamRecord.data( );
+    std::memcpy( record, &head, sizeof( head ) );
+    std::memcpy( record + sizeof( head ), &derivedHead, sizeof( derivedHead ) );
+    std::memcpy( record + sizeof( head ) + sizeof( derivedHead ), infoXml.data( ),
+                 infoXml.size( ) );
+
+    // a new segment starts with the stream record anyway
+    const uint64 bytes = padded( sizeof( RecordHeader ) + m_streamRecord.size( ) );
+    if ( m_current && m_writeOffset + bytes <= m_current->size( ) ) {
+        append( RecordType::STREAM, { { m_streamRecord.data( ), m_streamRecord.size( ) } } );
+    } else if ( !rollOver( ) ) {
+        m_dropped.fetch_add( 1, std::memory_order_relaxed );
+    }
+}
+
+void
+RecordingJournal::appendSamples( const double* timestamps, const void* values, int32 count,
+                                 size_t sampleBytes )
+{
+    const SamplesHead head = { static_cast< uint32 >( count ), 0 };
+    append( RecordType::SAMPLES, { { &head, sizeof( head ) },
+                                   { timestamps, sizeof( double ) * count },
+                                   { values, sampleBytes * count } } );
+}
+
+void
+RecordingJournal::appendEvent( double timestamp, int32 event, const std::string& description )
+{
+    const EventHead head = { timestamp, event, 0 };
+    append( RecordType::EVENT,
+            { { &head, sizeof( head ) }, { description.data( ), description.size( ) } } );
+}
+
+const std::string&
+RecordingJournal::directory( ) const
+{
+    return m_directory;
+}
+
+RecordingJournal::Statistics
+RecordingJournal::statistics( ) const
+{
+    Statistics statistics;
+    statistics.segments  = m_segments.load( std::memory_order_relaxed );
+    statistics.records   = m_records.load( std::memory_order_relaxed );
+    statistics.bytes     = m_bytes.load( std::memory_order_relaxed );
+    statistics.dropped   = m_dropped.load( std::memory_order_relaxed );
+    statistics.recovered = m_recovered;
+    return statistics;
+}
+
+bool
+RecordingJournal::append( RecordType type, std::initializer_list< Part > parts )
+{
+    uint64 payload = 0;
+    for ( const Part& part : parts ) {
+        payload += part.bytes;
+    }
+    const uint64 bytes = padded( sizeof( RecordHeader ) + payload );
+    if ( bytes > m_segmentBytes - HEADER_BYTES ) {
+        m_dropped.fetch_add( 1, std::memory_order_relaxed );
+        return false;
+    }
+    if ( !m_current || m_writeOffset + bytes > m_current->size( ) ) {
+        if ( !rollOver( ) ) {
+            m_dropped.fetch_add( 1, std::memory_order_relaxed );
+            return false;
+        }
+    }
+
+    // plain copies into the mapping, the padding of a fresh segment is already zero
+    char*              record = m_current->data( ) + m_writeOffset;
+    const RecordHeader header = { static_cast< uint32 >( type ), static_cast< uint32 >( payload ) };
+    std::memcpy( record, &header, sizeof( header ) );
+    record += sizeof( header );
+    for ( const Part& part : parts ) {
+        std::memcpy( record, part.data, part.bytes );
+        record += part.bytes;
+    }
+    m_writeOffset += bytes;
+    segmentHeader( *m_current ).commitOffset.store( m_writeOffset, std::memory_order_release );
+
+    m_records.fetch_add( 1, std::memory_order_relaxed );
+    m_bytes.fetch_add( bytes, std::memory_order_relaxed );
+    return true;
+}
+
+bool
+RecordingJournal::rollOver( )
+{
+    std::unique_ptr< MappedFile > next;
+    uint64                     number = 0;
+    {
+        std::unique_lock< std::mutex > lock( m_segmentMutex );
+        if ( m_active ) {
+            segmentHeader( *m_active ).state.store( static_cast< uint32 >( SegmentState::CLOSED ) );
+            m_retired.push_back( std::move( m_active ) );
+        }
+        m_current = nullptr;
+        next      = std::move( m_spare );
+        if ( !next ) {
+            number = m_nextSegment++;
+        }
+    }
+    m_workerWakeup.notify_one( );
+    // the worker had no spare ready yet, e.g. on the very first segment
+    if ( !next ) {
+        next = createSegment( number );
+        if ( !next ) {
+            return false;
+        }
+    }
+
+    m_current     = next.get( );
+    m_writeOffset = segmentHeader( *m_current ).headerBytes;
+    {
+        std::unique_lock< std::mutex > lock( m_segmentMutex );
+        m_active = std::move( next );
+    }
+    m_segments.fetch_add( 1, std::memory_order_relaxed );
+
+    // every segment describes its stream on its own
+    if ( !m_streamRecord.empty( ) ) {
+        append( RecordType::STREAM, { { m_streamRecord.data( ), m_streamRecord.size( ) } } );
+    }
+    return true;
+}
+
+std::string
+RecordingJournal::segmentPath( uint64 number ) const
+{
+    char suffix[ 16 ];
+    std::snprintf( suffix, sizeof( suffix ), "_%04llu",
+                   static_cast< unsigned long long >( number ) );
+    return ( std::filesystem::path( m_directory ) / ( m_session + suffix + EXTENSION ) ).string( );
+}
+
+std::unique_ptr< MappedFile >
+RecordingJournal::createSegment( uint64 number )
+{
+    std::unique_ptr< MappedFile > segment = MappedFile::create( segmentPath( number ),
+                                                                m_segmentBytes );
+    if ( !segment ) {
+        return nullptr;
+    }
+    SegmentHeader* header = new ( segment->data( ) ) SegmentHeader;
+    std::memcpy( header->magic, MAGIC, sizeof( MAGIC ) );
+    header->version         = VERSION;
+    header->headerBytes     = static_cast< uint32 >( HEADER_BYTES );
+    header->capacity        = m_segmentBytes;
+    header->segment         = number;
+    header->createdMicroSec = std::chrono::duration_cast< std::chrono::microseconds >(
+                                  std::chrono::system_clock::now( ).time_since_epoch( ) )
+                                  .count( );
+    header->commitOffset.store( HEADER_BYTES );
+    header->state.store( static_cast< uint32 >( SegmentState::OPEN ) );
+    header->reserved = 0;
+    return segment;
+}
+
+void
+RecordingJournal::runWorker( )
+{
+    std::unique_lock< std::mutex > lock( m_segmentMutex );
+    while ( true ) {
+        // truncate full segments to their committed size - without holding the mutex
+        std::vector< std::unique_ptr< MappedFile > > retired = std::move( m_retired );
+        m_retired.clear( );
+        if ( !retired.empty( ) ) {
+            lock.unlock( );
+            for ( std::unique_ptr< MappedFile >& segment : retired ) {
+                segment->close( segmentHeader( *segment ).commitOffset.load( ) );
+            }
+            retired.clear( );
+            lock.lock( );
+        }
+        if ( !m_workerRun ) {
+            break;
+        }
+
+        // preallocate the next segment so that roll-over on the writer only swaps pointers, once
+        // the first one has claimed the session name
+        if ( !m_spare && m_active ) {
+            const uint64 number = m_nextSegment++;
+            lock.unlock( );
+            std::unique_ptr< MappedFile > spare = createSegment( number );
+            lock.lock( );
+            m_spare = std::move( spare );
+        }
+
+        // the segment is only destroyed by this thread once retired, so the writer never waits
+        // for the flush on roll-over
+        if ( MappedFile* active = m_active.get( ) ) {
+            lock.unlock( );
+            active->flush( false );
+            lock.lock( );
+        }
+        m_workerWakeup.wait_for( lock, FLUSH_INTERVAL,
+                                 [ this ] { return !m_retired.empty( ) || !m_workerRun; } );
+    }
+
+    // the spare never got a record
+    if ( m_spare ) {
+        const std::string path = m_spare->path( );
+        m_spare->close( 0 );
+        m_spare = nullptr;
+        std::error_code ec;
+        std::filesystem::remove( path, ec );
+    }
+}
@@ -0,0 +1,234 @@
+// -----------------------------------------------------------------------
+// Copyright (C) 2019-2023, EyeLogic GmbH
+//
+// Permission is hereby granted, free of charge, to any person or
+// organization obtaining a copy of the software and accompanying
+// documentation covered by this license (the "Software") to use,
+// reproduce, display, distribute, execute, and transmit the Software,
+// and to prepare derivative works of the Software, and to permit
+// third-parties to whom the Software is furnished to do so.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, TITLE AND
+// NON-INFRINGEMENT. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR ANYONE
+// DISTRIBUTING THE SOFTWARE BE LIABLE FOR ANY DAMAGES OR OTHER
+// LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+// OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+// -----------------------------------------------------------------------
+
+
+#pragma once
+
+#include <cstdint>
+
+using int32  = int32_t;
+using int64  = int64_t;
+using uint32 = uint32_t;
+using uint64 = uint64_t;
+
+#include "MappedFile.h"
+#include "StreamProfile.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ellsl
+{
+struct DerivedChannels;
+
+/**
+ * @brief local backup of the gaze stream in preallocated, memory-mapped segment files
+ *
+ * Every segment <prefix>_<session>_<number>.eljournal starts with a SegmentHeader followed by
+ * records, each a RecordHeader and its payload padded to 8 bytes. Records are copied into the
+ * mapping and published by advancing SegmentHeader::commitOffset, so appending never performs a
+ * syscall. A worker thread preallocates the next segment, flushes the mapping once per second
+ * and truncates full segments to their committed size.
+ *
+ * The session is named by its local start time, YYYYMMDD-HHMMSS-mmm, followed by a counter if
+ * another journal in the directory started within the same millisecond.
+ *
+ * Segments left open by a crashed process are truncated to their commit offset and marked
+ * RECOVERED when a journal is opened in the same directory.
+ *
+ * Records (all values little-endian, as written by the host):
+ *  - STREAM: a StreamHead, a DerivedHead of StreamHead::derivedBytes and the XML stream info;
+ *    repeated at the start of every segment
+ *  - SAMPLES: uint32 count, uint32 0, double timestamps[count], then count * channels values of
+ *    the stream's format - exactly what was pushed to the outlet
+ *  - EVENT: double timestamp, int32 ELApi::Event, uint32 0 and a description
+ *
+ * Not thread-safe, the owner has to serialize all calls except for those of the worker.
+ */
+class RecordingJournal
+{
+public:
+    enum class RecordType : uint32 {
+        STREAM  = 1,
+        SAMPLES = 2,
+        EVENT   = 3,
+    };
+
+    enum class SegmentState : uint32 {
+        OPEN      = 0,
+        CLOSED    = 1,
+        RECOVERED = 2,
+    };
+
+    struct SegmentHeader {
+        char                  magic[ 8 ];
+        uint32                version;
+        uint32                headerBytes;
+        uint64                capacity;
+        uint64                segment;
+        /** @brief creation time, microseconds since the epoch */
+        int64                 createdMicroSec;
+        /** @brief end of the last complete record, relative to the beginning of the file */
+        std::atomic< uint64 > commitOffset;
+        std::atomic< uint32 > state;
+        uint32                reserved;
+    };
+
+    struct RecordHeader {
+        uint32 type;
+        /** @brief payload size without padding */
+        uint32 bytes;
+    };
+
+    struct StreamHead {
+        uint32 channels;
+        /** @brief ValueFormat and ChannelSelection of the StreamProfile */
+        uint32 format;
+        uint32 selection;
+        /** @brief size of the DerivedHead that follows, 0 in journals written without one */
+        uint32 derivedBytes;
+        double samplerate;
+        uint64 deviceSerial;
+    };
+
+    struct EventHead {
+        double timestamp;
+        /** @brief ELApi::Event */
+        int32  event;
+        uint32 reserved;
+    };
+
+    /** @brief configuration of the derived channels, see DerivedChannels */
+    struct DerivedHead {
+        uint32 oneEuro;
+        uint32 kalman;
+        uint32 visualAngles;
+        uint32 reserved;
+        double minCutoff;
+        double beta;
+        double derivativeCutoff;
+        double processNoise;
+        double measurementNoise;
+        double mmBelowScreen;
+        double mmTrackerInFrontOfScreen;
+        double mmHeight;
+        double mmDepth;
+    };
+
+    struct Statistics {
+        uint64 segments = 0;
+        uint64 records  = 0;
+        uint64 bytes    = 0;
+        /** @brief records that did not fit into a segment or found no segment to go to */
+        uint64 dropped  = 0;
+        /** @brief segments recovered when the journal was opened */
+        uint64 recovered = 0;
+    };
+
+    static constexpr char   MAGIC[ 8 ]            = { 'E', 'L', 'J', 'R', 'N', 'L', '\0', '\1' };
+    static constexpr uint32 VERSION               = 1;
+    static constexpr uint64 DEFAULT_SEGMENT_BYTES = uint64( 64 ) << 20;
+    static constexpr uint64 MIN_SEGMENT_BYTES     = uint64( 1 ) << 20;
+    static constexpr char   EXTENSION[]           = ".eljournal";
+
+    /**
+     * @brief recovers the segments of crashed sessions in 'directory' and starts a new session
+     * @return nullptr if the directory or the first segment cannot be created
+     */
+    static std::unique_ptr< RecordingJournal > open( const std::string& directory,
+                                                     uint64 segmentBytes = DEFAULT_SEGMENT_BYTES,
+                                                     const std::string& prefix = "eyelogic" );
+
+    /** @brief truncates all OPEN segments in 'directory' to their commit offset */
+    static uint64 recover( const std::string& directory );
+
+    ~RecordingJournal( );
+
+    RecordingJournal( const RecordingJournal& ) = delete;
+    RecordingJournal& operator=( const RecordingJournal& ) = delete;
+
+    /** @brief derived channels described by 'head' */
+    static DerivedChannels derivedChannels( const DerivedHead& head );
+
+    /**
+     * @brief starts a new stream, its layout applies to all following SAMPLES records
+     * @param channels values per sample - those of the profile followed by the derived channels
+     */
+    void beginStream( const StreamProfile& profile, int32 channels, int32 samplerate,
+                      uint64 deviceSerial, const std::string& infoXml,
+                      const DerivedChannels& derived );
+
+    /** @brief appends 'count' converted samples of 'sampleBytes' each */
+    void appendSamples( const double* timestamps, const void* values, int32 count,
+                        size_t sampleBytes );
+
+    void appendEvent( double timestamp, int32 event, const std::string& description );
+
+    const std::string& directory( ) const;
+    Statistics         statistics( ) const;
+
+private:
+    RecordingJournal( const std::string& directory, const std::string& session,
+                      uint64 segmentBytes, uint64 recovered );
+
+    struct Part {
+        const void* data;
+        size_t      bytes;
+    };
+
+    bool append( RecordType type, std::initializer_list< Part > parts );
+    bool rollOver( );
+    std::string                segmentPath( uint64 number ) const;
+    std::unique_ptr< MappedFile > createSegment( uint64 number );
+    void                       runWorker( );
+
+    const std::string m_directory;
+    const std::string m_session;
+    const uint64      m_segmentBytes;
+
+    // owned by the writing thread
+    MappedFile*          m_current     = nullptr;
+    uint64               m_writeOffset = 0;
+    std::vector< char >  m_streamRecord;
+
+    std::atomic< uint64 > m_records{ 0 };
+    std::atomic< uint64 > m_bytes{ 0 };
+    std::atomic< uint64 > m_dropped{ 0 };
+    std::atomic< uint64 > m_segments{ 0 };
+    const uint64          m_recovered;
+
+    // mutex secures the segments below, it is only taken by the writer on roll-over
+    mutable std::mutex                         m_segmentMutex;
+    std::condition_variable                    m_workerWakeup;
+    std::unique_ptr< MappedFile >                 m_active;
+    std::unique_ptr< MappedFile >                 m_spare;
+    std::vector< std::unique_ptr< MappedFile > >  m_retired;
+    uint64                                     m_nextSegment = 0;
+    bool                                       m_workerRun   = true;
+    std::thread                                m_worker;
+};
+
+}  // namespace ellsl
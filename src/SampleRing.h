@@ -0,0 +1,136 @@
+// -----------------------------------------------------------------------
+// Copyright (C) 2019-2023, EyeLogic GmbH
+//
+// Permission is hereby granted, free of charge, to any person or
+// organization obtaining a copy of the software and accompanying
+// documentation covered by this license (the "Software") to use,
+// reproduce, display, distribute, execute, and transmit the Software,
+// and to prepare derivative works of the Software, and to permit
+// third-parties to whom the Software is furnished to do so.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, TITLE AND
+// NON-INFRINGEMENT. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR ANYONE
+// DISTRIBUTING THE SOFTWARE BE LIABLE FOR ANY DAMAGES OR OTHER
+// LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+// OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+// -----------------------------------------------------------------------
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace ellsl
+{
+/**
+ * @brief bounded lock-free ring buffer for exactly one producer and one consumer thread
+ *
+ * The storage is allocated once on construction, push( ) and pop( ) never allocate, lock or
+ * block. If the ring is full, push( ) drops the element and counts an overflow.
+ */
+template< typename T >
+class SampleRing
+{
+public:
+    struct Statistics {
+        size_t   capacity;
+        size_t   occupancy;
+        size_t   highWater;
+        uint64_t pushed;
+        uint64_t overflows;
+    };
+
+    /** @param capacity number of elements, rounded up to the next power of two */
+    explicit SampleRing( size_t capacity )
+        : m_capacity( roundUp( capacity ) ),
+          m_mask( m_capacity - 1 ),
+          m_buffer( std::make_unique< T[] >( m_capacity ) )
+    {
+    }
+
+    SampleRing( const SampleRing& ) = delete;
+    SampleRing& operator=( const SampleRing& ) = delete;
+
+    /** @brief producer side - returns false and counts an overflow if the ring is full */
+    bool push( const T& value )
+    {
+        const size_t head = m_head.load( std::memory_order_relaxed );
+        const size_t used = head - m_tail.load( std::memory_order_acquire );
+        if ( used >= m_capacity ) {
+            m_overflows.fetch_add( 1, std::memory_order_relaxed );
+            return false;
+        }
+        m_buffer[ head & m_mask ] = value;
+        m_head.store( head + 1, std::memory_order_release );
+
+        m_pushed.fetch_add( 1, std::memory_order_relaxed );
+        if ( used + 1 > m_highWater.load( std::memory_order_relaxed ) ) {
+            m_highWater.store( used + 1, std::memory_order_relaxed );
+        }
+        return true;
+    }
+
+    /** @brief consumer side - returns false if the ring is empty */
+    bool pop( T& value )
+    {
+        const size_t tail = m_tail.load( std::memory_order_relaxed );
+        if ( tail == m_head.load( std::memory_order_acquire ) ) {
+            return false;
+        }
+        value = m_buffer[ tail & m_mask ];
+        m_tail.store( tail + 1, std::memory_order_release );
+        return true;
+    }
+
+    /** @brief consumer side - drops all queued elements */
+    void clear( ) { m_tail.store( m_head.load( std::memory_order_acquire ), std::memory_order_release ); }
+
+    bool empty( ) const
+    {
+        return m_head.load( std::memory_order_acquire ) == m_tail.load( std::memory_order_acquire );
+    }
+
+    size_t size( ) const
+    {
+        return m_head.load( std::memory_order_acquire ) - m_tail.load( std::memory_order_acquire );
+    }
+
+    size_t capacity( ) const { return m_capacity; }
+
+    Statistics statistics( ) const
+    {
+        return { m_capacity, size( ), m_highWater.load( std::memory_order_relaxed ),
+                 m_pushed.load( std::memory_order_relaxed ),
+                 m_overflows.load( std::memory_order_relaxed ) };
+    }
+
+private:
+    static size_t roundUp( size_t value )
+    {
+        size_t result = 1;
+        while ( result < value ) {
+            result <<= 1;
+        }
+        return result;
+    }
+
+    static constexpr size_t CACHELINE = 64;
+
+    const size_t           m_capacity;
+    const size_t           m_mask;
+    std::unique_ptr< T[] > m_buffer;
+
+    // producer and consumer indices live on separate cache lines to avoid false sharing
+    alignas( CACHELINE ) std::atomic< size_t > m_head{ 0 };
+    std::atomic< size_t >   m_highWater{ 0 };
+    std::atomic< uint64_t > m_pushed{ 0 };
+    std::atomic< uint64_t > m_overflows{ 0 };
+    alignas( CACHELINE ) std::atomic< size_t > m_tail{ 0 };
+};
+
+}  // namespace ellsl
@@ -0,0 +1,272 @@
+// -----------------------------------------------------------------------
+// Copyright (C) 2019-2023, EyeLogic GmbH
+//
+// Permission is hereby granted, free of charge, to any person or
+// organization obtaining a copy of the software and accompanying
+// documentation covered by this license (the "Software") to use,
+// reproduce, display, distribute, execute, and transmit the Software,
+// and to prepare derivative works of the Software, and to permit
+// third-parties to whom the Software is furnished to do so.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, TITLE AND
+// NON-INFRINGEMENT. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR ANYONE
+// DISTRIBUTING THE SOFTWARE BE LIABLE FOR ANY DAMAGES OR OTHER
+// LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+// OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+// -----------------------------------------------------------------------
+
+
+#include "SessionReplay.h"
+#include "GazeSource.h"
+#include "Log.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <thread>
+
+using namespace ellsl;
+
+namespace
+{
+// recorded pauses longer than this are skipped [s]
+constexpr double MAX_PAUSE = 1.0;
+// longest uninterrupted sleep, bounds the reaction to a stop request [s]
+constexpr double MAX_SLEEP = 0.1;
+
+/** @brief rebuilds the gaze sample of a converted sample, dropped channels become invalid */
+template< typename Value >
+void
+restoreSample( const char* values, int32 channels, const int32* indices,
+               elapi::ELGazeSample& gazeSample )
+{
+    for ( int32 channel = 1; channel < NCHANNELS; channel++ ) {
+        std::memcpy( reinterpret_cast< char* >( &gazeSample ) + CHANNEL_OFFSET[ channel ],
+                     &elapi::ELInvalidValue, sizeof( double ) );
+    }
+    for ( int32 i = 0; i < channels; i++ ) {
+        Value value;
+        std::memcpy( &value, values + i * sizeof( Value ), sizeof( value ) );
+        const double restored = std::isnan( value ) ? elapi::ELInvalidValue : value;
+        if ( indices[ i ] == 0 ) {
+            gazeSample.index = static_cast< int32 >( restored );
+        } else {
+            std::memcpy( reinterpret_cast< char* >( &gazeSample ) + CHANNEL_OFFSET[ indices[ i ] ],
+                         &restored, sizeof( restored ) );
+        }
+    }
+}
+
+/** @brief reads the derived channels of a converted sample */
+template< typename Value >
+void
+restoreDerived( const char* values, size_t count, double* derived )
+{
+    for ( size_t i = 0; i < count; i++ ) {
+        Value value;
+        std::memcpy( &value, values + i * sizeof( Value ), sizeof( value ) );
+        derived[ i ] = value;
+    }
+}
+}  // namespace
+
+SessionReplay::SessionReplay( double speed, int32 chunkSamples,
+                              std::chrono::microseconds chunkDuration )
+    : m_speed( speed ), m_chunkSamples( chunkSamples ), m_chunkDuration( chunkDuration )
+{
+}
+
+bool
+SessionReplay::open( const std::string& path )
+{
+    return m_reader.open( path );
+}
+
+void
+SessionReplay::run( const std::atomic< bool >& stop )
+{
+    JournalReader::Record record;
+    while ( !stop && m_reader.next( record ) ) {
+        switch ( record.type ) {
+            case RecordingJournal::RecordType::STREAM:
+                beginStream( record.payload, record.bytes );
+                break;
+            case RecordingJournal::RecordType::SAMPLES:
+                replaySamples( record.payload, record.bytes, stop );
+                break;
+            case RecordingJournal::RecordType::EVENT:
+                replayEvent( record.payload, record.bytes );
+                break;
+        }
+    }
+    if ( m_outlet ) {
+        m_outlet->flush( );
+    }
+}
+
+const SessionReplay::Statistics&
+SessionReplay::statistics( ) const
+{
+    return m_statistics;
+}
+
+void
+SessionReplay::beginStream( const char* payload, uint32 bytes )
+{
+    RecordingJournal::StreamHead head;
+    if ( bytes < sizeof( head ) ) {
+        return;
+    }
+    std::memcpy( &head, payload, sizeof( head ) );
+
+    StreamProfile profile;
+    profile.channels       = static_cast< ChannelSelection >( head.selection );
+    profile.format         = static_cast< ValueFormat >( head.format );
+    const int32 samplerate = static_cast< int32 >( head.samplerate );
+    int32       indices[ NCHANNELS ];
+    const int32 channels   = channelIndices( profile.channels, indices );
+    const int32 stride     = std::max( channels, static_cast< int32 >( head.channels ) );
+
+    // journals written before the derived channels were described only have their values
+    DerivedChannels               derived;
+    RecordingJournal::DerivedHead derivedHead;
+    if ( head.derivedBytes >= sizeof( derivedHead ) &&
+         bytes >= sizeof( head ) + sizeof( derivedHead ) ) {
+        std::memcpy( &derivedHead, payload + sizeof( head ), sizeof( derivedHead ) );
+        derived = RecordingJournal::derivedChannels( derivedHead );
+        if ( channels + derived.count( ) != stride ) {
+            derived = { };
+        }
+    }
+
+    if ( !m_markers || m_markers->deviceSerial( ) != head.deviceSerial ) {
+        m_markers = nullptr;
+        m_markers = std::make_unique< MarkerOutlet >( head.deviceSerial );
+    }
+
+    // every segment repeats the stream record, the outlet only changes with the layout
+    if ( m_outlet && m_outlet->profile( ) == profile && m_outlet->samplerate( ) == samplerate &&
+         m_outlet->derived( ) == derived && m_stride == stride ) {
+        return;
+    }
+
+    if ( m_outlet ) {
+        m_outlet->flush( );
+    }
+    m_outlet = GazeOutlet::create( profile, samplerate, head.deviceSerial, nullptr,
+                                   GAZE_STREAM_NAME, derived );
+    m_outlet->setChunking( m_chunkSamples, m_chunkDuration );
+    m_channels = channelIndices( profile.channels, m_indices );
+    m_stride   = stride;
+    m_format   = profile.format;
+    m_paced    = false;
+    m_derived.assign( static_cast< size_t >( derived.count( ) ), 0.0 );
+    m_statistics.streams++;
+
+    Log::info( "replaying " + toString( profile ) + " stream at " + std::to_string( samplerate ) +
+               " Hz of device " + std::to_string( head.deviceSerial ) );
+}
+
+void
+SessionReplay::replaySamples( const char* payload, uint32 bytes, const std::atomic< bool >& stop )
+{
+    uint32 count;
+    if ( !m_outlet || bytes < 8 ) {
+        return;
+    }
+    std::memcpy( &count, payload, sizeof( count ) );
+    const size_t sampleBytes =
+        m_stride * ( m_format == ValueFormat::FLOAT32 ? sizeof( float ) : sizeof( double ) );
+    if ( bytes < 8 + count * ( sizeof( double ) + sampleBytes ) ) {
+        return;
+    }
+    const char* timestamps = payload + 8;
+    const char* values     = timestamps + count * sizeof( double );
+
+    elapi::ELGazeSample gazeSample{ };
+    for ( uint32 i = 0; i < count && !stop; i++ ) {
+        double recorded;
+        std::memcpy( &recorded, timestamps + i * sizeof( double ), sizeof( recorded ) );
+        const char* sample = values + i * sampleBytes;
+        if ( m_format == ValueFormat::FLOAT32 ) {
+            restoreSample< float >( sample, m_channels, m_indices, gazeSample );
+            restoreDerived< float >( sample + m_channels * sizeof( float ), m_derived.size( ),
+                                     m_derived.data( ) );
+        } else {
+            restoreSample< double >( sample, m_channels, m_indices, gazeSample );
+            restoreDerived< double >( sample + m_channels * sizeof( double ), m_derived.size( ),
+                                      m_derived.data( ) );
+        }
+        gazeSample.timestampMicroSec = static_cast< int64 >( recorded * 1e6 );
+
+        const double timestamp = pace( recorded, stop );
+        if ( m_derived.empty( ) ) {
+            m_outlet->push( gazeSample, timestamp );
+        } else {
+            m_outlet->push( gazeSample, m_derived.data( ), timestamp );
+        }
+        m_statistics.samples++;
+    }
+}
+
+void
+SessionReplay::replayEvent( const char* payload, uint32 bytes )
+{
+    RecordingJournal::EventHead head;
+    if ( bytes < sizeof( head ) ) {
+        return;
+    }
+    std::memcpy( &head, payload, sizeof( head ) );
+    m_statistics.events++;
+    // events before the first stream have no device to go to
+    if ( !m_markers ) {
+        return;
+    }
+    // on the timeline of the samples, without waiting - events are not ordered with them
+    const double timestamp = m_paced && m_speed > 0.0
+                                 ? m_replayBase + ( head.timestamp - m_recordedBase ) / m_speed
+                                 : lsl::local_clock( );
+    m_markers->post( timestamp, toString( static_cast< elapi::ELApi::Event >( head.event ) ) );
+}
+
+double
+SessionReplay::pace( double recorded, const std::atomic< bool >& stop )
+{
+    const double now = lsl::local_clock( );
+    if ( !m_paced || recorded < m_lastRecorded || recorded - m_lastRecorded > MAX_PAUSE ) {
+        // (re-)start the timeline, right behind the previously replayed sample
+        m_paced        = true;
+        m_recordedBase = recorded;
+        m_replayBase   = std::max( now, m_lastReplayed );
+    } else {
+        m_statistics.recorded += recorded - m_lastRecorded;
+    }
+    m_lastRecorded = recorded;
+
+    double replayed;
+    if ( m_speed <= 0.0 ) {
+        replayed = now;
+    } else {
+        replayed = m_replayBase + ( recorded - m_recordedBase ) / m_speed;
+        // a partially filled chunk must not wait for the next sample beyond its time limit
+        const double slice = m_chunkDuration.count( ) > 0
+                                 ? std::min( MAX_SLEEP, m_chunkDuration.count( ) * 1e-6 )
+                                 : MAX_SLEEP;
+        for ( double wait = replayed - now; wait > 0.0 && !stop;
+              wait        = replayed - lsl::local_clock( ) ) {
+            if ( m_outlet->chunkExpired( ) ) {
+                m_outlet->flush( );
+            }
+            std::this_thread::sleep_for(
+                std::chrono::duration< double >( std::min( wait, slice ) ) );
+        }
+    }
+    if ( m_lastReplayed > 0.0 ) {
+        m_statistics.replayed += replayed - m_lastReplayed;
+    }
+    m_lastReplayed = replayed;
+    return replayed;
+}
@@ -0,0 +1,107 @@
+// -----------------------------------------------------------------------
+// Copyright (C) 2019-2023, EyeLogic GmbH
+//
+// Permission is hereby granted, free of charge, to any person or
+// organization obtaining a copy of the software and accompanying
+// documentation covered by this license (the "Software") to use,
+// reproduce, display, distribute, execute, and transmit the Software,
+// and to prepare derivative works of the Software, and to permit
+// third-parties to whom the Software is furnished to do so.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, TITLE AND
+// NON-INFRINGEMENT. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR ANYONE
+// DISTRIBUTING THE SOFTWARE BE LIABLE FOR ANY DAMAGES OR OTHER
+// LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+// OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+// -----------------------------------------------------------------------
+
+
+#pragma once
+
+#include <cstdint>
+
+using int32  = int32_t;
+using int64  = int64_t;
+using uint32 = uint32_t;
+using uint64 = uint64_t;
+
+#include "GazeOutlet.h"
+#include "JournalReader.h"
+#include "MarkerOutlet.h"
+
+#include <atomic>
+#include <memory>
+#include <string>
+
+namespace ellsl
+{
+/**
+ * @brief re-publishes a recording journal through a gaze outlet of the recorded layout
+ *
+ * The derived channels are replayed as recorded, device events on the marker stream of the device.
+ * Samples and events are stamped in the local LSL clock domain of the replay. Recorded pauses of
+ * more than a second, e.g. between sessions, are skipped.
+ */
+class SessionReplay
+{
+public:
+    struct Statistics {
+        uint64 streams = 0;
+        uint64 samples = 0;
+        uint64 events  = 0;
+        /** @brief recorded and replayed duration [s] */
+        double recorded = 0.0;
+        double replayed = 0.0;
+    };
+
+    /**
+     * @param speed factor on the recorded timing, 0 replays as fast as possible
+     * @param chunkSamples @see LSLClient::setChunking
+     */
+    explicit SessionReplay( double speed = 1.0, int32 chunkSamples = 1,
+                            std::chrono::microseconds chunkDuration = { } );
+
+    /** @see JournalReader::open */
+    bool open( const std::string& path );
+
+    /** @brief replays to the end of the recording or until 'stop' is set */
+    void run( const std::atomic< bool >& stop );
+
+    const Statistics& statistics( ) const;
+
+private:
+    void beginStream( const char* payload, uint32 bytes );
+    void replaySamples( const char* payload, uint32 bytes, const std::atomic< bool >& stop );
+    void replayEvent( const char* payload, uint32 bytes );
+    /** @brief LSL time at which a recorded sample goes out, waits for it unless unpaced */
+    double pace( double recorded, const std::atomic< bool >& stop );
+
+    const double                    m_speed;
+    const int32                     m_chunkSamples;
+    const std::chrono::microseconds m_chunkDuration;
+
+    JournalReader                 m_reader;
+    std::unique_ptr< GazeOutlet >   m_outlet;
+    std::unique_ptr< MarkerOutlet > m_markers;
+    int32                           m_channels = 0;
+    // values per recorded sample, derived channels follow those of the profile - they are
+    // skipped if the journal does not describe them
+    int32                           m_stride = 0;
+    int32                           m_indices[ NCHANNELS ];
+    ValueFormat                     m_format = ValueFormat::DOUBLE64;
+    std::vector< double >           m_derived;
+
+    // recorded time and the LSL time it was replayed at, of the first sample after a pause
+    bool   m_paced        = false;
+    double m_recordedBase = 0.0;
+    double m_replayBase   = 0.0;
+    double m_lastRecorded = 0.0;
+    double m_lastReplayed = 0.0;
+
+    Statistics m_statistics;
+};
+
+}  // namespace ellsl
@@ -0,0 +1,625 @@
+// -----------------------------------------------------------------------
+// Copyright (C) 2019-2023, EyeLogic GmbH
+//
+// Permission is hereby granted, free of charge, to any person or
+// organization obtaining a copy of the software and accompanying
+// documentation covered by this license (the "Software") to use,
+// reproduce, display, distribute, execute, and transmit the Software,
+// and to prepare derivative works of the Software, and to permit
+// third-parties to whom the Software is furnished to do so.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, TITLE AND
+// NON-INFRINGEMENT. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR ANYONE
+// DISTRIBUTING THE SOFTWARE BE LIABLE FOR ANY DAMAGES OR OTHER
+// LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+// OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+// -----------------------------------------------------------------------
+
+
+#include "SimulatedGazeSource.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+using namespace ellsl;
+
+namespace
+{
+const double PI = 3.14159265358979323846;
+
+// viewing geometry of the simulated subject, in device coordinates [mm]
+const double EYE_DISTANCE_MM = 620.0;
+const double EYE_HEIGHT_MM   = 200.0;
+const double EYE_SPACING_MM  = 64.0;
+
+const std::chrono::seconds DISCONNECT_DURATION( 1 );
+const std::chrono::seconds SERVER_OUTAGE_DURATION( 3 );
+
+double
+pixelsPerDegree( const elapi::ELApi::ScreenConfig& screen, double distanceMM )
+{
+    const double mmPerPixel = screen.physicalSizeX_mm / screen.resolutionX;
+    return distanceMM * std::tan( PI / 180.0 ) / mmPerPixel;
+}
+
+int64
+systemMicroSec( )
+{
+    return std::chrono::duration_cast< std::chrono::microseconds >(
+               std::chrono::system_clock::now( ).time_since_epoch( ) )
+        .count( );
+}
+}  // namespace
+
+/**
+ * @brief oculomotor model: fixations with drift and tremor, main-sequence saccades with a
+ * minimum-jerk profile, blinks and single-sample dropouts
+ */
+class SimulatedGazeSource::GazeModel
+{
+public:
+    GazeModel( const elapi::ELApi::ScreenConfig& screen, const SimulatorConfig& config,
+               int32 samplerate )
+        : m_config( config ),
+          m_width( screen.resolutionX ),
+          m_height( screen.resolutionY ),
+          m_ppd( pixelsPerDegree( screen, EYE_DISTANCE_MM ) ),
+          m_dt( 1.0 / samplerate ),
+          m_random( config.seed ),
+          m_x( m_width / 2.0 ),
+          m_y( m_height / 2.0 ),
+          m_filteredX( m_x ),
+          m_filteredY( m_y )
+    {
+        startFixation( );
+        m_untilBlink = nextBlinkInterval( );
+    }
+
+    void next( elapi::ELGazeSample& sample )
+    {
+        m_time += m_dt;
+        m_phaseTime += m_dt;
+        m_untilBlink -= m_dt;
+
+        switch ( m_phase ) {
+            case Phase::FIXATION: {
+                // slow drift as a random walk of ~0.5 deg/s
+                const double drift = 0.5 * m_ppd * std::sqrt( m_dt );
+                m_x += drift * m_normal( m_random );
+                m_y += drift * m_normal( m_random );
+                if ( m_phaseTime >= m_phaseDuration ) {
+                    if ( m_untilBlink <= 0.0 ) {
+                        startBlink( );
+                    } else {
+                        startSaccade( );
+                    }
+                }
+            } break;
+            case Phase::SACCADE: {
+                const double tau = m_phaseTime / m_phaseDuration;
+                if ( tau >= 1.0 ) {
+                    m_x = m_targetX;
+                    m_y = m_targetY;
+                    startFixation( );
+                } else {
+                    // minimum-jerk position profile
+                    const double s = tau * tau * tau * ( 10.0 - 15.0 * tau + 6.0 * tau * tau );
+                    m_x            = m_startX + ( m_targetX - m_startX ) * s;
+                    m_y            = m_startY + ( m_targetY - m_startY ) * s;
+                }
+            } break;
+            case Phase::BLINK:
+                if ( m_phaseTime >= m_phaseDuration ) {
+                    m_untilBlink = nextBlinkInterval( );
+                    startFixation( );
+                }
+                break;
+        }
+
+        const bool valid = m_phase != Phase::BLINK && !m_dropout( m_random );
+        if ( !valid ) {
+            for ( double* field = &sample.porRawX; field <= &sample.pupilRadiusRight; field++ ) {
+                *field = elapi::ELInvalidValue;
+            }
+            return;
+        }
+
+        // slow head movement
+        const double swayX = 5.0 * std::sin( 2.0 * PI * 0.07 * m_time );
+        const double swayY = 3.0 * std::sin( 2.0 * PI * 0.05 * m_time + 1.0 );
+        const double swayZ = 10.0 * std::sin( 2.0 * PI * 0.03 * m_time + 2.0 );
+
+        // tremor and measurement noise of ~0.05 deg per eye
+        const double noise = 0.05 * m_ppd;
+        sample.porLeftX    = m_x + noise * m_normal( m_random );
+        sample.porLeftY    = m_y + noise * m_normal( m_random );
+        sample.porRightX   = m_x + noise * m_normal( m_random );
+        sample.porRightY   = m_y + noise * m_normal( m_random );
+        sample.porRawX     = 0.5 * ( sample.porLeftX + sample.porRightX );
+        sample.porRawY     = 0.5 * ( sample.porLeftY + sample.porRightY );
+
+        const double alpha  = std::min( 1.0, 60.0 * m_dt );
+        m_filteredX         = m_filteredX + alpha * ( sample.porRawX - m_filteredX );
+        m_filteredY         = m_filteredY + alpha * ( sample.porRawY - m_filteredY );
+        sample.porFilteredX = m_filteredX;
+        sample.porFilteredY = m_filteredY;
+
+        sample.eyePositionLeftX  = -EYE_SPACING_MM / 2.0 + swayX;
+        sample.eyePositionLeftY  = EYE_HEIGHT_MM + swayY;
+        sample.eyePositionLeftZ  = EYE_DISTANCE_MM + swayZ;
+        sample.eyePositionRightX = EYE_SPACING_MM / 2.0 + swayX;
+        sample.eyePositionRightY = EYE_HEIGHT_MM + swayY;
+        sample.eyePositionRightZ = EYE_DISTANCE_MM + swayZ;
+
+        const double pupil      = 1.9 + 0.2 * std::sin( 2.0 * PI * m_time / 8.0 );
+        sample.pupilRadiusLeft  = pupil + 0.01 * m_normal( m_random );
+        sample.pupilRadiusRight = pupil + 0.01 * m_normal( m_random );
+    }
+
+private:
+    enum class Phase { FIXATION, SACCADE, BLINK };
+
+    void startFixation( )
+    {
+        m_phase         = Phase::FIXATION;
+        m_phaseTime     = 0.0;
+        m_phaseDuration = std::min( 1.0, 0.15 + std::exponential_distribution<>( 1.0 / 0.15 )(
+                                                    m_random ) );
+    }
+
+    void startSaccade( )
+    {
+        std::uniform_real_distribution<> targetX( 0.1 * m_width, 0.9 * m_width );
+        std::uniform_real_distribution<> targetY( 0.1 * m_height, 0.9 * m_height );
+        m_phase     = Phase::SACCADE;
+        m_phaseTime = 0.0;
+        m_startX    = m_x;
+        m_startY    = m_y;
+        m_targetX   = targetX( m_random );
+        m_targetY   = targetY( m_random );
+
+        // main sequence: duration [ms] = 2.2 * amplitude [deg] + 21
+        const double amplitude =
+            std::hypot( m_targetX - m_startX, m_targetY - m_startY ) / m_ppd;
+        m_phaseDuration = ( 2.2 * amplitude + 21.0 ) / 1000.0;
+    }
+
+    void startBlink( )
+    {
+        m_phase         = Phase::BLINK;
+        m_phaseTime     = 0.0;
+        m_phaseDuration = std::uniform_real_distribution<>( 0.1, 0.25 )( m_random );
+    }
+
+    double nextBlinkInterval( )
+    {
+        if ( m_config.blinkInterval <= 0.0 ) {
+            return std::numeric_limits< double >::infinity( );
+        }
+        return std::exponential_distribution<>( 1.0 / m_config.blinkInterval )( m_random );
+    }
+
+    const SimulatorConfig& m_config;
+    const double           m_width;
+    const double           m_height;
+    const double           m_ppd;
+    const double           m_dt;
+
+    std::mt19937                m_random;
+    std::normal_distribution<>  m_normal{ 0.0, 1.0 };
+    std::bernoulli_distribution m_dropout{ m_config.dropoutProbability };
+
+    Phase  m_phase         = Phase::FIXATION;
+    double m_time          = 0.0;
+    double m_phaseTime     = 0.0;
+    double m_phaseDuration = 0.0;
+    double m_untilBlink    = 0.0;
+    double m_x, m_y;
+    double m_startX = 0.0, m_startY = 0.0;
+    double m_targetX = 0.0, m_targetY = 0.0;
+    double m_filteredX, m_filteredY;
+};
+
+SimulatedGazeSource::SimulatedGazeSource( const SimulatorConfig& config ) : m_config( config )
+{
+    m_screenConfig = { };
+    m_screenConfig.localMachine = true;
+    std::strncpy( m_screenConfig.id, "SIMULATED", sizeof( m_screenConfig.id ) - 1 );
+    std::strncpy( m_screenConfig.name, "Simulated 24\" Full HD", sizeof( m_screenConfig.name ) - 1 );
+    m_screenConfig.resolutionX      = 1920;
+    m_screenConfig.resolutionY      = 1080;
+    m_screenConfig.physicalSizeX_mm = 531.4;
+    m_screenConfig.physicalSizeY_mm = 298.9;
+
+    m_events = std::thread( &SimulatedGazeSource::runEvents, this );
+}
+
+SimulatedGazeSource::~SimulatedGazeSource( )
+{
+    disconnect( );
+    {
+        std::unique_lock< std::mutex > lock( m_eventMutex );
+        m_eventRun = false;
+    }
+    m_eventArrived.notify_all( );
+    m_events.join( );
+}
+
+void
+SimulatedGazeSource::registerEventListener( elapi::ELApi::ELEventCallback* callback )
+{
+    m_eventListener = callback;
+}
+
+void
+SimulatedGazeSource::registerGazeSampleListener( elapi::ELApi::ELGazeSampleCallback* callback )
+{
+    m_sampleListener = callback;
+}
+
+elapi::ELApi::ReturnConnect
+SimulatedGazeSource::connect( )
+{
+    if ( std::chrono::steady_clock::now( ).time_since_epoch( ).count( ) < m_serverOutageEnd ) {
+        return elapi::ELApi::ReturnConnect::FAILURE;
+    }
+    m_connected = true;
+    return elapi::ELApi::ReturnConnect::SUCCESS;
+}
+
+elapi::ELApi::ReturnConnect
+SimulatedGazeSource::connectRemote( elapi::ELApi::ServerInfo )
+{
+    return connect( );
+}
+
+int32
+SimulatedGazeSource::requestServerList( int32, elapi::ELApi::ServerInfo* serverList,
+                                        int32 serverListLength )
+{
+    const int32 count = std::max( 0, std::min( m_config.servers, serverListLength ) );
+    for ( int32 i = 0; i < count; ++i ) {
+        serverList[ i ] = { };
+        std::strncpy( serverList[ i ].ip, "127.0.0.1", sizeof( serverList[ i ].ip ) - 1 );
+        serverList[ i ].port = static_cast< uint16_t >( i );
+    }
+    return count;
+}
+
+void
+SimulatedGazeSource::disconnect( )
+{
+    {
+        std::unique_lock< std::mutex > lock( m_trackingMutex );
+        stopTracking( );
+    }
+    m_connected = false;
+    m_sampleArrived.notify_all( );
+    m_eventArrived.notify_all( );
+}
+
+bool
+SimulatedGazeSource::isConnected( ) const
+{
+    return m_connected;
+}
+
+void
+SimulatedGazeSource::getActiveScreen( elapi::ELApi::ScreenConfig& screenConfig ) const
+{
+    screenConfig = m_screenConfig;
+}
+
+void
+SimulatedGazeSource::getDeviceInfo( DeviceInfo& deviceInfo ) const
+{
+    deviceInfo.deviceSerial       = m_config.deviceSerial;
+    deviceInfo.frameRates         = m_config.frameRates;
+    deviceInfo.calibrationMethods = m_config.calibrationMethods;
+}
+
+elapi::ELApi::ReturnNextData
+SimulatedGazeSource::getNextEvent( elapi::ELApi::Event& event, int32 timeoutMillis )
+{
+    std::unique_lock< std::mutex > lock( m_eventMutex );
+    m_eventArrived.wait_for( lock, std::chrono::milliseconds( timeoutMillis ), [ this ] {
+        return m_eventCount != m_eventsRead || !m_connected;
+    } );
+    event = m_lastEvent;
+    if ( m_eventCount != m_eventsRead ) {
+        m_eventsRead = m_eventCount;
+        return elapi::ELApi::ReturnNextData::SUCCESS;
+    }
+    return m_connected ? elapi::ELApi::ReturnNextData::TIMEOUT
+                       : elapi::ELApi::ReturnNextData::CONNECTION_CLOSED;
+}
+
+elapi::ELApi::ReturnNextData
+SimulatedGazeSource::getNextGazeSample( elapi::ELGazeSample& gazeSample, int32 timeoutMillis )
+{
+    std::unique_lock< std::mutex > lock( m_sampleMutex );
+    m_sampleArrived.wait_for( lock, std::chrono::milliseconds( timeoutMillis ), [ this ] {
+        return m_sampleCount != m_samplesRead || !m_connected;
+    } );
+    gazeSample = m_lastSample;
+    if ( m_sampleCount != m_samplesRead ) {
+        m_samplesRead = m_sampleCount;
+        return elapi::ELApi::ReturnNextData::SUCCESS;
+    }
+    return m_connected ? elapi::ELApi::ReturnNextData::TIMEOUT
+                       : elapi::ELApi::ReturnNextData::CONNECTION_CLOSED;
+}
+
+elapi::ELApi::ReturnStart
+SimulatedGazeSource::requestTracking( int32 frameRateModeInd )
+{
+    if ( !m_connected ) {
+        return elapi::ELApi::ReturnStart::NOT_CONNECTED;
+    }
+    if ( m_deviceMissing ) {
+        return elapi::ELApi::ReturnStart::DEVICE_MISSING;
+    }
+    if ( frameRateModeInd < 0 ||
+         frameRateModeInd >= static_cast< int32 >( m_config.frameRates.size( ) ) ) {
+        return elapi::ELApi::ReturnStart::INVALID_FRAMERATE_MODE;
+    }
+
+    std::unique_lock< std::mutex > lock( m_trackingMutex );
+    const int32                    samplerate = m_config.frameRates[ frameRateModeInd ];
+    if ( !m_trackingRun || m_samplerate != samplerate ) {
+        startTracking( samplerate );
+    }
+    return elapi::ELApi::ReturnStart::SUCCESS;
+}
+
+void
+SimulatedGazeSource::unrequestTracking( )
+{
+    std::unique_lock< std::mutex > lock( m_trackingMutex );
+    if ( m_trackingRun ) {
+        stopTracking( );
+        simulateEvent( elapi::ELApi::Event::TRACKING_STOPPED );
+    }
+}
+
+elapi::ELApi::ReturnCalibrate
+SimulatedGazeSource::calibrate( int32 calibrationModeInd )
+{
+    if ( !m_connected ) {
+        return elapi::ELApi::ReturnCalibrate::NOT_CONNECTED;
+    }
+    if ( !m_trackingRun ) {
+        return elapi::ELApi::ReturnCalibrate::NOT_TRACKING;
+    }
+    if ( calibrationModeInd < 0 ||
+         calibrationModeInd >= static_cast< int32 >( m_config.calibrationMethods.size( ) ) ) {
+        return elapi::ELApi::ReturnCalibrate::INVALID_CALIBRATION_MODE;
+    }
+    {
+        std::unique_lock< std::mutex > lock( m_calibrationMutex );
+        if ( m_calibrating ) {
+            return elapi::ELApi::ReturnCalibrate::ALREADY_BUSY;
+        }
+        m_calibrating = true;
+        m_aborted     = false;
+    }
+
+    const bool completed =
+        waitCalibrationPoints( m_config.calibrationMethods[ calibrationModeInd ] );
+
+    std::unique_lock< std::mutex > lock( m_calibrationMutex );
+    m_calibrating = false;
+    m_calibrated  = m_calibrated || completed;
+    return completed ? elapi::ELApi::ReturnCalibrate::SUCCESS
+                     : elapi::ELApi::ReturnCalibrate::FAILURE;
+}
+
+void
+SimulatedGazeSource::abortCalibValidation( )
+{
+    std::unique_lock< std::mutex > lock( m_calibrationMutex );
+    if ( m_calibrating ) {
+        m_aborted = true;
+        m_calibrationAbort.notify_all( );
+    }
+}
+
+elapi::ELApi::ReturnValidate
+SimulatedGazeSource::validate( elapi::ELApi::ELValidationResult& validationResult )
+{
+    for ( auto& point : validationResult.pointsData ) {
+        point = { elapi::ELInvalidValue, elapi::ELInvalidValue, elapi::ELInvalidValue,
+                  elapi::ELInvalidValue, elapi::ELInvalidValue, elapi::ELInvalidValue };
+    }
+    if ( !m_connected ) {
+        return elapi::ELApi::ReturnValidate::NOT_CONNECTED;
+    }
+    if ( !m_trackingRun ) {
+        return elapi::ELApi::ReturnValidate::NOT_TRACKING;
+    }
+    {
+        std::unique_lock< std::mutex > lock( m_calibrationMutex );
+        if ( !m_calibrated ) {
+            return elapi::ELApi::ReturnValidate::NOT_CALIBRATED;
+        }
+        if ( m_calibrating ) {
+            return elapi::ELApi::ReturnValidate::ALREADY_BUSY;
+        }
+        m_calibrating = true;
+        m_aborted     = false;
+    }
+
+    const int32 npoints   = sizeof( validationResult.pointsData ) /
+                          sizeof( validationResult.pointsData[ 0 ] );
+    const bool  completed = waitCalibrationPoints( npoints );
+    {
+        std::unique_lock< std::mutex > lock( m_calibrationMutex );
+        m_calibrating = false;
+    }
+    if ( !completed ) {
+        return elapi::ELApi::ReturnValidate::FAILURE;
+    }
+
+    std::mt19937                     random( m_config.seed );
+    std::uniform_real_distribution<> deviation( 0.2, 0.6 );
+    const double                     ppd = pixelsPerDegree( m_screenConfig, EYE_DISTANCE_MM );
+    for ( int32 i = 0; i < npoints; i++ ) {
+        auto& point                 = validationResult.pointsData[ i ];
+        point.validationPointPxX    = m_screenConfig.resolutionX * ( i % 2 == 0 ? 0.25 : 0.75 );
+        point.validationPointPxY    = m_screenConfig.resolutionY * ( i / 2 == 0 ? 0.25 : 0.75 );
+        point.meanDeviationLeftDeg  = deviation( random );
+        point.meanDeviationLeftPx   = point.meanDeviationLeftDeg * ppd;
+        point.meanDeviationRightDeg = deviation( random );
+        point.meanDeviationRightPx  = point.meanDeviationRightDeg * ppd;
+    }
+    return elapi::ELApi::ReturnValidate::SUCCESS;
+}
+
+void
+SimulatedGazeSource::simulateEvent( elapi::ELApi::Event event )
+{
+    {
+        std::unique_lock< std::mutex > lock( m_eventMutex );
+        m_eventQueue.push_back( event );
+        m_lastEvent = event;
+        m_eventCount++;
+    }
+    m_eventArrived.notify_all( );
+}
+
+// requires m_trackingMutex to be held
+void
+SimulatedGazeSource::startTracking( int32 samplerate )
+{
+    stopTracking( );
+    m_samplerate  = samplerate;
+    m_trackingRun = true;
+    m_tracking    = std::thread( &SimulatedGazeSource::runTracking, this, samplerate );
+}
+
+// requires m_trackingMutex to be held
+void
+SimulatedGazeSource::stopTracking( )
+{
+    m_trackingRun = false;
+    if ( m_tracking.joinable( ) ) {
+        if ( m_tracking.get_id( ) == std::this_thread::get_id( ) ) {
+            // called from a listener on the tracking thread, which ends on its own
+            m_tracking.detach( );
+        } else {
+            m_tracking.join( );
+        }
+    }
+}
+
+void
+SimulatedGazeSource::runTracking( int32 samplerate )
+{
+    GazeModel  model( m_screenConfig, m_config, samplerate );
+    const auto period = std::chrono::duration_cast< std::chrono::steady_clock::duration >(
+        std::chrono::duration< double >( 1.0 / samplerate ) );
+    const int64 start          = systemMicroSec( );
+    auto        next           = std::chrono::steady_clock::now( );
+    auto        lastDisconnect = next;
+    auto        lastOutage     = next;
+
+    std::mt19937                random( m_config.seed + 1 );
+    std::bernoulli_distribution frameLoss( m_config.frameLossProbability );
+
+    while ( m_trackingRun ) {
+        if ( !m_config.unthrottled ) {
+            next += period;
+            std::this_thread::sleep_until( next );
+        }
+
+        elapi::ELGazeSample sample{ };
+        model.next( sample );
+        const int64 now          = systemMicroSec( );
+        sample.index             = m_nextIndex++;
+        sample.timestampMicroSec = now + m_config.clockOffsetMicroSec +
+                                   static_cast< int64 >( ( now - start ) * m_config.clockDriftPpm *
+                                                         1e-6 );
+        if ( !frameLoss( random ) ) {
+            deliverSample( sample );
+        }
+
+        if ( m_config.disconnectInterval > 0.0 &&
+             std::chrono::steady_clock::now( ) - lastDisconnect >=
+                 std::chrono::duration< double >( m_config.disconnectInterval ) ) {
+            // the device is gone for a while, tracking has to be requested again afterwards
+            m_deviceMissing = true;
+            simulateEvent( elapi::ELApi::Event::DEVICE_DISCONNECTED );
+            simulateEvent( elapi::ELApi::Event::TRACKING_STOPPED );
+            const auto reconnect = std::chrono::steady_clock::now( ) + DISCONNECT_DURATION;
+            while ( m_trackingRun && std::chrono::steady_clock::now( ) < reconnect ) {
+                std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+            }
+            m_deviceMissing = false;
+            m_trackingRun   = false;
+            simulateEvent( elapi::ELApi::Event::DEVICE_CONNECTED );
+        }
+
+        if ( m_config.connectionLossInterval > 0.0 &&
+             std::chrono::steady_clock::now( ) - lastOutage >=
+                 std::chrono::duration< double >( m_config.connectionLossInterval ) ) {
+            // the server goes away, the client has to connect and request tracking again
+            m_serverOutageEnd =
+                ( std::chrono::steady_clock::now( ) + SERVER_OUTAGE_DURATION ).time_since_epoch( )
+                    .count( );
+            m_connected   = false;
+            m_trackingRun = false;
+            m_sampleArrived.notify_all( );
+            m_eventArrived.notify_all( );
+            simulateEvent( elapi::ELApi::Event::CONNECTION_CLOSED );
+        }
+    }
+}
+
+void
+SimulatedGazeSource::deliverSample( const elapi::ELGazeSample& gazeSample )
+{
+    if ( auto* listener = m_sampleListener.load( ) ) {
+        listener->onGazeSample( gazeSample );
+    }
+    {
+        std::unique_lock< std::mutex > lock( m_sampleMutex );
+        m_lastSample = gazeSample;
+        m_sampleCount++;
+    }
+    m_sampleArrived.notify_all( );
+}
+
+void
+SimulatedGazeSource::runEvents( )
+{
+    std::unique_lock< std::mutex > lock( m_eventMutex );
+    while ( true ) {
+        m_eventArrived.wait( lock, [ this ] { return !m_eventQueue.empty( ) || !m_eventRun; } );
+        if ( !m_eventRun ) {
+            return;
+        }
+        const auto event = m_eventQueue.front( );
+        m_eventQueue.pop_front( );
+
+        lock.unlock( );
+        if ( auto* listener = m_eventListener.load( ) ) {
+            listener->onEvent( event );
+        }
+        lock.lock( );
+    }
+}
+
+bool
+SimulatedGazeSource::waitCalibrationPoints( int32 points )
+{
+    std::unique_lock< std::mutex > lock( m_calibrationMutex );
+    return !m_calibrationAbort.wait_for(
+        lock, std::chrono::milliseconds( points * m_config.calibrationPointMillis ),
+        [ this ] { return m_aborted; } );
+}
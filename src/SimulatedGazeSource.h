@@ -0,0 +1,160 @@
+// -----------------------------------------------------------------------
+// Copyright (C) 2019-2023, EyeLogic GmbH
+//
+// Permission is hereby granted, free of charge, to any person or
+// organization obtaining a copy of the software and accompanying
+// documentation covered by this license (the "Software") to use,
+// reproduce, display, distribute, execute, and transmit the Software,
+// and to prepare derivative works of the Software, and to permit
+// third-parties to whom the Software is furnished to do so.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, TITLE AND
+// NON-INFRINGEMENT. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR ANYONE
+// DISTRIBUTING THE SOFTWARE BE LIABLE FOR ANY DAMAGES OR OTHER
+// LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+// OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+// -----------------------------------------------------------------------
+
+
+#pragma once
+
+#include "GazeSource.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <random>
+#include <thread>
+
+namespace ellsl
+{
+struct SimulatorConfig {
+    uint64               deviceSerial = 0x00e15100;
+    std::vector< int32 > frameRates{ 30, 60, 120, 250, 500, 1000, 2000 };
+    std::vector< int32 > calibrationMethods{ 1, 2, 5, 9 };
+
+    /** @brief generate samples as fast as possible instead of at the tracking frame rate */
+    bool unthrottled = false;
+    /** @brief probability of a single sample without any valid eye data */
+    double dropoutProbability = 0.002;
+    /** @brief probability of a frame lost on its way to the client, its index is skipped */
+    double frameLossProbability = 0.0;
+    /** @brief mean interval between blinks [s], 0 disables blinks */
+    double blinkInterval = 4.0;
+    /** @brief offset [us] and drift [ppm] of the device clock relative to the system clock */
+    int64  clockOffsetMicroSec = 0;
+    double clockDriftPpm       = 0.0;
+    /** @brief the device disconnects for a second every interval [s], 0 disables */
+    double disconnectInterval = 0.0;
+    /**
+     * @brief the server closes the connection every interval [s] and refuses connects for three
+     * seconds, 0 disables
+     */
+    double connectionLossInterval = 0.0;
+    /** @brief duration of each calibration or validation point [ms] */
+    int32  calibrationPointMillis = 500;
+    uint32 seed                   = 1;
+    /** @brief number of servers announced by requestServerList, on 127.0.0.1 ports 0..n-1 */
+    int32 servers = 1;
+};
+
+/**
+ * @brief simulated EyeLogic device
+ *
+ * Generates fixations, saccades, blinks and dropouts on a 24" full HD screen at any of the
+ * configured frame rates and behaves like the ELApi otherwise: samples and events are delivered
+ * through the registered listeners (each on its own thread) and through the polling functions.
+ */
+class SimulatedGazeSource final : public GazeSource
+{
+public:
+    explicit SimulatedGazeSource( const SimulatorConfig& config = { } );
+    ~SimulatedGazeSource( ) override;
+
+    void registerEventListener( elapi::ELApi::ELEventCallback* callback ) override;
+    void registerGazeSampleListener( elapi::ELApi::ELGazeSampleCallback* callback ) override;
+
+    elapi::ELApi::ReturnConnect connect( ) override;
+    elapi::ELApi::ReturnConnect connectRemote( elapi::ELApi::ServerInfo server ) override;
+    int32 requestServerList( int32 blockingDurationMS, elapi::ELApi::ServerInfo* serverList,
+                             int32 serverListLength ) override;
+    void disconnect( ) override;
+    bool isConnected( ) const override;
+
+    void getActiveScreen( elapi::ELApi::ScreenConfig& screenConfig ) const override;
+    void getDeviceInfo( DeviceInfo& deviceInfo ) const override;
+
+    elapi::ELApi::ReturnNextData getNextEvent( elapi::ELApi::Event& event,
+                                               int32 timeoutMillis ) override;
+    elapi::ELApi::ReturnNextData getNextGazeSample( elapi::ELGazeSample& gazeSample,
+                                                    int32 timeoutMillis ) override;
+
+    elapi::ELApi::ReturnStart requestTracking( int32 frameRateModeInd ) override;
+    void unrequestTracking( ) override;
+
+    elapi::ELApi::ReturnCalibrate calibrate( int32 calibrationModeInd ) override;
+    void abortCalibValidation( ) override;
+    elapi::ELApi::ReturnValidate validate(
+        elapi::ELApi::ELValidationResult& validationResult ) override;
+
+    /** @brief emits an event as the device would, e.g. SCREEN_CHANGED */
+    void simulateEvent( elapi::ELApi::Event event );
+
+private:
+    class GazeModel;
+
+    void startTracking( int32 samplerate );
+    void stopTracking( );
+    void runTracking( int32 samplerate );
+    void deliverSample( const elapi::ELGazeSample& gazeSample );
+    void runEvents( );
+    bool waitCalibrationPoints( int32 points );
+
+    const SimulatorConfig      m_config;
+    elapi::ELApi::ScreenConfig m_screenConfig;
+
+    std::atomic< elapi::ELApi::ELEventCallback* >      m_eventListener{ nullptr };
+    std::atomic< elapi::ELApi::ELGazeSampleCallback* > m_sampleListener{ nullptr };
+    std::atomic< bool >                                m_connected{ false };
+    std::atomic< bool >                                m_deviceMissing{ false };
+    // steady clock time until which connects are refused
+    std::atomic< std::chrono::steady_clock::rep > m_serverOutageEnd{ 0 };
+
+    // tracking thread, generates the samples
+    std::mutex          m_trackingMutex;
+    int32               m_samplerate = 0;
+    std::atomic< bool > m_trackingRun{ false };
+    std::thread         m_tracking;
+    int32               m_nextIndex = 0;
+
+    // last sample for getNextGazeSample( )
+    std::mutex              m_sampleMutex;
+    std::condition_variable m_sampleArrived;
+    elapi::ELGazeSample     m_lastSample{ };
+    uint64                  m_sampleCount = 0;
+    uint64                  m_samplesRead = 0;
+
+    // event queue for the listener thread and last event for getNextEvent( )
+    std::mutex                        m_eventMutex;
+    std::condition_variable           m_eventArrived;
+    std::deque< elapi::ELApi::Event > m_eventQueue;
+    elapi::ELApi::Event               m_lastEvent = elapi::ELApi::Event::TRACKING_STOPPED;
+    uint64                            m_eventCount = 0;
+    uint64                            m_eventsRead = 0;
+    bool                              m_eventRun   = true;
+    std::thread                       m_events;
+
+    // calibration and validation
+    std::mutex              m_calibrationMutex;
+    std::condition_variable m_calibrationAbort;
+    bool                    m_calibrating = false;
+    bool                    m_aborted     = false;
+    bool                    m_calibrated  = false;
+};
+
+}  // namespace ellsl
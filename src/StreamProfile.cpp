@@ -0,0 +1,141 @@
+// -----------------------------------------------------------------------
+// Copyright (C) 2019-2023, EyeLogic GmbH
+//
+// Permission is hereby granted, free of charge, to any person or
+// organization obtaining a copy of the software and accompanying
+// documentation covered by this license (the "Software") to use,
+// reproduce, display, distribute, execute, and transmit the Software,
+// and to prepare derivative works of the Software, and to permit
+// third-parties to whom the Software is furnished to do so.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, TITLE AND
+// NON-INFRINGEMENT. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR ANYONE
+// DISTRIBUTING THE SOFTWARE BE LIABLE FOR ANY DAMAGES OR OTHER
+// LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+// OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+// -----------------------------------------------------------------------
+
+
+#include "StreamProfile.h"
+
+namespace
+{
+using namespace ellsl;
+
+const std::pair< const char*, ChannelSelection > SELECTION_NAMES[] = {
+    { "full", ChannelSelection::FULL },
+    { "por", ChannelSelection::POR },
+    { "filtered", ChannelSelection::FILTERED },
+    { "eyes", ChannelSelection::EYES },
+};
+
+const std::pair< const char*, ValueFormat > FORMAT_NAMES[] = {
+    { "float32", ValueFormat::FLOAT32 },
+    { "double64", ValueFormat::DOUBLE64 },
+};
+
+template< typename Enum, size_t N >
+bool
+fromName( const std::pair< const char*, Enum > ( &names )[ N ], const std::string& name,
+          Enum& value )
+{
+    for ( auto& entry : names ) {
+        if ( name == entry.first ) {
+            value = entry.second;
+            return true;
+        }
+    }
+    return false;
+}
+
+template< typename Enum, size_t N >
+std::string
+toName( const std::pair< const char*, Enum > ( &names )[ N ], Enum value )
+{
+    for ( auto& entry : names ) {
+        if ( value == entry.second ) {
+            return entry.first;
+        }
+    }
+    return "";
+}
+
+template< typename Enum, size_t N >
+std::string
+listNames( const std::pair< const char*, Enum > ( &names )[ N ] )
+{
+    std::string list;
+    for ( auto& entry : names ) {
+        list += ( list.empty( ) ? "" : ", " ) + std::string( entry.first );
+    }
+    return list;
+}
+}  // namespace
+
+int32
+ellsl::channelCount( ChannelSelection selection )
+{
+    switch ( selection ) {
+        case ChannelSelection::POR:
+            return channelCount( ChannelSet< ChannelSelection::POR >::Channels{ } );
+        case ChannelSelection::FILTERED:
+            return channelCount( ChannelSet< ChannelSelection::FILTERED >::Channels{ } );
+        case ChannelSelection::EYES:
+            return channelCount( ChannelSet< ChannelSelection::EYES >::Channels{ } );
+        case ChannelSelection::FULL:
+        default:
+            return channelCount( ChannelSet< ChannelSelection::FULL >::Channels{ } );
+    }
+}
+
+int32
+ellsl::channelIndices( ChannelSelection selection, int32* indices )
+{
+    switch ( selection ) {
+        case ChannelSelection::POR:
+            channelIndices( indices, ChannelSet< ChannelSelection::POR >::Channels{ } );
+            break;
+        case ChannelSelection::FILTERED:
+            channelIndices( indices, ChannelSet< ChannelSelection::FILTERED >::Channels{ } );
+            break;
+        case ChannelSelection::EYES:
+            channelIndices( indices, ChannelSet< ChannelSelection::EYES >::Channels{ } );
+            break;
+        case ChannelSelection::FULL:
+        default:
+            channelIndices( indices, ChannelSet< ChannelSelection::FULL >::Channels{ } );
+            break;
+    }
+    return channelCount( selection );
+}
+
+bool
+ellsl::parseStreamProfile( const std::string& text, StreamProfile& profile )
+{
+    StreamProfile parsed;
+    const size_t  colon = text.find( ':' );
+    if ( !fromName( SELECTION_NAMES, text.substr( 0, colon ), parsed.channels ) ) {
+        return false;
+    }
+    if ( colon != std::string::npos &&
+         !fromName( FORMAT_NAMES, text.substr( colon + 1 ), parsed.format ) ) {
+        return false;
+    }
+    profile = parsed;
+    return true;
+}
+
+std::string
+ellsl::toString( const StreamProfile& profile )
+{
+    return toName( SELECTION_NAMES, profile.channels ) + ":" + toName( FORMAT_NAMES, profile.format );
+}
+
+std::string
+ellsl::availableStreamProfiles( )
+{
+    return "channels: " + listNames( SELECTION_NAMES ) + " - formats: " + listNames( FORMAT_NAMES );
+}
@@ -0,0 +1,225 @@
+// -----------------------------------------------------------------------
+// Copyright (C) 2019-2023, EyeLogic GmbH
+//
+// Permission is hereby granted, free of charge, to any person or
+// organization obtaining a copy of the software and accompanying
+// documentation covered by this license (the "Software") to use,
+// reproduce, display, distribute, execute, and transmit the Software,
+// and to prepare derivative works of the Software, and to permit
+// third-parties to whom the Software is furnished to do so.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, TITLE AND
+// NON-INFRINGEMENT. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR ANYONE
+// DISTRIBUTING THE SOFTWARE BE LIABLE FOR ANY DAMAGES OR OTHER
+// LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+// OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+// -----------------------------------------------------------------------
+
+#pragma once
+
+#include <cstdint>
+
+using int32  = int32_t;
+using int64  = int64_t;
+using uint32 = uint32_t;
+using uint64 = uint64_t;
+
+#include "elapi/ELGazeSample.h"
+#include "lsl_cpp.h"
+
+#include <cstddef>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <utility>
+
+namespace ellsl
+{
+/** @brief number of channels the EyeLogic gaze stream can carry */
+constexpr int32 NCHANNELS = 17;
+
+/** @brief XML meta-data of a channel, nullptr entries are omitted */
+struct ChannelInfo {
+    const char* label;
+    const char* eye;
+    const char* type;
+    const char* unit;
+    const char* coordinateSystem;
+};
+
+// clang-format off
+constexpr ChannelInfo CHANNEL_INFO[ NCHANNELS ] = {
+    { "FrameNumber",         nullptr, "FrameNumber", "number",      nullptr },
+    { "Screen_X_raw",        "both",  "ScreenX",     "pixels",      "image-space" },
+    { "Screen_Y_raw",        "both",  "ScreenY",     "pixels",      "image-space" },
+    { "Screen_X_filtered",   "both",  "ScreenX",     "pixels",      "image-space" },
+    { "Screen_Y_filtered",   "both",  "ScreenY",     "pixels",      "image-space" },
+    { "Screen_X_left",       "left",  "ScreenX",     "pixels",      "image-space" },
+    { "Screen_Y_left",       "left",  "ScreenY",     "pixels",      "image-space" },
+    { "Screen_X_right",      "right", "ScreenX",     "pixels",      "image-space" },
+    { "Screen_Y_right",      "right", "ScreenY",     "pixels",      "image-space" },
+    { "Diameter_left",       "left",  "Diameter",    "millimeters", nullptr },
+    { "Diameter_right",      "right", "Diameter",    "millimeters", nullptr },
+    { "EyePosition_X_left",  "left",  "PositionX",   "millimeters", "world-space" },
+    { "EyePosition_Y_left",  "left",  "PositionY",   "millimeters", "world-space" },
+    { "EyePosition_Z_left",  "left",  "PositionZ",   "millimeters", "world-space" },
+    { "EyePosition_X_right", "right", "PositionX",   "millimeters", "world-space" },
+    { "EyePosition_Y_right", "right", "PositionY",   "millimeters", "world-space" },
+    { "EyePosition_Z_right", "right", "PositionZ",   "millimeters", "world-space" },
+};
+
+// byte offset of the source field of every channel within ELGazeSample - all fields are doubles
+// except the int32 index of the FrameNumber channel 0
+constexpr size_t CHANNEL_OFFSET[ NCHANNELS ] = {
+    offsetof( elapi::ELGazeSample, index ),
+    offsetof( elapi::ELGazeSample, porRawX ),
+    offsetof( elapi::ELGazeSample, porRawY ),
+    offsetof( elapi::ELGazeSample, porFilteredX ),
+    offsetof( elapi::ELGazeSample, porFilteredY ),
+    offsetof( elapi::ELGazeSample, porLeftX ),
+    offsetof( elapi::ELGazeSample, porLeftY ),
+    offsetof( elapi::ELGazeSample, porRightX ),
+    offsetof( elapi::ELGazeSample, porRightY ),
+    offsetof( elapi::ELGazeSample, pupilRadiusLeft ),
+    offsetof( elapi::ELGazeSample, pupilRadiusRight ),
+    offsetof( elapi::ELGazeSample, eyePositionLeftX ),
+    offsetof( elapi::ELGazeSample, eyePositionLeftY ),
+    offsetof( elapi::ELGazeSample, eyePositionLeftZ ),
+    offsetof( elapi::ELGazeSample, eyePositionRightX ),
+    offsetof( elapi::ELGazeSample, eyePositionRightY ),
+    offsetof( elapi::ELGazeSample, eyePositionRightZ ),
+};
+// clang-format on
+
+/** @brief subset of channels published by the gaze outlet */
+enum class ChannelSelection {
+    /** @brief all NCHANNELS channels */
+    FULL,
+    /** @brief frame number, raw and filtered binocular POR */
+    POR,
+    /** @brief frame number and filtered binocular POR */
+    FILTERED,
+    /** @brief frame number, monocular POR and pupil of both eyes */
+    EYES,
+};
+
+/** @brief value type of the gaze outlet */
+enum class ValueFormat {
+    FLOAT32,  // frame numbers are exact up to FLOAT32_EXACT_INDEX only
+    DOUBLE64,
+};
+
+/** @brief largest frame number a float32 stream holds exactly, 2^24 - about 4.6 h at 1000 Hz */
+constexpr int64 FLOAT32_EXACT_INDEX = int64( 1 ) << 24;
+
+/** @brief layout of the gaze outlet */
+struct StreamProfile {
+    ChannelSelection channels = ChannelSelection::FULL;
+    ValueFormat      format   = ValueFormat::DOUBLE64;
+
+    bool operator==( const StreamProfile& other ) const
+    {
+        return channels == other.channels && format == other.format;
+    }
+    bool operator!=( const StreamProfile& other ) const { return !( *this == other ); }
+};
+
+template< ChannelSelection Selection >
+struct ChannelSet;
+
+template<>
+struct ChannelSet< ChannelSelection::FULL > {
+    using Channels = std::make_integer_sequence< int32, NCHANNELS >;
+};
+template<>
+struct ChannelSet< ChannelSelection::POR > {
+    using Channels = std::integer_sequence< int32, 0, 1, 2, 3, 4 >;
+};
+template<>
+struct ChannelSet< ChannelSelection::FILTERED > {
+    using Channels = std::integer_sequence< int32, 0, 3, 4 >;
+};
+template<>
+struct ChannelSet< ChannelSelection::EYES > {
+    using Channels = std::integer_sequence< int32, 0, 5, 6, 7, 8, 9, 10 >;
+};
+
+/** @brief reads the source field of a channel */
+template< int32 Channel >
+inline double
+loadChannel( const elapi::ELGazeSample& gazeSample )
+{
+    if constexpr ( Channel == 0 ) {
+        return gazeSample.index;
+    } else {
+        double value;
+        std::memcpy( &value,
+                     reinterpret_cast< const char* >( &gazeSample ) + CHANNEL_OFFSET[ Channel ],
+                     sizeof( value ) );
+        return value;
+    }
+}
+
+/** @brief converts a single channel, ELInvalidValue becomes NaN */
+template< int32 Channel >
+inline double
+channelValue( const elapi::ELGazeSample& gazeSample )
+{
+    const double value = loadChannel< Channel >( gazeSample );
+    return value == elapi::ELInvalidValue ? std::numeric_limits< double >::quiet_NaN( ) : value;
+}
+
+template< typename Value, int32... Channels >
+inline void
+convertChannels( const elapi::ELGazeSample& gazeSample, Value* sample,
+                 std::integer_sequence< int32, Channels... > )
+{
+    int32 i = 0;
+    ( ( sample[ i++ ] = static_cast< Value >( channelValue< Channels >( gazeSample ) ) ), ... );
+}
+
+/**
+ * @brief converts exactly the channels of the selection - dropped fields are never read
+ *
+ * Scalar reference of the vectorized convertBatch( ) in ConversionKernel.h.
+ */
+template< typename Value, ChannelSelection Selection >
+inline void
+convertSample( const elapi::ELGazeSample& gazeSample, Value* sample )
+{
+    convertChannels< Value >( gazeSample, sample, typename ChannelSet< Selection >::Channels{ } );
+}
+
+template< int32... Channels >
+constexpr int32
+channelCount( std::integer_sequence< int32, Channels... > )
+{
+    return sizeof...( Channels );
+}
+
+template< int32... Channels >
+inline void
+channelIndices( int32* indices, std::integer_sequence< int32, Channels... > )
+{
+    int32 i = 0;
+    ( ( indices[ i++ ] = Channels ), ... );
+}
+
+/** @brief number of channels of the selection */
+int32 channelCount( ChannelSelection selection );
+
+/** @brief writes the channel indices of the selection, indices must hold NCHANNELS entries */
+int32 channelIndices( ChannelSelection selection, int32* indices );
+
+/** @brief parses "<channels>[:<format>]", e.g. "filtered:float32" */
+bool parseStreamProfile( const std::string& text, StreamProfile& profile );
+
+std::string toString( const StreamProfile& profile );
+
+/** @brief names of all channel selections and value formats for help messages */
+std::string availableStreamProfiles( );
+
+}  // namespace ellsl
@@ -0,0 +1,101 @@
+// -----------------------------------------------------------------------
+// Copyright (C) 2019-2023, EyeLogic GmbH
+//
+// Permission is hereby granted, free of charge, to any person or
+// organization obtaining a copy of the software and accompanying
+// documentation covered by this license (the "Software") to use,
+// reproduce, display, distribute, execute, and transmit the Software,
+// and to prepare derivative works of the Software, and to permit
+// third-parties to whom the Software is furnished to do so.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, TITLE AND
+// NON-INFRINGEMENT. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR ANYONE
+// DISTRIBUTING THE SOFTWARE BE LIABLE FOR ANY DAMAGES OR OTHER
+// LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+// OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+// -----------------------------------------------------------------------
+
+
+#include "ThreadConfig.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+using namespace ellsl;
+
+bool
+ellsl::configureCurrentThread( const ThreadConfig& config )
+{
+    bool success = true;
+#ifdef _WIN32
+    if ( config.priority != ThreadPriority::NORMAL ) {
+        const int priority = config.priority == ThreadPriority::REALTIME
+                                 ? THREAD_PRIORITY_TIME_CRITICAL
+                                 : THREAD_PRIORITY_HIGHEST;
+        success &= SetThreadPriority( GetCurrentThread( ), priority ) != 0;
+    }
+    if ( config.cpu >= 0 ) {
+        const DWORD_PTR mask = DWORD_PTR( 1 ) << config.cpu;
+        success &= config.cpu < static_cast< int32 >( sizeof( mask ) * 8 ) &&
+                   SetThreadAffinityMask( GetCurrentThread( ), mask ) != 0;
+    }
+#else
+    if ( config.priority != ThreadPriority::NORMAL ) {
+        const int   minimum = sched_get_priority_min( SCHED_FIFO );
+        const int   maximum = sched_get_priority_max( SCHED_FIFO );
+        sched_param param{ };
+        param.sched_priority =
+            config.priority == ThreadPriority::REALTIME ? maximum : ( minimum + maximum ) / 2;
+        success &= pthread_setschedparam( pthread_self( ), SCHED_FIFO, &param ) == 0;
+    }
+    if ( config.cpu >= 0 ) {
+#ifdef __linux__
+        cpu_set_t cpus;
+        CPU_ZERO( &cpus );
+        CPU_SET( config.cpu, &cpus );
+        success &= pthread_setaffinity_np( pthread_self( ), sizeof( cpus ), &cpus ) == 0;
+#else
+        success = false;
+#endif
+    }
+#endif
+    return success;
+}
+
+bool
+ellsl::parseThreadPriority( const std::string& text, ThreadPriority& priority )
+{
+    if ( text == "normal" ) {
+        priority = ThreadPriority::NORMAL;
+    } else if ( text == "high" ) {
+        priority = ThreadPriority::HIGH;
+    } else if ( text == "realtime" ) {
+        priority = ThreadPriority::REALTIME;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+std::string
+ellsl::toString( ThreadPriority priority )
+{
+    switch ( priority ) {
+        case ThreadPriority::HIGH:
+            return "high";
+        case ThreadPriority::REALTIME:
+            return "realtime";
+        case ThreadPriority::NORMAL:
+        default:
+            return "normal";
+    }
+}
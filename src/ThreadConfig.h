@@ -0,0 +1,55 @@
+// -----------------------------------------------------------------------
+// Copyright (C) 2019-2023, EyeLogic GmbH
+//
+// Permission is hereby granted, free of charge, to any person or
+// organization obtaining a copy of the software and accompanying
+// documentation covered by this license (the "Software") to use,
+// reproduce, display, distribute, execute, and transmit the Software,
+// and to prepare derivative works of the Software, and to permit
+// third-parties to whom the Software is furnished to do so.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, TITLE AND
+// NON-INFRINGEMENT. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR ANYONE
+// DISTRIBUTING THE SOFTWARE BE LIABLE FOR ANY DAMAGES OR OTHER
+// LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+// OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+// -----------------------------------------------------------------------
+
+
+#pragma once
+
+#include <cstdint>
+
+using int32  = int32_t;
+using int64  = int64_t;
+using uint32 = uint32_t;
+using uint64 = uint64_t;
+
+#include <string>
+
+namespace ellsl
+{
+enum class ThreadPriority {
+    NORMAL,
+    HIGH,
+    /** @brief time-critical (Windows) or SCHED_FIFO (POSIX), may require elevated privileges */
+    REALTIME,
+};
+
+/** @brief scheduling of a thread owned by the LSL client */
+struct ThreadConfig {
+    ThreadPriority priority = ThreadPriority::NORMAL;
+    /** @brief core the thread is pinned to, -1 for no pinning */
+    int32 cpu = -1;
+};
+
+/** @brief applies the configuration to the calling thread, returns false if any part failed */
+bool configureCurrentThread( const ThreadConfig& config );
+
+bool        parseThreadPriority( const std::string& text, ThreadPriority& priority );
+std::string toString( ThreadPriority priority );
+
+}  // namespace ellsl
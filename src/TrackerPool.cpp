@@ -0,0 +1,145 @@
+// -----------------------------------------------------------------------
+// Copyright (C) 2019-2023, EyeLogic GmbH
+//
+// Permission is hereby granted, free of charge, to any person or
+// organization obtaining a copy of the software and accompanying
+// documentation covered by this license (the "Software") to use,
+// reproduce, display, distribute, execute, and transmit the Software,
+// and to prepare derivative works of the Software, and to permit
+// third-parties to whom the Software is furnished to do so.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, TITLE AND
+// NON-INFRINGEMENT. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR ANYONE
+// DISTRIBUTING THE SOFTWARE BE LIABLE FOR ANY DAMAGES OR OTHER
+// LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+// OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+// -----------------------------------------------------------------------
+
+
+#include "TrackerPool.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+using namespace ellsl;
+
+namespace
+{
+bool
+sameServer( const elapi::ELApi::ServerInfo& a, const elapi::ELApi::ServerInfo& b )
+{
+    return a.port == b.port && std::strncmp( a.ip, b.ip, sizeof( a.ip ) ) == 0;
+}
+
+}  // namespace
+
+TrackerPool::TrackerPool( SourceFactory factory, std::shared_ptr< GazeSource > discovery )
+    : m_factory( std::move( factory ) ), m_discovery( std::move( discovery ) )
+{
+}
+
+TrackerPool::~TrackerPool( )
+{
+    std::map< int32, Entry > trackers;
+    {
+        std::unique_lock< std::mutex > lock( m_mutex );
+        trackers.swap( m_trackers );
+    }
+    // the clients join their threads on destruction
+    trackers.clear( );
+}
+
+std::vector< elapi::ELApi::ServerInfo >
+TrackerPool::discover( int32 timeoutMillis )
+{
+    std::vector< elapi::ELApi::ServerInfo > servers( MAX_SERVERS );
+    const int32                             count =
+        m_discovery->requestServerList( timeoutMillis, servers.data( ), MAX_SERVERS );
+    servers.resize( static_cast< size_t >( std::max( count, 0 ) ) );
+    return servers;
+}
+
+elapi::ELApi::ReturnConnect
+TrackerPool::attach( const elapi::ELApi::ServerInfo& server, const ClientSettings& settings,
+                     int32& id )
+{
+    // connecting blocks until the server responds - the list stays available meanwhile
+    auto client = std::make_shared< LSLClient >( m_factory( server ) );
+    client->setDeviceStreamNames( true );
+    client->setStreamProfile( settings.profile );
+    client->setGazeFilter( settings.filter );
+    client->setDecimatedRates( settings.decimatedRates );
+    client->setVisualAngles( settings.visualAngles, settings.trackerGeometry );
+    if ( !settings.reconnect ) {
+        client->setReconnect( std::chrono::milliseconds( 0 ), std::chrono::milliseconds( 0 ) );
+    }
+    client->setChunking( settings.chunkSamples, settings.chunkMicroSec );
+    client->setGapFilling( settings.fillGaps );
+    client->setIdleGrace( settings.idleGrace );
+    client->setEventDetection( settings.detectEvents, settings.detectorConfig );
+    client->setAcquisition( settings.acquisition, settings.readerConfig );
+
+    const auto retConnect = client->connectRemote( server );
+    if ( retConnect != elapi::ELApi::ReturnConnect::SUCCESS ) {
+        return retConnect;
+    }
+
+    std::unique_lock< std::mutex > lock( m_mutex );
+    id = m_nextId++;
+    m_trackers.emplace( id, Entry{ server, std::move( client ) } );
+    return retConnect;
+}
+
+bool
+TrackerPool::detach( int32 id )
+{
+    std::shared_ptr< LSLClient > client;
+    {
+        std::unique_lock< std::mutex > lock( m_mutex );
+        const auto                     it = m_trackers.find( id );
+        if ( it == m_trackers.end( ) ) {
+            return false;
+        }
+        client = std::move( it->second.client );
+        m_trackers.erase( it );
+    }
+    client->closeStream( );
+    return true;
+}
+
+int32
+TrackerPool::find( const elapi::ELApi::ServerInfo& server ) const
+{
+    std::unique_lock< std::mutex > lock( m_mutex );
+    for ( const auto& tracker : m_trackers ) {
+        if ( sameServer( tracker.second.server, server ) ) {
+            return tracker.first;
+        }
+    }
+    return 0;
+}
+
+std::vector< TrackerPool::Tracker >
+TrackerPool::trackers( ) const
+{
+    std::vector< Tracker >         result;
+    std::unique_lock< std::mutex > lock( m_mutex );
+    for ( const auto& tracker : m_trackers ) {
+        const LSLClient& client = *tracker.second.client;
+        result.push_back( { tracker.first, tracker.second.server, client.deviceSerial( ),
+                            client.isConnected( ), client.isStreaming( ) } );
+    }
+    return result;
+}
+
+std::shared_ptr< LSLClient >
+TrackerPool::client( int32 id ) const
+{
+    std::unique_lock< std::mutex > lock( m_mutex );
+    const auto                     it = m_trackers.find( id );
+    return it == m_trackers.end( ) ? nullptr : it->second.client;
+}
@@ -0,0 +1,125 @@
+// -----------------------------------------------------------------------
+// Copyright (C) 2019-2023, EyeLogic GmbH
+//
+// Permission is hereby granted, free of charge, to any person or
+// organization obtaining a copy of the software and accompanying
+// documentation covered by this license (the "Software") to use,
+// reproduce, display, distribute, execute, and transmit the Software,
+// and to prepare derivative works of the Software, and to permit
+// third-parties to whom the Software is furnished to do so.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, TITLE AND
+// NON-INFRINGEMENT. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR ANYONE
+// DISTRIBUTING THE SOFTWARE BE LIABLE FOR ANY DAMAGES OR OTHER
+// LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+// OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+// -----------------------------------------------------------------------
+
+
+#pragma once
+
+#include <cstdint>
+
+using int32  = int32_t;
+using int64  = int64_t;
+using uint32 = uint32_t;
+using uint64 = uint64_t;
+
+#include "GazeSource.h"
+#include "LSLClient.h"
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace ellsl
+{
+/**
+ * @brief runs one LSL client per attached EyeLogic server
+ *
+ * Every tracker owns its gaze source, sample ring, acquisition and publisher threads and outlet
+ * ("EyeLogic_<serial>"), so the sample path of one tracker never contends with another. The pool
+ * mutex only guards the tracker list and is not taken while streaming.
+ */
+class TrackerPool
+{
+public:
+    /** @brief creates the unconnected gaze source of a tracker on the given server */
+    using SourceFactory =
+        std::function< std::shared_ptr< GazeSource >( const elapi::ELApi::ServerInfo& ) >;
+
+    /** @brief settings every attached client starts with */
+    struct ClientSettings {
+        StreamProfile             profile;
+        FilterConfig              filter;
+        std::vector< int32 >      decimatedRates;
+        bool                      visualAngles = false;
+        TrackerGeometry           trackerGeometry;
+        int32                     chunkSamples  = 1;
+        int64                     chunkMicroSec = 0;
+        LSLClient::Acquisition    acquisition   = LSLClient::Acquisition::LISTENER;
+        ThreadConfig              readerConfig;
+        bool                      fillGaps  = false;
+        bool                      reconnect = true;
+        std::chrono::milliseconds idleGrace{ 0 };
+        bool                      detectEvents = false;
+        EventDetector::Config     detectorConfig;
+    };
+
+    struct Tracker {
+        int32                    id;
+        elapi::ELApi::ServerInfo server;
+        uint64                   deviceSerial;
+        bool                     connected;
+        bool                     streaming;
+    };
+
+    /** @brief maximum number of servers reported by discover( ) */
+    static constexpr int32 MAX_SERVERS = 32;
+
+    /** @param discovery source used to ping the servers in the local network */
+    TrackerPool( SourceFactory factory, std::shared_ptr< GazeSource > discovery );
+    ~TrackerPool( );
+
+    TrackerPool( const TrackerPool& ) = delete;
+    TrackerPool& operator=( const TrackerPool& ) = delete;
+
+    /** @brief servers responding within 'timeoutMillis' */
+    std::vector< elapi::ELApi::ServerInfo > discover( int32 timeoutMillis );
+
+    /**
+     * @brief connects a new client to 'server', tracking is started through the client
+     * @param id of the new tracker on success
+     */
+    elapi::ELApi::ReturnConnect attach( const elapi::ELApi::ServerInfo& server,
+                                        const ClientSettings& settings, int32& id );
+    /** @brief closes the stream and disconnects, false if there is no such tracker */
+    bool detach( int32 id );
+
+    /** @brief id of the tracker attached to 'server', 0 if none */
+    int32 find( const elapi::ELApi::ServerInfo& server ) const;
+
+    std::vector< Tracker > trackers( ) const;
+    /** @brief client of the tracker, nullptr if there is no such tracker */
+    std::shared_ptr< LSLClient > client( int32 id ) const;
+
+private:
+    struct Entry {
+        elapi::ELApi::ServerInfo     server;
+        std::shared_ptr< LSLClient > client;
+    };
+
+    const SourceFactory                 m_factory;
+    const std::shared_ptr< GazeSource > m_discovery;
+
+    mutable std::mutex       m_mutex;
+    std::map< int32, Entry >  m_trackers;
+    int32                     m_nextId = 1;
+};
+
+}  // namespace ellsl
@@ -0,0 +1,96 @@
+// -----------------------------------------------------------------------
+// Copyright (C) 2019-2023, EyeLogic GmbH
+//
+// Permission is hereby granted, free of charge, to any person or
+// organization obtaining a copy of the software and accompanying
+// documentation covered by this license (the "Software") to use,
+// reproduce, display, distribute, execute, and transmit the Software,
+// and to prepare derivative works of the Software, and to permit
+// third-parties to whom the Software is furnished to do so.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, TITLE AND
+// NON-INFRINGEMENT. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR ANYONE
+// DISTRIBUTING THE SOFTWARE BE LIABLE FOR ANY DAMAGES OR OTHER
+// LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+// OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+// -----------------------------------------------------------------------
+
+
+#include "ValidationOutlet.h"
+
+#include <limits>
+
+using namespace ellsl;
+
+namespace
+{
+lsl::stream_info
+makeValidationStreamInfo( uint64 deviceSerial, const std::string& name )
+{
+    lsl::stream_info lslInfo( name, "Validation", ValidationOutlet::NCHANNELS, lsl::IRREGULAR_RATE,
+                              lsl::cf_double64,
+                              "EyeLogic One | " + std::to_string( deviceSerial ) +
+                                  " | validation" );
+
+    lsl::xml_element channels = lslInfo.desc( ).append_child( "channels" );
+    const auto       append   = [ &channels ]( const char* label, const char* eye,
+                                         const char* unit ) {
+        lsl::xml_element channel = channels.append_child( "channel" );
+        channel.append_child_value( "label", label );
+        if ( eye ) {
+            channel.append_child_value( "eye", eye );
+        }
+        channel.append_child_value( "unit", unit );
+    };
+    append( "Point", nullptr, "number" );
+    append( "Stimulus_X", nullptr, "pixels" );
+    append( "Stimulus_Y", nullptr, "pixels" );
+    append( "Deviation_left_px", "left", "pixels" );
+    append( "Deviation_left_deg", "left", "degrees" );
+    append( "Deviation_right_px", "right", "pixels" );
+    append( "Deviation_right_deg", "right", "degrees" );
+
+    lslInfo.desc( )
+        .append_child( "acquisition" )
+        .append_child_value( "manufacturer", "EyeLogic" )
+        .append_child_value( "model", "One" )
+        .append_child_value( "serial number", std::to_string( deviceSerial ) );
+    return lslInfo;
+}
+
+double
+valid( double value )
+{
+    return value == elapi::ELInvalidValue ? std::numeric_limits< double >::quiet_NaN( ) : value;
+}
+}  // namespace
+
+ValidationOutlet::ValidationOutlet( uint64 deviceSerial, const std::string& name )
+    : m_deviceSerial( deviceSerial ), m_outlet( makeValidationStreamInfo( deviceSerial, name ) )
+{
+}
+
+void
+ValidationOutlet::publish( const elapi::ELApi::ELValidationResult& result, double timestamp )
+{
+    const int32 npoints = sizeof( result.pointsData ) / sizeof( result.pointsData[ 0 ] );
+    for ( int32 i = 0; i < npoints; i++ ) {
+        const auto&  point               = result.pointsData[ i ];
+        const double sample[ NCHANNELS ] = {
+            static_cast< double >( i ),         valid( point.validationPointPxX ),
+            valid( point.validationPointPxY ),  valid( point.meanDeviationLeftPx ),
+            valid( point.meanDeviationLeftDeg ), valid( point.meanDeviationRightPx ),
+            valid( point.meanDeviationRightDeg ),
+        };
+        m_outlet.push_sample( sample, timestamp );
+    }
+}
+
+uint64
+ValidationOutlet::deviceSerial( ) const
+{
+    return m_deviceSerial;
+}
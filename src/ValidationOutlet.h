@@ -0,0 +1,65 @@
+// -----------------------------------------------------------------------
+// Copyright (C) 2019-2023, EyeLogic GmbH
+//
+// Permission is hereby granted, free of charge, to any person or
+// organization obtaining a copy of the software and accompanying
+// documentation covered by this license (the "Software") to use,
+// reproduce, display, distribute, execute, and transmit the Software,
+// and to prepare derivative works of the Software, and to permit
+// third-parties to whom the Software is furnished to do so.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, TITLE AND
+// NON-INFRINGEMENT. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR ANYONE
+// DISTRIBUTING THE SOFTWARE BE LIABLE FOR ANY DAMAGES OR OTHER
+// LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+// OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+// -----------------------------------------------------------------------
+
+
+#pragma once
+
+#include <cstdint>
+
+using int32  = int32_t;
+using int64  = int64_t;
+using uint32 = uint32_t;
+using uint64 = uint64_t;
+
+#include "elapi/ELApi.h"
+#include "lsl_cpp.h"
+
+#include <string>
+
+namespace ellsl
+{
+/** @brief default name of the validation stream */
+constexpr char VALIDATION_STREAM_NAME[] = "EyeLogicValidation";
+
+/**
+ * @brief irregular-rate stream of validation results, one sample per validation point
+ *
+ * Channels: point number, stimulus position [px], and the mean deviation of the left and the
+ * right eye in [px] and [deg]. ELInvalidValue becomes NaN.
+ */
+class ValidationOutlet
+{
+public:
+    static constexpr int32 NCHANNELS = 7;
+
+    explicit ValidationOutlet( uint64             deviceSerial,
+                               const std::string& name = VALIDATION_STREAM_NAME );
+
+    /** @brief publishes all points of 'result' at the LSL time 'timestamp' */
+    void publish( const elapi::ELApi::ELValidationResult& result, double timestamp );
+
+    uint64 deviceSerial( ) const;
+
+private:
+    const uint64       m_deviceSerial;
+    lsl::stream_outlet m_outlet;
+};
+
+}  // namespace ellsl
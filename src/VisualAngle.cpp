@@ -0,0 +1,187 @@
+// -----------------------------------------------------------------------
+// Copyright (C) 2019-2023, EyeLogic GmbH
+//
+// Permission is hereby granted, free of charge, to any person or
+// organization obtaining a copy of the software and accompanying
+// documentation covered by this license (the "Software") to use,
+// reproduce, display, distribute, execute, and transmit the Software,
+// and to prepare derivative works of the Software, and to permit
+// third-parties to whom the Software is furnished to do so.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, TITLE AND
+// NON-INFRINGEMENT. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR ANYONE
+// DISTRIBUTING THE SOFTWARE BE LIABLE FOR ANY DAMAGES OR OTHER
+// LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+// OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+// -----------------------------------------------------------------------
+
+
+#include "VisualAngle.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <sstream>
+
+using namespace ellsl;
+
+namespace
+{
+constexpr double PI         = 3.14159265358979323846;
+constexpr double TO_DEGREES = 180.0 / PI;
+
+struct AngleChannel {
+    const char* label;
+    const char* eye;
+    const char* type;
+    const char* unit;
+};
+
+// clang-format off
+constexpr AngleChannel ANGLE_CHANNELS[ VisualAngle::CHANNELS ] = {
+    { "Azimuth_left",    "left",  "Azimuth",         "degrees" },
+    { "Elevation_left",  "left",  "Elevation",       "degrees" },
+    { "Azimuth_right",   "right", "Azimuth",         "degrees" },
+    { "Elevation_right", "right", "Elevation",       "degrees" },
+    { "PixelsPerDegree", "both",  "PixelsPerDegree", "pixels/degree" },
+};
+// clang-format on
+
+bool
+isValid( double value )
+{
+    return value != elapi::ELInvalidValue;
+}
+}  // namespace
+
+VisualAngle::VisualAngle( ) = default;
+
+void
+VisualAngle::setScreen( const elapi::ELApi::ScreenConfig& screen, const TrackerGeometry& geometry )
+{
+    m_valid = screen.resolutionX > 0 && screen.resolutionY > 0 &&
+              screen.physicalSizeX_mm > 0.0 && screen.physicalSizeY_mm > 0.0;
+    if ( !m_valid ) {
+        return;
+    }
+    // pixel rows grow downwards from the top edge, the screen is centered above the tracker - the
+    // mounting is measured to the upper front edge, the eye positions to the device center
+    const double mmPerPixelX = screen.physicalSizeX_mm / screen.resolutionX;
+    const double mmPerPixelY = screen.physicalSizeY_mm / screen.resolutionY;
+    m_scaleX                 = mmPerPixelX;
+    m_offsetX                = -0.5 * screen.physicalSizeX_mm;
+    m_scaleY                 = -mmPerPixelY;
+    m_offsetY = geometry.mmBelowScreen + 0.5 * geometry.mmHeight + screen.physicalSizeY_mm;
+    m_screenZ = 0.5 * geometry.mmDepth - geometry.mmTrackerInFrontOfScreen;
+    m_pixelsPerDegreeMM      = ( PI / 180.0 ) * 2.0 / ( mmPerPixelX + mmPerPixelY );
+}
+
+void
+VisualAngle::apply( const elapi::ELGazeSample& gazeSample, double* values ) const
+{
+    const double nan = std::numeric_limits< double >::quiet_NaN( );
+    for ( int32 i = 0; i < CHANNELS; i++ ) {
+        values[ i ] = nan;
+    }
+    if ( !m_valid ) {
+        return;
+    }
+
+    const bool left  = isValid( gazeSample.eyePositionLeftX );
+    const bool right = isValid( gazeSample.eyePositionRightX );
+    const struct {
+        bool   valid;
+        double porX, porY, eyeX, eyeY, eyeZ;
+    } eyes[ 2 ] = {
+        { left && isValid( gazeSample.porLeftX ), gazeSample.porLeftX, gazeSample.porLeftY,
+          gazeSample.eyePositionLeftX, gazeSample.eyePositionLeftY, gazeSample.eyePositionLeftZ },
+        { right && isValid( gazeSample.porRightX ), gazeSample.porRightX, gazeSample.porRightY,
+          gazeSample.eyePositionRightX, gazeSample.eyePositionRightY,
+          gazeSample.eyePositionRightZ },
+    };
+    for ( int32 i = 0; i < 2; i++ ) {
+        if ( !eyes[ i ].valid ) {
+            continue;
+        }
+        const double dx = std::fma( eyes[ i ].porX, m_scaleX, m_offsetX ) - eyes[ i ].eyeX;
+        const double dy = std::fma( eyes[ i ].porY, m_scaleY, m_offsetY ) - eyes[ i ].eyeY;
+        const double dz = m_screenZ - eyes[ i ].eyeZ;
+        values[ 2 * i ]     = std::atan2( dx, -dz ) * TO_DEGREES;
+        values[ 2 * i + 1 ] = std::atan2( dy, std::hypot( dx, dz ) ) * TO_DEGREES;
+    }
+
+    // viewing distance from the cyclopean eye to the binocular gaze point
+    if ( ( !left && !right ) || !isValid( gazeSample.porFilteredX ) ) {
+        return;
+    }
+    const double weight = left && right ? 0.5 : 1.0;
+    const double eyeX   = weight * ( ( left ? gazeSample.eyePositionLeftX : 0.0 ) +
+                                     ( right ? gazeSample.eyePositionRightX : 0.0 ) );
+    const double eyeY   = weight * ( ( left ? gazeSample.eyePositionLeftY : 0.0 ) +
+                                     ( right ? gazeSample.eyePositionRightY : 0.0 ) );
+    const double eyeZ   = weight * ( ( left ? gazeSample.eyePositionLeftZ : 0.0 ) +
+                                     ( right ? gazeSample.eyePositionRightZ : 0.0 ) );
+    const double dx       = std::fma( gazeSample.porFilteredX, m_scaleX, m_offsetX ) - eyeX;
+    const double dy       = std::fma( gazeSample.porFilteredY, m_scaleY, m_offsetY ) - eyeY;
+    const double dz       = m_screenZ - eyeZ;
+    const double distance = std::sqrt( std::fma( dx, dx, std::fma( dy, dy, dz * dz ) ) );
+    values[ 4 ]           = distance * m_pixelsPerDegreeMM;
+}
+
+bool
+ellsl::parseTrackerGeometry( const std::string& text, TrackerGeometry& geometry )
+{
+    std::istringstream stream( text );
+    double             values[ 4 ];
+    for ( int32 i = 0; i < 4; i++ ) {
+        std::string value;
+        if ( !std::getline( stream, value, i < 3 ? ':' : '\n' ) || value.empty( ) ) {
+            return false;
+        }
+        char* end;
+        values[ i ] = std::strtod( value.c_str( ), &end );
+        if ( *end != '\0' ) {
+            return false;
+        }
+    }
+    if ( stream.peek( ) != std::char_traits< char >::eof( ) || values[ 2 ] < 0.0 ||
+         values[ 3 ] < 0.0 ) {
+        return false;
+    }
+    geometry.mmBelowScreen            = values[ 0 ];
+    geometry.mmTrackerInFrontOfScreen = values[ 1 ];
+    geometry.mmHeight                 = values[ 2 ];
+    geometry.mmDepth                  = values[ 3 ];
+    return true;
+}
+
+void
+ellsl::describeAngleChannels( lsl::xml_element channels )
+{
+    for ( const AngleChannel& angle : ANGLE_CHANNELS ) {
+        lsl::xml_element channel = channels.append_child( "channel" );
+        channel.append_child_value( "label", angle.label );
+        channel.append_child_value( "eye", angle.eye );
+        channel.append_child_value( "type", angle.type );
+        channel.append_child_value( "unit", angle.unit );
+    }
+}
+
+void
+ellsl::describeAngles( const TrackerGeometry& geometry, lsl::xml_element desc )
+{
+    desc.append_child( "visual_angle" )
+        .append_child_value( "azimuth", "horizontal gaze angle, positive towards the right" )
+        .append_child_value( "elevation", "vertical gaze angle, positive upwards" )
+        .append_child_value( "pixels_per_degree",
+                             "at the filtered binocular POR, seen from between the eyes" )
+        .append_child_value( "mm_below_screen", std::to_string( geometry.mmBelowScreen ) )
+        .append_child_value( "mm_tracker_in_front_of_screen",
+                             std::to_string( geometry.mmTrackerInFrontOfScreen ) )
+        .append_child_value( "mm_tracker_height", std::to_string( geometry.mmHeight ) )
+        .append_child_value( "mm_tracker_depth", std::to_string( geometry.mmDepth ) )
+        .append_child_value( "origin", "center of the tracker" );
+}
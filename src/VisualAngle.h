@@ -0,0 +1,105 @@
+// -----------------------------------------------------------------------
+// Copyright (C) 2019-2023, EyeLogic GmbH
+//
+// Permission is hereby granted, free of charge, to any person or
+// organization obtaining a copy of the software and accompanying
+// documentation covered by this license (the "Software") to use,
+// reproduce, display, distribute, execute, and transmit the Software,
+// and to prepare derivative works of the Software, and to permit
+// third-parties to whom the Software is furnished to do so.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, TITLE AND
+// NON-INFRINGEMENT. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR ANYONE
+// DISTRIBUTING THE SOFTWARE BE LIABLE FOR ANY DAMAGES OR OTHER
+// LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+// OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+// -----------------------------------------------------------------------
+
+
+#pragma once
+
+#include <cstdint>
+
+using int32  = int32_t;
+using int64  = int64_t;
+using uint32 = uint32_t;
+using uint64 = uint64_t;
+
+#include "elapi/ELApi.h"
+#include "elapi/ELGazeSample.h"
+#include "lsl_cpp.h"
+
+#include <string>
+
+namespace ellsl
+{
+/**
+ * @brief mounting and size of the tracker, which is centered below the screen [mm]
+ *
+ * mmBelowScreen and mmTrackerInFrontOfScreen are the DeviceGeometry of the server, measured to
+ * the upper front edge of the tracker. Eye positions are relative to the center of the device,
+ * half its height below and half its depth behind that edge.
+ */
+struct TrackerGeometry {
+    double mmBelowScreen            = 0.0;
+    double mmTrackerInFrontOfScreen = 0.0;
+    double mmHeight                 = 0.0;
+    double mmDepth                  = 0.0;
+
+    bool operator==( const TrackerGeometry& other ) const
+    {
+        return mmBelowScreen == other.mmBelowScreen &&
+               mmTrackerInFrontOfScreen == other.mmTrackerInFrontOfScreen &&
+               mmHeight == other.mmHeight && mmDepth == other.mmDepth;
+    }
+    bool operator!=( const TrackerGeometry& other ) const { return !( *this == other ); }
+};
+
+/**
+ * @brief gaze direction of both eyes and the pixels per degree at the binocular gaze point
+ *
+ * Device coordinates [mm] as in ELGazeSample: origin at the center of the tracker, x towards the
+ * right, y upwards and z away from the screen. The screen constant part of the pixel to device
+ * transformation is computed by setScreen( ), a sample then only costs a few FMAs besides the
+ * trigonometry of the angles.
+ *
+ * Channels: azimuth and elevation of the left and the right eye [deg], positive towards the
+ * right and upwards, and pixels per degree. Invalid inputs, or an unknown screen size, give NaN.
+ */
+class VisualAngle
+{
+public:
+    static constexpr int32 CHANNELS = 5;
+
+    VisualAngle( );
+
+    void setScreen( const elapi::ELApi::ScreenConfig& screen, const TrackerGeometry& geometry );
+
+    /** @brief writes CHANNELS values */
+    void apply( const elapi::ELGazeSample& gazeSample, double* values ) const;
+
+private:
+    bool m_valid = false;
+    // screen position [mm] = scale * pixel + offset
+    double m_scaleX  = 0.0;
+    double m_offsetX = 0.0;
+    double m_scaleY  = 0.0;
+    double m_offsetY = 0.0;
+    double m_screenZ = 0.0;
+    // pixels per degree per mm of viewing distance
+    double m_pixelsPerDegreeMM = 0.0;
+};
+
+/** @brief parses "<mm below screen>:<mm tracker in front of screen>:<mm height>:<mm depth>" */
+bool parseTrackerGeometry( const std::string& text, TrackerGeometry& geometry );
+
+/** @brief appends the visual angle channels to 'channels' */
+void describeAngleChannels( lsl::xml_element channels );
+
+/** @brief appends the geometry and conventions of the visual angles to the stream meta-data */
+void describeAngles( const TrackerGeometry& geometry, lsl::xml_element desc );
+
+}  // namespace ellsl
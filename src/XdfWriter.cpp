@@ -0,0 +1,355 @@
+// -----------------------------------------------------------------------
+// Copyright (C) 2019-2023, EyeLogic GmbH
+//
+// Permission is hereby granted, free of charge, to any person or
+// organization obtaining a copy of the software and accompanying
+// documentation covered by this license (the "Software") to use,
+// reproduce, display, distribute, execute, and transmit the Software,
+// and to prepare derivative works of the Software, and to permit
+// third-parties to whom the Software is furnished to do so.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, TITLE AND
+// NON-INFRINGEMENT. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR ANYONE
+// DISTRIBUTING THE SOFTWARE BE LIABLE FOR ANY DAMAGES OR OTHER
+// LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+// OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+// -----------------------------------------------------------------------
+
+
+#include "XdfWriter.h"
+
+#include "lsl_cpp.h"
+
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+
+using namespace ellsl;
+
+namespace
+{
+// the front buffer is handed over once it holds this many bytes or samples of this age
+constexpr size_t                HANDOVER_BYTES = size_t( 256 ) << 10;
+const std::chrono::milliseconds HANDOVER_INTERVAL( 500 );
+// intervals of clock offset and boundary chunks, as written by LabRecorder
+const std::chrono::seconds CLOCK_OFFSET_INTERVAL( 5 );
+const std::chrono::seconds BOUNDARY_INTERVAL( 10 );
+
+constexpr char    MAGIC[]        = { 'X', 'D', 'F', ':' };
+constexpr uint8_t BOUNDARY[ 16 ] = { 0x43, 0xA5, 0x46, 0xDC, 0xCB, 0xF5, 0x41, 0x0F,
+                                     0xB3, 0x0E, 0xD5, 0x46, 0x73, 0x83, 0xCB, 0xE4 };
+// every sample carries its timestamp
+constexpr uint8_t TIMESTAMP_BYTES = sizeof( double );
+}  // namespace
+
+std::unique_ptr< XdfWriter >
+XdfWriter::open( const std::string& path )
+{
+    std::ofstream file( path, std::ios::binary | std::ios::trunc );
+    if ( !file ) {
+        return nullptr;
+    }
+    return std::unique_ptr< XdfWriter >( new XdfWriter( path, std::move( file ) ) );
+}
+
+XdfWriter::XdfWriter( const std::string& path, std::ofstream&& file )
+    : m_path( path ), m_file( std::move( file ) )
+{
+    m_front.reserve( HANDOVER_BYTES );
+    m_back.reserve( HANDOVER_BYTES );
+
+    const std::string header = "<?xml version=\"1.0\"?><info><version>1.0</version></info>";
+    write( MAGIC, sizeof( MAGIC ) );
+    writeChunkHeader( Tag::FILE_HEADER, header.size( ) );
+    write( header.data( ), header.size( ) );
+    m_file.flush( );
+    m_statistics.bytes = m_written;
+
+    m_writer = std::thread( &XdfWriter::runWriter, this );
+}
+
+XdfWriter::~XdfWriter( )
+{
+    endStream( );
+    {
+        std::unique_lock< std::mutex > lock( m_mutex );
+        m_run = false;
+    }
+    m_wakeup.notify_all( );
+    m_writer.join( );
+}
+
+void
+XdfWriter::beginStream( const std::string& infoXml )
+{
+    endStream( );
+
+    m_streamId       = m_nextStreamId++;
+    m_streamSamples  = 0;
+    m_firstTimestamp = 0.0;
+    m_lastTimestamp  = 0.0;
+
+    Job job;
+    job.tag      = Tag::STREAM_HEADER;
+    job.streamId = m_streamId;
+    job.content.assign( infoXml.begin( ), infoXml.end( ) );
+    enqueue( std::move( job ) );
+}
+
+void
+XdfWriter::endStream( )
+{
+    if ( m_streamId == 0 ) {
+        return;
+    }
+    handOver( true );
+
+    Job job;
+    job.tag      = Tag::STREAM_FOOTER;
+    job.streamId = m_streamId;
+    job.samples        = m_streamSamples;
+    job.firstTimestamp = m_firstTimestamp;
+    job.lastTimestamp  = m_lastTimestamp;
+    enqueue( std::move( job ) );
+    m_streamId = 0;
+}
+
+void
+XdfWriter::appendSamples( const double* timestamps, const void* values, int32 count,
+                          size_t sampleBytes )
+{
+    if ( m_streamId == 0 || count <= 0 ) {
+        return;
+    }
+    const auto now = std::chrono::steady_clock::now( );
+    if ( m_frontSamples == 0 ) {
+        m_frontBegin = now;
+    }
+
+    // [TimeStampBytes][TimeStamp][values] per sample
+    const size_t stride = 1 + sizeof( double ) + sampleBytes;
+    size_t       offset = m_front.size( );
+    m_front.resize( offset + stride * count );
+    const char* source = static_cast< const char* >( values );
+    for ( int32 i = 0; i < count; i++ ) {
+        char* sample = m_front.data( ) + offset;
+        sample[ 0 ]  = static_cast< char >( TIMESTAMP_BYTES );
+        std::memcpy( sample + 1, timestamps + i, sizeof( double ) );
+        std::memcpy( sample + 1 + sizeof( double ), source + i * sampleBytes, sampleBytes );
+        offset += stride;
+    }
+
+    if ( m_streamSamples == 0 ) {
+        m_firstTimestamp = timestamps[ 0 ];
+    }
+    m_lastTimestamp = timestamps[ count - 1 ];
+    m_streamSamples += count;
+    m_frontSamples += count;
+
+    if ( m_front.size( ) >= HANDOVER_BYTES || now - m_frontBegin >= HANDOVER_INTERVAL ) {
+        handOver( false );
+    }
+}
+
+const std::string&
+XdfWriter::path( ) const
+{
+    return m_path;
+}
+
+XdfWriter::Statistics
+XdfWriter::statistics( ) const
+{
+    std::unique_lock< std::mutex > lock( m_mutex );
+    return m_statistics;
+}
+
+void
+XdfWriter::handOver( bool force )
+{
+    if ( m_frontSamples == 0 ) {
+        return;
+    }
+    Job job;
+    job.tag      = Tag::SAMPLES;
+    job.streamId = m_streamId;
+    job.samples  = m_frontSamples;
+    {
+        std::unique_lock< std::mutex > lock( m_mutex );
+        if ( !m_backReturned && !force ) {
+            // keep filling the front buffer until the I/O thread is done with the other one
+            if ( !m_frontLate ) {
+                m_statistics.late++;
+                m_frontLate = true;
+            }
+            return;
+        }
+        job.content = std::move( m_front );
+        m_front     = std::move( m_back );
+        m_front.clear( );
+        m_backReturned = false;
+        m_jobs.push_back( std::move( job ) );
+    }
+    m_wakeup.notify_one( );
+    m_frontSamples = 0;
+    m_frontLate    = false;
+}
+
+void
+XdfWriter::enqueue( Job&& job )
+{
+    {
+        std::unique_lock< std::mutex > lock( m_mutex );
+        m_jobs.push_back( std::move( job ) );
+    }
+    m_wakeup.notify_one( );
+}
+
+void
+XdfWriter::runWriter( )
+{
+    auto nextOffset   = std::chrono::steady_clock::now( );
+    auto nextBoundary = nextOffset + BOUNDARY_INTERVAL;
+
+    std::unique_lock< std::mutex > lock( m_mutex );
+    while ( true ) {
+        m_wakeup.wait_until( lock, std::min( nextOffset, nextBoundary ),
+                             [ this ] { return !m_jobs.empty( ) || !m_run; } );
+
+        while ( !m_jobs.empty( ) ) {
+            Job job = std::move( m_jobs.front( ) );
+            m_jobs.pop_front( );
+
+            lock.unlock( );
+            writeJob( job );
+            if ( job.tag == Tag::STREAM_HEADER ) {
+                nextOffset = std::chrono::steady_clock::now( );
+            }
+            lock.lock( );
+
+            if ( job.tag == Tag::SAMPLES ) {
+                m_statistics.samples += job.samples;
+                // the buffer goes back to the publisher
+                job.content.clear( );
+                m_back         = std::move( job.content );
+                m_backReturned = true;
+            } else if ( job.tag == Tag::STREAM_HEADER ) {
+                m_statistics.streams++;
+            }
+            m_statistics.bytes = m_written;
+        }
+
+        const auto now = std::chrono::steady_clock::now( );
+        if ( now >= nextOffset || now >= nextBoundary ) {
+            lock.unlock( );
+            // the stream is stamped with the clock of this process - the offset is always zero
+            if ( now >= nextOffset && m_writerStream != 0 ) {
+                const double collection = lsl::local_clock( );
+                const double offset     = 0.0;
+                writeChunkHeader( Tag::CLOCK_OFFSET, sizeof( uint32 ) + 2 * sizeof( double ) );
+                write( &m_writerStream, sizeof( m_writerStream ) );
+                write( &collection, sizeof( collection ) );
+                write( &offset, sizeof( offset ) );
+                m_clockOffsets.emplace_back( collection, offset );
+            }
+            if ( now >= nextBoundary ) {
+                writeChunkHeader( Tag::BOUNDARY, sizeof( BOUNDARY ) );
+                write( BOUNDARY, sizeof( BOUNDARY ) );
+                nextBoundary = now + BOUNDARY_INTERVAL;
+            }
+            if ( now >= nextOffset ) {
+                nextOffset = now + CLOCK_OFFSET_INTERVAL;
+            }
+            m_file.flush( );
+            lock.lock( );
+            m_statistics.bytes = m_written;
+        }
+
+        if ( !m_run && m_jobs.empty( ) ) {
+            break;
+        }
+    }
+}
+
+void
+XdfWriter::writeJob( const Job& job )
+{
+    switch ( job.tag ) {
+        case Tag::STREAM_HEADER:
+            m_writerStream = job.streamId;
+            m_clockOffsets.clear( );
+            writeChunkHeader( job.tag, sizeof( uint32 ) + job.content.size( ) );
+            write( &job.streamId, sizeof( job.streamId ) );
+            write( job.content.data( ), job.content.size( ) );
+            break;
+        case Tag::SAMPLES: {
+            const uint32  count     = static_cast< uint32 >( job.samples );
+            const uint8_t countSize = sizeof( count );
+            writeChunkHeader( job.tag, sizeof( uint32 ) + 1 + sizeof( count ) +
+                                           job.content.size( ) );
+            write( &job.streamId, sizeof( job.streamId ) );
+            write( &countSize, sizeof( countSize ) );
+            write( &count, sizeof( count ) );
+            write( job.content.data( ), job.content.size( ) );
+        } break;
+        case Tag::STREAM_FOOTER: {
+            std::ostringstream footer;
+            footer << std::setprecision( 17 ) << "<?xml version=\"1.0\"?><info><first_timestamp>"
+                   << job.firstTimestamp << "</first_timestamp><last_timestamp>"
+                   << job.lastTimestamp << "</last_timestamp><sample_count>" << job.samples
+                   << "</sample_count><clock_offsets>";
+            for ( const auto& offset : m_clockOffsets ) {
+                footer << "<offset><time>" << offset.first << "</time><value>" << offset.second
+                       << "</value></offset>";
+            }
+            footer << "</clock_offsets></info>";
+            const std::string xml = footer.str( );
+
+            writeChunkHeader( job.tag, sizeof( uint32 ) + xml.size( ) );
+            write( &job.streamId, sizeof( job.streamId ) );
+            write( xml.data( ), xml.size( ) );
+            m_writerStream = 0;
+        } break;
+        default:
+            break;
+    }
+    m_file.flush( );
+}
+
+void
+XdfWriter::writeChunkHeader( Tag tag, uint64 contentBytes )
+{
+    const uint16_t value = static_cast< uint16_t >( tag );
+    writeVarLen( sizeof( value ) + contentBytes );
+    write( &value, sizeof( value ) );
+}
+
+void
+XdfWriter::writeVarLen( uint64 value )
+{
+    // XDF lengths are prefixed with their own size of 1, 4 or 8 bytes, all little-endian
+    if ( value <= 0xFF ) {
+        const uint8_t size = 1, length = static_cast< uint8_t >( value );
+        write( &size, 1 );
+        write( &length, 1 );
+    } else if ( value <= 0xFFFFFFFF ) {
+        const uint8_t size   = 4;
+        const uint32  length = static_cast< uint32 >( value );
+        write( &size, 1 );
+        write( &length, sizeof( length ) );
+    } else {
+        const uint8_t size = 8;
+        write( &size, 1 );
+        write( &value, sizeof( value ) );
+    }
+}
+
+void
+XdfWriter::write( const void* data, size_t bytes )
+{
+    m_file.write( static_cast< const char* >( data ), static_cast< std::streamsize >( bytes ) );
+    m_written += bytes;
+}
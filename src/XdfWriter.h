@@ -0,0 +1,151 @@
+// -----------------------------------------------------------------------
+// Copyright (C) 2019-2023, EyeLogic GmbH
+//
+// Permission is hereby granted, free of charge, to any person or
+// organization obtaining a copy of the software and accompanying
+// documentation covered by this license (the "Software") to use,
+// reproduce, display, distribute, execute, and transmit the Software,
+// and to prepare derivative works of the Software, and to permit
+// third-parties to whom the Software is furnished to do so.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, TITLE AND
+// NON-INFRINGEMENT. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR ANYONE
+// DISTRIBUTING THE SOFTWARE BE LIABLE FOR ANY DAMAGES OR OTHER
+// LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+// OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+// -----------------------------------------------------------------------
+
+
+#pragma once
+
+#include <cstdint>
+
+using int32  = int32_t;
+using int64  = int64_t;
+using uint32 = uint32_t;
+using uint64 = uint64_t;
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ellsl
+{
+/**
+ * @brief writes the gaze stream to an XDF 1.0 file, as LabRecorder would
+ *
+ * The publisher serializes samples into the front buffer of a pair; full buffers are handed to a
+ * background I/O thread, which writes them as Samples chunks and hands them back. Stream headers,
+ * footers, clock offsets and boundary chunks are written by the I/O thread as well, so the
+ * publisher never waits for the disk. Every stream started with beginStream( ) gets its own
+ * stream id within the file.
+ *
+ * Not thread-safe, the owner has to serialize all calls except for those of the I/O thread.
+ */
+class XdfWriter
+{
+public:
+    struct Statistics {
+        uint64 streams = 0;
+        uint64 samples = 0;
+        /** @brief bytes written to the file */
+        uint64 bytes   = 0;
+        /** @brief hand-overs postponed because the I/O thread was still busy */
+        uint64 late    = 0;
+    };
+
+    /** @return nullptr if the file cannot be created */
+    static std::unique_ptr< XdfWriter > open( const std::string& path );
+
+    /** @brief flushes all buffers, writes the footer of the current stream and closes the file */
+    ~XdfWriter( );
+
+    XdfWriter( const XdfWriter& ) = delete;
+    XdfWriter& operator=( const XdfWriter& ) = delete;
+
+    /** @brief starts a new stream, the previous one is ended first */
+    void beginStream( const std::string& infoXml );
+
+    /** @brief hands the buffered samples over and writes the footer of the current stream */
+    void endStream( );
+
+    /** @brief appends 'count' converted samples of 'sampleBytes' each */
+    void appendSamples( const double* timestamps, const void* values, int32 count,
+                        size_t sampleBytes );
+
+    const std::string& path( ) const;
+    Statistics         statistics( ) const;
+
+private:
+    enum class Tag : uint16_t {
+        FILE_HEADER   = 1,
+        STREAM_HEADER = 2,
+        SAMPLES       = 3,
+        CLOCK_OFFSET  = 4,
+        BOUNDARY      = 5,
+        STREAM_FOOTER = 6,
+    };
+
+    /** @brief unit of work of the I/O thread */
+    struct Job {
+        Tag                 tag      = Tag::SAMPLES;
+        uint32              streamId = 0;
+        /** @brief Samples: number of samples in 'content' */
+        uint64              samples = 0;
+        std::vector< char > content;
+        /** @brief StreamFooter: timestamps of the first and last sample of the stream */
+        double              firstTimestamp = 0.0;
+        double              lastTimestamp  = 0.0;
+    };
+
+    XdfWriter( const std::string& path, std::ofstream&& file );
+
+    /** @brief hands the front buffer to the I/O thread if it has the other one back */
+    void handOver( bool force );
+    void enqueue( Job&& job );
+    void runWriter( );
+    void writeJob( const Job& job );
+    void writeChunkHeader( Tag tag, uint64 contentBytes );
+    void writeVarLen( uint64 value );
+    void write( const void* data, size_t bytes );
+
+    const std::string m_path;
+    std::ofstream     m_file;
+
+    // owned by the publisher
+    uint32                                m_streamId     = 0;
+    uint32                                m_nextStreamId = 1;
+    std::vector< char >                   m_front;
+    uint64                                m_frontSamples = 0;
+    bool                                  m_frontLate    = false;
+    std::chrono::steady_clock::time_point m_frontBegin;
+    uint64                                m_streamSamples  = 0;
+    double                                m_firstTimestamp = 0.0;
+    double                                m_lastTimestamp  = 0.0;
+
+    // mutex secures the job queue and the buffer returned by the I/O thread
+    mutable std::mutex       m_mutex;
+    std::condition_variable  m_wakeup;
+    std::deque< Job >        m_jobs;
+    std::vector< char >      m_back;
+    bool                     m_backReturned = true;
+    bool                     m_run          = true;
+    Statistics               m_statistics;
+    std::thread              m_writer;
+
+    // owned by the I/O thread - the stream being written and its clock offsets for the footer
+    uint32                                     m_writerStream = 0;
+    std::vector< std::pair< double, double > > m_clockOffsets;
+    uint64                                     m_written = 0;
+};
+
+}  // namespace ellsl
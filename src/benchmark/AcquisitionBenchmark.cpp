@@ -0,0 +1,220 @@
+// -----------------------------------------------------------------------
+// Copyright (C) 2019-2023, EyeLogic GmbH
+//
+// Permission is hereby granted, free of charge, to any person or
+// organization obtaining a copy of the software and accompanying
+// documentation covered by this license (the "Software") to use,
+// reproduce, display, distribute, execute, and transmit the Software,
+// and to prepare derivative works of the Software, and to permit
+// third-parties to whom the Software is furnished to do so.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, TITLE AND
+// NON-INFRINGEMENT. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR ANYONE
+// DISTRIBUTING THE SOFTWARE BE LIABLE FOR ANY DAMAGES OR OTHER
+// LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+// OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+// -----------------------------------------------------------------------
+
+
+// Compares the two acquisition modes of the LSL client against a running EyeLogic server (or the
+// simulated device with --simulate): the
+// ELApi listener callback and a configurable reader thread polling getNextGazeSample. For each
+// mode, samples are collected for a fixed duration and the delivery delay (arrival time minus
+// device timestamp) and the inter-arrival intervals are reported.
+//
+// usage: eyelogiclsl_acqbench [-r <SAMPLERATE>] [-d <SECONDS>] [--reader-priority <PRIORITY>]
+//                             [--reader-cpu <CPU>] [--simulate]
+
+#include "GazeSource.h"
+#include "SimulatedGazeSource.h"
+#include "ThreadConfig.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace ellsl;
+
+namespace
+{
+int64
+nowMicroSec( )
+{
+    return std::chrono::duration_cast< std::chrono::microseconds >(
+               std::chrono::system_clock::now( ).time_since_epoch( ) )
+        .count( );
+}
+
+class Recorder
+{
+public:
+    explicit Recorder( size_t expected )
+    {
+        m_delays.reserve( expected );
+        m_intervals.reserve( expected );
+    }
+
+    void record( const elapi::ELGazeSample& gazeSample )
+    {
+        const int64 arrival = nowMicroSec( );
+        m_delays.push_back( ( arrival - gazeSample.timestampMicroSec ) / 1000.0 );
+        if ( m_lastArrival > 0 ) {
+            m_intervals.push_back( ( arrival - m_lastArrival ) / 1000.0 );
+        }
+        if ( m_lastIndex >= 0 && gazeSample.index > m_lastIndex + 1 ) {
+            m_lost += gazeSample.index - m_lastIndex - 1;
+        }
+        m_lastArrival = arrival;
+        m_lastIndex   = gazeSample.index;
+    }
+
+    void print( const std::string& mode, double seconds )
+    {
+        std::cout << std::setw( 10 ) << std::left << mode << std::right << std::fixed
+                  << std::setprecision( 3 ) << std::setw( 10 ) << m_delays.size( ) / seconds
+                  << std::setw( 8 ) << m_lost;
+        for ( auto* values : { &m_delays, &m_intervals } ) {
+            std::sort( values->begin( ), values->end( ) );
+            for ( double quantile : { 0.5, 0.99, 0.999 } ) {
+                std::cout << std::setw( 10 ) << percentile( *values, quantile );
+            }
+        }
+        std::cout << std::endl;
+    }
+
+private:
+    static double percentile( const std::vector< double >& sorted, double quantile )
+    {
+        if ( sorted.empty( ) ) {
+            return 0.0;
+        }
+        return sorted[ static_cast< size_t >( quantile * ( sorted.size( ) - 1 ) ) ];
+    }
+
+    std::vector< double > m_delays;
+    std::vector< double > m_intervals;
+    int64                 m_lastArrival = 0;
+    int64                 m_lastIndex   = -1;
+    int64                 m_lost        = 0;
+};
+
+class ListenerRecorder : public elapi::ELApi::ELGazeSampleCallback
+{
+public:
+    explicit ListenerRecorder( Recorder& recorder ) : m_recorder( recorder ) { }
+    void STDCALL onGazeSample( const elapi::ELGazeSample& gazeSample ) override
+    {
+        m_recorder.record( gazeSample );
+    }
+
+private:
+    Recorder& m_recorder;
+};
+
+void
+runListener( GazeSource& api, std::chrono::seconds duration, Recorder& recorder )
+{
+    ListenerRecorder listener( recorder );
+    api.registerGazeSampleListener( &listener );
+    std::this_thread::sleep_for( duration );
+    api.registerGazeSampleListener( nullptr );
+}
+
+void
+runPolling( GazeSource& api, std::chrono::seconds duration, const ThreadConfig& config,
+            Recorder& recorder )
+{
+    std::thread reader( [ & ] {
+        if ( !configureCurrentThread( config ) ) {
+            std::cout << "cannot apply reader priority/affinity" << std::endl;
+        }
+        const auto          end = std::chrono::steady_clock::now( ) + duration;
+        elapi::ELGazeSample gazeSample;
+        while ( std::chrono::steady_clock::now( ) < end ) {
+            if ( api.getNextGazeSample( gazeSample, 100 ) ==
+                 elapi::ELApi::ReturnNextData::SUCCESS ) {
+                recorder.record( gazeSample );
+            }
+        }
+    } );
+    reader.join( );
+}
+}  // namespace
+
+int
+main( int argc, char* argv[] )
+{
+    int32        samplerate = 0;
+    int32        seconds    = 10;
+    ThreadConfig config;
+    bool         simulate   = false;
+    for ( int i = 1; i < argc; i++ ) {
+        const std::string arg = argv[ i ];
+        if ( arg == "--simulate" ) {
+            simulate = true;
+            continue;
+        }
+        if ( i + 1 >= argc ) {
+            break;
+        }
+        if ( arg == "-r" ) {
+            samplerate = std::stoi( argv[ i + 1 ] );
+        } else if ( arg == "-d" ) {
+            seconds = std::stoi( argv[ i + 1 ] );
+        } else if ( arg == "--reader-priority" ) {
+            parseThreadPriority( argv[ i + 1 ], config.priority );
+        } else if ( arg == "--reader-cpu" ) {
+            config.cpu = std::stoi( argv[ i + 1 ] );
+        }
+        i++;
+    }
+
+    const auto source = simulate ? std::make_shared< SimulatedGazeSource >( )
+                                 : createDefaultGazeSource( "LSL Acquisition Benchmark" );
+    GazeSource& api   = *source;
+    if ( api.connect( ) != elapi::ELApi::ReturnConnect::SUCCESS ) {
+        std::cout << "cannot connect to server - is the server running?" << std::endl;
+        return 1;
+    }
+
+    DeviceInfo deviceInfo;
+    api.getDeviceInfo( deviceInfo );
+    int32 mode = -1;
+    for ( int32 i = 0; i < static_cast< int32 >( deviceInfo.frameRates.size( ) ); i++ ) {
+        if ( samplerate == 0 || deviceInfo.frameRates[ i ] == samplerate ) {
+            mode       = i;
+            samplerate = deviceInfo.frameRates[ i ];
+        }
+    }
+    if ( mode < 0 || api.requestTracking( mode ) != elapi::ELApi::ReturnStart::SUCCESS ) {
+        std::cout << "cannot begin tracking at " << samplerate << " Hz" << std::endl;
+        return 1;
+    }
+
+    const size_t expected = static_cast< size_t >( samplerate ) * seconds * 2;
+    std::cout << samplerate << " Hz, " << seconds << " s per mode, reader priority "
+              << toString( config.priority ) << ", cpu " << config.cpu << std::endl;
+    std::cout << std::setw( 10 ) << std::left << "mode" << std::right << std::setw( 10 ) << "[Hz]"
+              << std::setw( 8 ) << "lost" << std::setw( 10 ) << "delay p50" << std::setw( 10 )
+              << "p99" << std::setw( 10 ) << "p99.9" << std::setw( 10 ) << "intv p50"
+              << std::setw( 10 ) << "p99" << std::setw( 10 ) << "p99.9" << "  [ms]" << std::endl;
+
+    Recorder listener( expected );
+    runListener( api, std::chrono::seconds( seconds ), listener );
+    listener.print( "listener", seconds );
+
+    Recorder polling( expected );
+    runPolling( api, std::chrono::seconds( seconds ), config, polling );
+    polling.print( "polling", seconds );
+
+    api.unrequestTracking( );
+    api.disconnect( );
+    return 0;
+}
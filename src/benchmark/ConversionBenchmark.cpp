@@ -0,0 +1,172 @@
+// -----------------------------------------------------------------------
+// Copyright (C) 2019-2023, EyeLogic GmbH
+//
+// Permission is hereby granted, free of charge, to any person or
+// organization obtaining a copy of the software and accompanying
+// documentation covered by this license (the "Software") to use,
+// reproduce, display, distribute, execute, and transmit the Software,
+// and to prepare derivative works of the Software, and to permit
+// third-parties to whom the Software is furnished to do so.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, TITLE AND
+// NON-INFRINGEMENT. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR ANYONE
+// DISTRIBUTING THE SOFTWARE BE LIABLE FOR ANY DAMAGES OR OTHER
+// LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+// OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+// -----------------------------------------------------------------------
+
+
+// Checks the vectorized conversion kernel against the scalar reference convertSample( ) and
+// measures both for every stream profile. Returns 1 if any converted value differs.
+
+#include "ConversionKernel.h"
+
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace ellsl;
+
+namespace
+{
+const size_t NSAMPLES   = 100000;
+const size_t BATCH      = 64;
+const int32  REPETITIONS = 20;
+
+std::vector< elapi::ELGazeSample >
+makeSamples( size_t count )
+{
+    std::mt19937                             random( 42 );
+    std::uniform_real_distribution< double > value( -500.0, 2500.0 );
+    std::bernoulli_distribution              invalid( 0.1 );
+
+    std::vector< elapi::ELGazeSample > samples( count );
+    for ( size_t i = 0; i < count; i++ ) {
+        elapi::ELGazeSample& sample = samples[ i ];
+        sample.timestampMicroSec    = static_cast< int64 >( i ) * 1000;
+        sample.index                = static_cast< int32 >( i );
+        double* fields              = &sample.porRawX;
+        for ( double* field = fields; field <= &sample.pupilRadiusRight; field++ ) {
+            *field = invalid( random ) ? elapi::ELInvalidValue : value( random );
+        }
+    }
+    return samples;
+}
+
+template< typename Value >
+bool
+same( Value a, Value b )
+{
+    return ( std::isnan( a ) && std::isnan( b ) ) || a == b;
+}
+
+template< typename Function >
+double
+nanosecondsPerSample( Function function )
+{
+    double best = std::numeric_limits< double >::max( );
+    for ( int32 r = 0; r < REPETITIONS; r++ ) {
+        const auto begin = std::chrono::steady_clock::now( );
+        function( );
+        const auto end = std::chrono::steady_clock::now( );
+        best = std::min( best, std::chrono::duration< double, std::nano >( end - begin ).count( ) );
+    }
+    return best / NSAMPLES;
+}
+
+template< typename Value, ChannelSelection Selection >
+bool
+run( const std::vector< elapi::ELGazeSample >& samples, const std::string& name )
+{
+    const size_t          nchannels = channelCount( Selection );
+    std::vector< Value >  reference( samples.size( ) * nchannels );
+    std::vector< Value >  converted( samples.size( ) * nchannels );
+    std::vector< double > scratch( BATCH * nchannels );
+
+    // correctness: single samples and batches against the scalar reference
+    for ( size_t i = 0; i < samples.size( ); i++ ) {
+        convertSample< Value, Selection >( samples[ i ], &reference[ i * nchannels ] );
+    }
+    for ( size_t i = 0; i < samples.size( ); i += BATCH ) {
+        const size_t count = std::min( BATCH, samples.size( ) - i );
+        convertBatch< Value, Selection >( &samples[ i ], count, &converted[ i * nchannels ],
+                                          scratch.data( ) );
+    }
+    size_t mismatches = 0;
+    for ( size_t i = 0; i < reference.size( ); i++ ) {
+        mismatches += same( reference[ i ], converted[ i ] ) ? 0 : 1;
+    }
+    for ( size_t i = 0; i < samples.size( ); i++ ) {
+        convertBatch< Value, Selection >( &samples[ i ], 1, &converted[ 0 ], scratch.data( ) );
+        for ( size_t c = 0; c < nchannels; c++ ) {
+            mismatches += same( reference[ i * nchannels + c ], converted[ c ] ) ? 0 : 1;
+        }
+    }
+
+    // performance
+    const double scalar = nanosecondsPerSample( [ & ] {
+        for ( size_t i = 0; i < samples.size( ); i++ ) {
+            convertSample< Value, Selection >( samples[ i ], &converted[ i * nchannels ] );
+        }
+    } );
+    const double single = nanosecondsPerSample( [ & ] {
+        for ( size_t i = 0; i < samples.size( ); i++ ) {
+            convertBatch< Value, Selection >( &samples[ i ], 1, &converted[ i * nchannels ],
+                                              scratch.data( ) );
+        }
+    } );
+    const double batched = nanosecondsPerSample( [ & ] {
+        for ( size_t i = 0; i < samples.size( ); i += BATCH ) {
+            const size_t count = std::min( BATCH, samples.size( ) - i );
+            convertBatch< Value, Selection >( &samples[ i ], count, &converted[ i * nchannels ],
+                                              scratch.data( ) );
+        }
+    } );
+
+    std::cout << std::setw( 20 ) << std::left << name << std::right << std::fixed
+              << std::setprecision( 2 ) << std::setw( 12 ) << scalar << std::setw( 12 ) << single
+              << std::setw( 12 ) << batched << std::setw( 12 ) << mismatches << std::endl;
+    return mismatches == 0;
+}
+
+template< typename Value >
+bool
+runAll( const std::vector< elapi::ELGazeSample >& samples, const std::string& format )
+{
+    bool ok = true;
+    ok &= run< Value, ChannelSelection::FULL >( samples, "full:" + format );
+    ok &= run< Value, ChannelSelection::POR >( samples, "por:" + format );
+    ok &= run< Value, ChannelSelection::FILTERED >( samples, "filtered:" + format );
+    ok &= run< Value, ChannelSelection::EYES >( samples, "eyes:" + format );
+    return ok;
+}
+}  // namespace
+
+int
+main( )
+{
+#if defined( __AVX2__ )
+    const char* isa = "AVX2";
+#elif defined( ELLSL_HAVE_SSE2 )
+    const char* isa = "SSE2";
+#else
+    const char* isa = "scalar";
+#endif
+    std::cout << "conversion kernel: " << isa << ", " << NSAMPLES << " samples, batches of "
+              << BATCH << std::endl;
+    std::cout << std::setw( 20 ) << std::left << "profile [ns/sample]" << std::right
+              << std::setw( 12 ) << "reference" << std::setw( 12 ) << "single" << std::setw( 12 )
+              << "batched" << std::setw( 12 ) << "mismatches" << std::endl;
+
+    const auto samples = makeSamples( NSAMPLES );
+    bool       ok      = true;
+    ok &= runAll< double >( samples, "double64" );
+    ok &= runAll< float >( samples, "float32" );
+    return ok ? 0 : 1;
+}
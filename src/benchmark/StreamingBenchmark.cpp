@@ -0,0 +1,585 @@
+// -----------------------------------------------------------------------
+// Copyright (C) 2019-2023, EyeLogic GmbH
+//
+// Permission is hereby granted, free of charge, to any person or
+// organization obtaining a copy of the software and accompanying
+// documentation covered by this license (the "Software") to use,
+// reproduce, display, distribute, execute, and transmit the Software,
+// and to prepare derivative works of the Software, and to permit
+// third-parties to whom the Software is furnished to do so.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, TITLE AND
+// NON-INFRINGEMENT. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR ANYONE
+// DISTRIBUTING THE SOFTWARE BE LIABLE FOR ANY DAMAGES OR OTHER
+// LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+// OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+// -----------------------------------------------------------------------
+
+
+// End-to-end benchmark of the streaming path: LSLClient acquires from the simulated device at
+// rising frame rates (250, 500, 1000, 2000 Hz and unthrottled) and a local lsl::stream_inlet
+// consumes the outlet. For each run, the sustained throughput at the inlet, the process CPU time
+// per sample (including the simulator and the inlet) and the latency from the entry of the gaze
+// sample callback to the receipt at the inlet are reported. A final run attaches -m simulated
+// trackers at 1000 Hz through a TrackerPool and reports every tracker's throughput and latency,
+// each measured by an inlet of its own. Results are written as JSON.
+//
+// usage: eyelogiclsl_benchmark [-d <SECONDS>] [-o <JSON FILE>] [-n <CHUNK SAMPLES>]
+//                              [-t <CHUNK MICROSECONDS>] [--acquisition listener|polling]
+//                              [-m <TRACKERS, 0 skips the run>]
+
+#include "GazeOutlet.h"
+#include "LSLClient.h"
+#include "SimulatedGazeSource.h"
+#include "TrackerPool.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <ctime>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace ellsl;
+
+namespace
+{
+const std::chrono::seconds WARMUP( 1 );
+const double               RESOLVE_TIMEOUT = 5.0;
+const size_t               INLET_CHUNK     = 256;
+// the unthrottled run announces the highest frame rate
+const int32 UNTHROTTLED_SAMPLERATE = 2000;
+// frame rate of the multi-tracker run
+const int32 TRACKERS_SAMPLERATE = 1000;
+// time the simulated servers have to answer the discovery ping [ms]
+const int32 DISCOVERY_MILLIS = 100;
+
+int64
+steadyMicroSec( )
+{
+    return std::chrono::duration_cast< std::chrono::microseconds >(
+               std::chrono::steady_clock::now( ).time_since_epoch( ) )
+        .count( );
+}
+
+// user and kernel time of all threads of the process [us]
+int64
+processCpuMicroSec( )
+{
+#ifdef _WIN32
+    FILETIME creation, exit, kernel, user;
+    GetProcessTimes( GetCurrentProcess( ), &creation, &exit, &kernel, &user );
+    auto toMicroSec = []( const FILETIME& time ) {
+        return ( ( static_cast< int64 >( time.dwHighDateTime ) << 32 ) | time.dwLowDateTime ) / 10;
+    };
+    return toMicroSec( kernel ) + toMicroSec( user );
+#else
+    timespec time;
+    clock_gettime( CLOCK_PROCESS_CPUTIME_ID, &time );
+    return static_cast< int64 >( time.tv_sec ) * 1000000 + time.tv_nsec / 1000;
+#endif
+}
+
+double
+percentile( const std::vector< double >& sorted, double quantile )
+{
+    if ( sorted.empty( ) ) {
+        return 0.0;
+    }
+    return sorted[ static_cast< size_t >( quantile * ( sorted.size( ) - 1 ) ) ];
+}
+
+/**
+ * @brief forwards to the simulated device and stamps the time each sample enters the client,
+ * by listener callback or by a successful poll
+ */
+class TimedGazeSource final : public GazeSource, public elapi::ELApi::ELGazeSampleCallback
+{
+public:
+    explicit TimedGazeSource( std::shared_ptr< GazeSource > source )
+        : m_source( std::move( source ) ), m_entry( std::make_unique< std::atomic< int64 >[] >( HISTORY ) )
+    {
+    }
+
+    int64  entryMicroSec( int32 index ) const { return m_entry[ index & ( HISTORY - 1 ) ]; }
+    uint64 delivered( ) const { return m_delivered; }
+
+    void registerEventListener( elapi::ELApi::ELEventCallback* callback ) override
+    {
+        m_source->registerEventListener( callback );
+    }
+    void registerGazeSampleListener( elapi::ELApi::ELGazeSampleCallback* callback ) override
+    {
+        m_listener = callback;
+        m_source->registerGazeSampleListener( callback ? this : nullptr );
+    }
+    void STDCALL onGazeSample( const elapi::ELGazeSample& gazeSample ) override
+    {
+        stamp( gazeSample.index );
+        if ( auto* listener = m_listener.load( ) ) {
+            listener->onGazeSample( gazeSample );
+        }
+    }
+
+    elapi::ELApi::ReturnConnect connect( ) override { return m_source->connect( ); }
+    elapi::ELApi::ReturnConnect connectRemote( elapi::ELApi::ServerInfo server ) override
+    {
+        return m_source->connectRemote( server );
+    }
+    int32 requestServerList( int32 blockingDurationMS, elapi::ELApi::ServerInfo* serverList,
+                             int32 serverListLength ) override
+    {
+        return m_source->requestServerList( blockingDurationMS, serverList, serverListLength );
+    }
+    void disconnect( ) override { m_source->disconnect( ); }
+    bool isConnected( ) const override { return m_source->isConnected( ); }
+
+    void getActiveScreen( elapi::ELApi::ScreenConfig& screenConfig ) const override
+    {
+        m_source->getActiveScreen( screenConfig );
+    }
+    void getDeviceInfo( DeviceInfo& deviceInfo ) const override
+    {
+        m_source->getDeviceInfo( deviceInfo );
+    }
+
+    elapi::ELApi::ReturnNextData getNextEvent( elapi::ELApi::Event& event,
+                                               int32 timeoutMillis ) override
+    {
+        return m_source->getNextEvent( event, timeoutMillis );
+    }
+    elapi::ELApi::ReturnNextData getNextGazeSample( elapi::ELGazeSample& gazeSample,
+                                                    int32 timeoutMillis ) override
+    {
+        const auto result = m_source->getNextGazeSample( gazeSample, timeoutMillis );
+        if ( result == elapi::ELApi::ReturnNextData::SUCCESS ) {
+            stamp( gazeSample.index );
+        }
+        return result;
+    }
+
+    elapi::ELApi::ReturnStart requestTracking( int32 frameRateModeInd ) override
+    {
+        return m_source->requestTracking( frameRateModeInd );
+    }
+    void unrequestTracking( ) override { m_source->unrequestTracking( ); }
+
+    elapi::ELApi::ReturnCalibrate calibrate( int32 calibrationModeInd ) override
+    {
+        return m_source->calibrate( calibrationModeInd );
+    }
+    void abortCalibValidation( ) override { m_source->abortCalibValidation( ); }
+    elapi::ELApi::ReturnValidate validate(
+        elapi::ELApi::ELValidationResult& validationResult ) override
+    {
+        return m_source->validate( validationResult );
+    }
+
+private:
+    // more than 8 minutes at 2000 Hz before an entry is overwritten
+    static constexpr size_t HISTORY = size_t( 1 ) << 20;
+
+    void stamp( int32 index )
+    {
+        m_entry[ index & ( HISTORY - 1 ) ].store( steadyMicroSec( ), std::memory_order_relaxed );
+        m_delivered.fetch_add( 1, std::memory_order_relaxed );
+    }
+
+    std::shared_ptr< GazeSource >                       m_source;
+    std::atomic< elapi::ELApi::ELGazeSampleCallback* > m_listener{ nullptr };
+    std::unique_ptr< std::atomic< int64 >[] >           m_entry;
+    std::atomic< uint64 >                               m_delivered{ 0 };
+};
+
+struct Options {
+    int32                  seconds      = 10;
+    std::string            output       = "eyelogiclsl_benchmark.json";
+    int32                  chunkSamples = 1;
+    int32                  chunkTime    = 0;
+    LSLClient::Acquisition acquisition  = LSLClient::Acquisition::LISTENER;
+    int32                  trackers     = 8;
+};
+
+struct Result {
+    std::string name;
+    int32       samplerate;
+    bool        unthrottled;
+    int32       trackers      = 1;
+    double      seconds       = 0.0;
+    uint64      delivered     = 0;
+    uint64      received      = 0;
+    uint64      lost          = 0;
+    uint64      ringOverflows = 0;
+    double      throughput    = 0.0;
+    double      cpuPerSample  = 0.0;
+    double      latencyP50    = 0.0;
+    double      latencyP99    = 0.0;
+    double      latencyP999   = 0.0;
+    double      latencyMax    = 0.0;
+    bool        valid         = false;
+};
+
+/** @brief inlet on the gaze outlet of device 'serial', nullptr if it does not resolve */
+std::unique_ptr< lsl::stream_inlet >
+openInlet( const StreamProfile& profile, int32 samplerate, uint64 serial, size_t& nchannels )
+{
+    const auto sourceId = makeGazeStreamInfo( profile, samplerate, serial ).source_id( );
+    const auto streams  = lsl::resolve_stream( "source_id", sourceId, 1, RESOLVE_TIMEOUT );
+    if ( streams.empty( ) ) {
+        return nullptr;
+    }
+    nchannels  = streams[ 0 ].channel_count( );
+    auto inlet = std::make_unique< lsl::stream_inlet >( streams[ 0 ] );
+    inlet->open_stream( RESOLVE_TIMEOUT );
+    return inlet;
+}
+
+/**
+ * @brief discards the samples of 'inlet' until 'warmupEnd', then counts them until 'end'
+ * @param latencies receives the latency of every counted sample [ms]
+ */
+void
+consume( lsl::stream_inlet& inlet, size_t nchannels, const TimedGazeSource& source,
+         std::chrono::steady_clock::time_point warmupEnd,
+         std::chrono::steady_clock::time_point end, Result& result,
+         std::vector< double >& latencies )
+{
+    std::vector< double > data( nchannels * INLET_CHUNK );
+    std::vector< double > timestamps( INLET_CHUNK );
+
+    const auto pull = [ & ] {
+        return inlet.pull_chunk_multiplexed( data.data( ), timestamps.data( ), data.size( ),
+                                             timestamps.size( ), 0.1 ) /
+               nchannels;
+    };
+
+    // discard everything until the outlet has noticed the consumer and the pipeline is filled
+    while ( std::chrono::steady_clock::now( ) < warmupEnd ) {
+        pull( );
+    }
+
+    int64 lastIndex = -1;
+    while ( std::chrono::steady_clock::now( ) < end ) {
+        const size_t received = pull( );
+        const int64  receipt  = steadyMicroSec( );
+        for ( size_t i = 0; i < received; i++ ) {
+            const int32 index = static_cast< int32 >( data[ i * nchannels ] );
+            latencies.push_back( ( receipt - source.entryMicroSec( index ) ) / 1000.0 );
+            if ( lastIndex >= 0 && index > lastIndex + 1 ) {
+                result.lost += index - lastIndex - 1;
+            }
+            lastIndex = index;
+        }
+        result.received += received;
+    }
+}
+
+void
+summarize( std::vector< double >& latencies, Result& result )
+{
+    result.throughput = result.received / result.seconds;
+    std::sort( latencies.begin( ), latencies.end( ) );
+    result.latencyP50  = percentile( latencies, 0.5 );
+    result.latencyP99  = percentile( latencies, 0.99 );
+    result.latencyP999 = percentile( latencies, 0.999 );
+    result.latencyMax  = latencies.empty( ) ? 0.0 : latencies.back( );
+    result.valid       = true;
+}
+
+Result
+runBenchmark( const Options& options, int32 samplerate, bool unthrottled, uint64 serial )
+{
+    Result result;
+    result.name        = unthrottled ? "unthrottled" : std::to_string( samplerate ) + "Hz";
+    result.samplerate  = samplerate;
+    result.unthrottled = unthrottled;
+
+    SimulatorConfig config;
+    config.deviceSerial = serial;
+    config.frameRates   = { samplerate };
+    config.unthrottled  = unthrottled;
+    auto source = std::make_shared< TimedGazeSource >( std::make_shared< SimulatedGazeSource >( config ) );
+
+    LSLClient client( source );
+    client.setAcquisition( options.acquisition );
+    client.setChunking( options.chunkSamples, options.chunkTime );
+    const StreamProfile profile = client.streamProfile( );
+    if ( client.connectELApi( ) != elapi::ELApi::ReturnConnect::SUCCESS ||
+         client.requestTracking( samplerate ) != elapi::ELApi::ReturnStart::SUCCESS ) {
+        std::cout << result.name << ": cannot start the simulated device" << std::endl;
+        return result;
+    }
+
+    size_t     nchannels = 0;
+    const auto inlet     = openInlet( profile, samplerate, serial, nchannels );
+    if ( !inlet ) {
+        std::cout << result.name << ": cannot resolve the outlet" << std::endl;
+        return result;
+    }
+
+    std::vector< double > latencies;
+    latencies.reserve( static_cast< size_t >( UNTHROTTLED_SAMPLERATE ) * options.seconds * 4 );
+
+    const auto warmupEnd = std::chrono::steady_clock::now( ) + WARMUP;
+    std::this_thread::sleep_until( warmupEnd );
+    const auto  ringBefore      = client.ringStatistics( );
+    const int64 cpuBegin        = processCpuMicroSec( );
+    const int64 wallBegin       = steadyMicroSec( );
+    const auto  deliveredBefore = source->delivered( );
+    consume( *inlet, nchannels, *source, warmupEnd,
+             warmupEnd + std::chrono::seconds( options.seconds ), result, latencies );
+    const int64 wallEnd   = steadyMicroSec( );
+    const int64 cpuEnd    = processCpuMicroSec( );
+    const auto  ringAfter = client.ringStatistics( );
+    result.delivered      = source->delivered( ) - deliveredBefore;
+
+    client.closeStream( );
+
+    result.seconds       = ( wallEnd - wallBegin ) / 1e6;
+    result.ringOverflows = ringAfter.overflows - ringBefore.overflows;
+    result.cpuPerSample =
+        result.received > 0 ? static_cast< double >( cpuEnd - cpuBegin ) / result.received : 0.0;
+    summarize( latencies, result );
+    return result;
+}
+
+/**
+ * @brief streams from 'trackers' simulated servers at once, each attached through the pool and
+ * consumed by an inlet on a thread of its own
+ * @return one result per tracker, the CPU time per sample is that of all trackers together
+ */
+std::vector< Result >
+runTrackers( const Options& options, int32 trackers, uint64 serial )
+{
+    std::vector< std::shared_ptr< TimedGazeSource > > sources( static_cast< size_t >( trackers ) );
+    SimulatorConfig                                   network;
+    network.servers = trackers;
+    TrackerPool pool(
+        [ & ]( const elapi::ELApi::ServerInfo& server ) {
+            // every simulated server is a device of its own
+            SimulatorConfig config;
+            config.deviceSerial = serial + server.port;
+            config.seed        += server.port;
+            config.frameRates   = { TRACKERS_SAMPLERATE };
+            sources[ server.port ] = std::make_shared< TimedGazeSource >(
+                std::make_shared< SimulatedGazeSource >( config ) );
+            return sources[ server.port ];
+        },
+        std::make_shared< SimulatedGazeSource >( network ) );
+
+    TrackerPool::ClientSettings settings;
+    settings.chunkSamples  = options.chunkSamples;
+    settings.chunkMicroSec = options.chunkTime;
+    settings.acquisition   = options.acquisition;
+
+    const std::string run =
+        std::to_string( trackers ) + "x" + std::to_string( TRACKERS_SAMPLERATE ) + "Hz";
+    const auto makeResult = [ & ]( const std::string& name ) {
+        Result result;
+        result.name        = name;
+        result.samplerate  = TRACKERS_SAMPLERATE;
+        result.unthrottled = false;
+        result.trackers    = trackers;
+        return result;
+    };
+
+    std::vector< Result >                               results;
+    std::vector< std::shared_ptr< LSLClient > >         clients;
+    std::vector< std::unique_ptr< lsl::stream_inlet > > inlets;
+    std::vector< size_t >                               nchannels;
+    for ( const auto& server : pool.discover( DISCOVERY_MILLIS ) ) {
+        const Result result = makeResult( run + " #" + std::to_string( results.size( ) + 1 ) );
+
+        int32 id;
+        if ( pool.attach( server, settings, id ) != elapi::ELApi::ReturnConnect::SUCCESS ||
+             pool.client( id )->requestTracking( TRACKERS_SAMPLERATE ) !=
+                 elapi::ELApi::ReturnStart::SUCCESS ) {
+            std::cout << result.name << ": cannot start the simulated device" << std::endl;
+            return { result };
+        }
+        size_t channels = 0;
+        auto   inlet    = openInlet( pool.client( id )->streamProfile( ), TRACKERS_SAMPLERATE,
+                                     serial + server.port, channels );
+        if ( !inlet ) {
+            std::cout << result.name << ": cannot resolve the outlet" << std::endl;
+            return { result };
+        }
+        results.push_back( result );
+        clients.push_back( pool.client( id ) );
+        inlets.push_back( std::move( inlet ) );
+        nchannels.push_back( channels );
+    }
+    if ( results.size( ) != static_cast< size_t >( trackers ) ) {
+        std::cout << run << ": only " << results.size( ) << " simulated servers answered"
+                  << std::endl;
+        return { makeResult( run ) };
+    }
+
+    std::vector< std::vector< double > > latencies( results.size( ) );
+    std::vector< std::thread >           consumers;
+    const size_t expected  = static_cast< size_t >( TRACKERS_SAMPLERATE ) * options.seconds * 4;
+    const auto   warmupEnd = std::chrono::steady_clock::now( ) + WARMUP;
+    const auto   end       = warmupEnd + std::chrono::seconds( options.seconds );
+    for ( size_t i = 0; i < results.size( ); i++ ) {
+        latencies[ i ].reserve( expected );
+        consumers.emplace_back( [ &, i ] {
+            consume( *inlets[ i ], nchannels[ i ], *sources[ i ], warmupEnd, end, results[ i ],
+                     latencies[ i ] );
+        } );
+    }
+
+    std::this_thread::sleep_until( warmupEnd );
+    std::vector< uint64 > overflowsBefore;
+    std::vector< uint64 > deliveredBefore;
+    for ( size_t i = 0; i < results.size( ); i++ ) {
+        overflowsBefore.push_back( clients[ i ]->ringStatistics( ).overflows );
+        deliveredBefore.push_back( sources[ i ]->delivered( ) );
+    }
+    const int64 cpuBegin  = processCpuMicroSec( );
+    const int64 wallBegin = steadyMicroSec( );
+    for ( auto& consumer : consumers ) {
+        consumer.join( );
+    }
+    const int64 wallEnd = steadyMicroSec( );
+    const int64 cpuEnd  = processCpuMicroSec( );
+
+    uint64 received = 0;
+    for ( size_t i = 0; i < results.size( ); i++ ) {
+        results[ i ].delivered     = sources[ i ]->delivered( ) - deliveredBefore[ i ];
+        results[ i ].ringOverflows =
+            clients[ i ]->ringStatistics( ).overflows - overflowsBefore[ i ];
+        results[ i ].seconds = ( wallEnd - wallBegin ) / 1e6;
+        received += results[ i ].received;
+    }
+    for ( size_t i = 0; i < results.size( ); i++ ) {
+        results[ i ].cpuPerSample =
+            received > 0 ? static_cast< double >( cpuEnd - cpuBegin ) / received : 0.0;
+        summarize( latencies[ i ], results[ i ] );
+        clients[ i ]->closeStream( );
+    }
+    return results;
+}
+
+void
+printResult( const Result& result )
+{
+    std::cout << std::setw( 12 ) << std::left << result.name << std::right << std::fixed
+              << std::setprecision( 1 ) << std::setw( 12 ) << result.throughput << std::setw( 8 )
+              << result.lost << std::setw( 10 ) << result.ringOverflows << std::setprecision( 2 )
+              << std::setw( 10 ) << result.cpuPerSample << std::setprecision( 3 ) << std::setw( 10 )
+              << result.latencyP50 << std::setw( 10 ) << result.latencyP99 << std::setw( 10 )
+              << result.latencyP999 << std::setw( 10 ) << result.latencyMax << std::endl;
+}
+
+std::string
+toJson( const Options& options, const std::vector< Result >& results )
+{
+    std::stringstream ss;
+    ss << std::setprecision( 6 );
+    ss << "{\n";
+    ss << "  \"benchmark\": \"eyelogiclsl streaming\",\n";
+    ss << "  \"acquisition\": \""
+       << ( options.acquisition == LSLClient::Acquisition::POLLING ? "polling" : "listener" )
+       << "\",\n";
+    ss << "  \"chunk_samples\": " << options.chunkSamples << ",\n";
+    ss << "  \"chunk_microseconds\": " << options.chunkTime << ",\n";
+    ss << "  \"runs\": [";
+    for ( size_t i = 0; i < results.size( ); i++ ) {
+        const auto& r = results[ i ];
+        ss << ( i == 0 ? "\n" : ",\n" );
+        ss << "    {\n";
+        ss << "      \"name\": \"" << r.name << "\",\n";
+        ss << "      \"samplerate\": " << r.samplerate << ",\n";
+        ss << "      \"unthrottled\": " << ( r.unthrottled ? "true" : "false" ) << ",\n";
+        ss << "      \"trackers\": " << r.trackers << ",\n";
+        ss << "      \"valid\": " << ( r.valid ? "true" : "false" ) << ",\n";
+        ss << "      \"seconds\": " << r.seconds << ",\n";
+        ss << "      \"samples_delivered\": " << r.delivered << ",\n";
+        ss << "      \"samples_received\": " << r.received << ",\n";
+        ss << "      \"samples_lost\": " << r.lost << ",\n";
+        ss << "      \"ring_overflows\": " << r.ringOverflows << ",\n";
+        ss << "      \"throughput_hz\": " << r.throughput << ",\n";
+        ss << "      \"cpu_us_per_sample\": " << r.cpuPerSample << ",\n";
+        ss << "      \"latency_ms\": { \"p50\": " << r.latencyP50 << ", \"p99\": " << r.latencyP99
+           << ", \"p99.9\": " << r.latencyP999 << ", \"max\": " << r.latencyMax << " }\n";
+        ss << "    }";
+    }
+    ss << "\n  ]\n}\n";
+    return ss.str( );
+}
+}  // namespace
+
+int
+main( int argc, char* argv[] )
+{
+    Options options;
+    for ( int i = 1; i + 1 < argc; i += 2 ) {
+        const std::string arg   = argv[ i ];
+        const std::string value = argv[ i + 1 ];
+        if ( arg == "-d" ) {
+            options.seconds = std::stoi( value );
+        } else if ( arg == "-o" ) {
+            options.output = value;
+        } else if ( arg == "-n" ) {
+            options.chunkSamples = std::stoi( value );
+        } else if ( arg == "-t" ) {
+            options.chunkTime = std::stoi( value );
+        } else if ( arg == "-m" ) {
+            options.trackers = std::stoi( value );
+        } else if ( arg == "--acquisition" && value == "polling" ) {
+            options.acquisition = LSLClient::Acquisition::POLLING;
+        }
+    }
+
+    std::cout << options.seconds << " s per run, chunks of " << options.chunkSamples
+              << " samples / " << options.chunkTime << " us" << std::endl;
+    std::cout << std::setw( 12 ) << std::left << "run" << std::right << std::setw( 12 ) << "[Hz]"
+              << std::setw( 8 ) << "lost" << std::setw( 10 ) << "overflow" << std::setw( 10 )
+              << "cpu [us]" << std::setw( 10 ) << "lat p50" << std::setw( 10 ) << "p99"
+              << std::setw( 10 ) << "p99.9" << std::setw( 10 ) << "max" << "  [ms]" << std::endl;
+
+    // every run gets its own serial number, so the inlet never resolves the outlet of a previous run
+    const uint64          serial = 0x00be7c00 + ( steadyMicroSec( ) & 0xff ) * 0x10;
+    std::vector< Result > results;
+    for ( int32 samplerate : { 250, 500, 1000, 2000 } ) {
+        results.push_back( runBenchmark( options, samplerate, false, serial + results.size( ) ) );
+        printResult( results.back( ) );
+    }
+    results.push_back(
+        runBenchmark( options, UNTHROTTLED_SAMPLERATE, true, serial + results.size( ) ) );
+    printResult( results.back( ) );
+    if ( options.trackers > 0 ) {
+        // the servers take the serial numbers following those of the single-tracker runs
+        for ( const Result& result :
+              runTrackers( options, options.trackers, serial + results.size( ) ) ) {
+            results.push_back( result );
+            printResult( results.back( ) );
+        }
+    }
+
+    std::ofstream file( options.output );
+    file << toJson( options, results );
+    if ( !file ) {
+        std::cout << "cannot write " << options.output << std::endl;
+        return 1;
+    }
+    std::cout << "results written to " << options.output << std::endl;
+    return std::all_of( results.begin( ), results.end( ),
+                        []( const Result& r ) { return r.valid; } )
+               ? 0
+               : 1;
+}
@@ -23,6 +23,8 @@ if( NOT LSL_INCLUDE_DIR )
 	message( FATAL_ERROR ${FIND_LSL_FAILURE_MESSAGE} )
 endif( NOT LSL_INCLUDE_DIR )
 
+# the shared library is only installed next to the executable on Windows
+if ( WIN32 )
 find_path(LSL_BINARY_DIR NAMES lsl.dll
              HINTS ${LSL_HINT_BIN} )
 if( NOT LSL_BINARY_DIR )
@@ -30,6 +32,7 @@ if( NOT LSL_BINARY_DIR )
 	message( FATAL_ERROR ${FIND_LSL_FAILURE_MESSAGE} )
 endif( NOT LSL_BINARY_DIR )
 string( CONCAT LSL_BINARY ${LSL_BINARY_DIR} "/lsl.dll" )
+endif ( WIN32 )
 
 find_library(LSL_LIBRARY NAMES lsl
              HINTS ${LSL_HINT_LIB} )
@@ -18,12 +18,22 @@
 // THE SOFTWARE.
 // -----------------------------------------------------------------------
 
+#include "ControlServer.h"
 #include "LSLClient.h"
+#include "Log.h"
+#include "SessionReplay.h"
+#include "SimulatedGazeSource.h"
+#include "TrackerPool.h"
 
+#include <atomic>
 #include <cctype>
+#include <csignal>
+#include <fstream>
 #include <iostream>
 #include <iomanip>
+#include <limits>
 #include <sstream>
+#include <thread>
 
 using namespace std::chrono_literals;
 using namespace ellsl;
@@ -36,22 +46,97 @@ const std::string COM_CONNECT   = "connect";
 const std::string COM_INIT      = "startstream";
 const std::string COM_CLOSE     = "closestream";
 const std::string COM_CALIBRATE = "calibrate";
+const std::string COM_VALIDATE  = "validate";
+const std::string COM_ABORT     = "abort";
+const std::string COM_CHUNKING  = "chunking";
+const std::string COM_STATS     = "stats";
+const std::string COM_SERVERS   = "servers";
+const std::string COM_ATTACH    = "attach";
+const std::string COM_DETACH    = "detach";
+const std::string COM_TRACKERS  = "trackers";
 
-const std::string OPT_INITRATE  = "-r";
-const std::string OPT_CALIBMODE = "-m";
+const std::string OPT_INITRATE     = "-r";
+const std::string OPT_PROFILE      = "-p";
+const std::string OPT_CALIBMODE    = "-m";
+const std::string OPT_CHUNKSAMPLES = "-n";
+const std::string OPT_CHUNKTIME    = "-t";
+const std::string OPT_DEVICE       = "-d";
+
+const std::string ARG_PROFILE      = "--profile";
+const std::string ARG_CHUNKSAMPLES = "--chunk-samples";
+const std::string ARG_CHUNKTIME    = "--chunk-time";
+const std::string ARG_ACQUISITION  = "--acquisition";
+const std::string ARG_PRIORITY     = "--reader-priority";
+const std::string ARG_CPU          = "--reader-cpu";
+const std::string ARG_SIMULATE     = "--simulate";
+const std::string ARG_FILLGAPS     = "--fill-gaps";
+const std::string ARG_IDLEGRACE    = "--idle-grace";
+const std::string ARG_JOURNAL      = "--journal";
+const std::string ARG_JOURNALSIZE  = "--journal-segment";
+const std::string ARG_XDF          = "--xdf";
+const std::string ARG_REPLAY       = "--replay";
+const std::string ARG_REPLAYSPEED  = "--replay-speed";
+const std::string ARG_LOGFILE      = "--log-file";
+const std::string ARG_LOGLEVEL     = "--log-level";
+const std::string ARG_EVENTS       = "--events";
+const std::string ARG_FILTER       = "--filter";
+const std::string ARG_DECIMATE     = "--decimate";
+const std::string ARG_ANGLES       = "--angles";
+const std::string ARG_NORECONNECT  = "--no-reconnect";
+const std::string ARG_CONFIG       = "--config";
+const std::string ARG_HEADLESS     = "--headless";
+const std::string ARG_SERVER       = "--server";
+const std::string ARG_RATE         = "--rate";
+const std::string ARG_CALIBRATE    = "--calibrate";
+const std::string ARG_CONTROLPORT  = "--control-port";
+
+const std::string PROMPT = ">> ";
+
+// time the servers in the local network have to answer the discovery ping
+constexpr int32 DISCOVERY_MILLIS = 1000;
+// number of servers announced by the simulated network
+constexpr int32 SIMULATED_SERVERS = 8;
+
+// exit codes of the headless mode, for supervisors
+constexpr int EXIT_STOPPED         = 0;
+constexpr int EXIT_USAGE           = 2;
+constexpr int EXIT_NO_SERVER       = 3;
+constexpr int EXIT_NO_TRACKING     = 4;
+constexpr int EXIT_NO_OUTPUT       = 5;
+constexpr int EXIT_CONNECTION_LOST = 6;
+constexpr int EXIT_NO_CONTROL      = 7;
+constexpr int EXIT_NO_RECORDING    = 8;
+
+// interval at which the headless mode checks for signals and the connection
+const std::chrono::milliseconds HEADLESS_POLL_INTERVAL( 100 );
+
+// set by SIGTERM and SIGINT in headless mode
+std::atomic< bool > stopRequested{ false };
+
+void
+requestStop( int )
+{
+    stopRequested = true;
+}
 
 std::string
 trim( const std::string& s, const std::string& undesired = " \t" )
 {
-    std::string trimmed = s.substr( s.find_first_not_of( undesired ), std::string::npos );
-    return trimmed.substr( 0, trimmed.find_last_not_of( undesired ) + 1 );
+    const size_t first = s.find_first_not_of( undesired );
+    if ( first == std::string::npos ) {
+        return "";
+    }
+    return s.substr( first, s.find_last_not_of( undesired ) + 1 - first );
 }
 
 void
 getinput( std::string& input )
 {
     std::cout << std::flush;
+    // messages arriving meanwhile are written on a line of their own
+    Log::setAwaitingInput( true );
     std::getline( std::cin, input );
+    Log::setAwaitingInput( false );
     if ( input.empty( ) ) {
         return;
     }
@@ -64,15 +149,178 @@ string2long( std::string& s, int32& i )
     char* e;
     auto  trimmed = trim( s );
     errno         = 0; // clear errno
-    int32 value   = std::strtol( trimmed.c_str( ), &e, 10 );
-    if ( *e == '\0' &&   // consume the entire string
-         errno == 0 ) {  // error, overflow or underflow
-        i = value;
+    long  value   = std::strtol( trimmed.c_str( ), &e, 10 );
+    if ( !trimmed.empty( ) &&
+         *e == '\0' &&   // consume the entire string
+         errno == 0 &&   // error, overflow or underflow
+         value >= std::numeric_limits< int32 >::min( ) &&
+         value <= std::numeric_limits< int32 >::max( ) ) {
+        i = static_cast< int32 >( value );
+        return true;
+    }
+    return false;
+}
+
+bool
+string2double( std::string& s, double& d )
+{
+    char* e;
+    auto  trimmed = trim( s );
+    errno         = 0;
+    double value  = std::strtod( trimmed.c_str( ), &e );
+    if ( !trimmed.empty( ) && *e == '\0' && errno == 0 ) {
+        d = value;
         return true;
     }
     return false;
 }
 
+bool
+isCommand( const std::string& input, const std::string& command )
+{
+    return input.find( command ) == 0 &&
+           ( input.length( ) == command.length( ) || input[ command.length( ) ] == ' ' );
+}
+
+// finds "<option> <value>" within the whitespace separated tokens of input
+bool
+findOption( const std::string& input, const std::string& option, std::string& value )
+{
+    std::istringstream tokens( input );
+    std::string        token;
+    while ( tokens >> token ) {
+        if ( token == option ) {
+            return static_cast< bool >( tokens >> value );
+        }
+    }
+    return false;
+}
+
+void
+printChunking( const LSLClient& client )
+{
+    int32 samples;
+    int64 microseconds;
+    std::tie( samples, microseconds ) = client.chunking( );
+    if ( samples == 1 ) {
+        std::cout << "pushing every sample immediately" << std::endl;
+    } else {
+        std::cout << "pushing chunks of " << samples << " samples";
+        if ( microseconds > 0 ) {
+            std::cout << " or " << microseconds << " microseconds";
+        }
+        std::cout << std::endl;
+    }
+}
+
+void
+printStatistics( const LSLClient& client )
+{
+    const auto ring = client.ringStatistics( );
+    std::cout << "sample ring: " << ring.occupancy << " of " << ring.capacity
+              << " queued, high water " << ring.highWater << ", " << ring.pushed << " pushed, "
+              << ring.overflows << " overflows" << std::endl;
+
+    const auto continuity = client.continuityStatistics( );
+    std::cout << "stream: " << continuity.samples << " samples, " << continuity.gaps << " gaps ("
+              << continuity.missing << " missing), " << continuity.duplicates << " duplicates, "
+              << continuity.restarts << " index restarts" << std::endl;
+    std::cout << "gap filling: ";
+    if ( client.gapFilling( ) ) {
+        std::cout << continuity.filled << " placeholder samples inserted" << std::endl;
+    } else {
+        std::cout << "off" << std::endl;
+    }
+
+    MarkerOutlet::Statistics markers;
+    if ( client.markerStatistics( markers ) ) {
+        std::cout << "markers: " << markers.posted << " posted, " << markers.dropped << " dropped"
+                  << std::endl;
+    }
+    MarkerOutlet::Statistics events;
+    if ( client.eventStatistics( events ) ) {
+        std::cout << "eye movement events: " << events.posted << " posted, " << events.dropped
+                  << " dropped" << std::endl;
+    }
+
+    XdfWriter::Statistics xdf;
+    std::cout << "xdf: ";
+    if ( client.xdfStatistics( xdf ) ) {
+        std::cout << xdf.samples << " samples of " << xdf.streams << " streams written ("
+                  << ( xdf.bytes >> 10 ) << " KiB), " << xdf.late << " late hand-overs"
+                  << std::endl;
+    } else {
+        std::cout << "off" << std::endl;
+    }
+
+    const auto log = Log::statistics( );
+    std::cout << "log: " << log.written << " messages written, " << log.dropped << " dropped"
+              << std::endl;
+
+    RecordingJournal::Statistics journal;
+    std::cout << "journal: ";
+    if ( client.journalStatistics( journal ) ) {
+        std::cout << journal.records << " records (" << ( journal.bytes >> 20 ) << " MiB) in "
+                  << journal.segments << " segments, " << journal.dropped << " dropped, "
+                  << journal.recovered << " segments recovered on start" << std::endl;
+    } else {
+        std::cout << "off" << std::endl;
+    }
+}
+
+int
+replay( const std::string& path, double speed, int32 chunkSamples, int32 chunkTime )
+{
+    if ( chunkSamples < 1 || chunkSamples > LSLClient::MAX_CHUNK_SAMPLES || chunkTime < 0 ) {
+        std::cout << "invalid chunking - pushing every sample immediately" << std::endl;
+        chunkSamples = 1;
+        chunkTime    = 0;
+    }
+    SessionReplay replay( speed, chunkSamples, std::chrono::microseconds( chunkTime ) );
+    if ( !replay.open( path ) ) {
+        Log::failure( "no recording journal found at " + path );
+        Log::flush( );
+        return EXIT_NO_RECORDING;
+    }
+    std::cout << "replaying " << path << " ";
+    if ( speed > 0.0 ) {
+        std::cout << "at " << speed << "x speed" << std::endl;
+    } else {
+        std::cout << "as fast as possible" << std::endl;
+    }
+
+    // SIGTERM and SIGINT end a headless replay early
+    const auto begin = std::chrono::steady_clock::now( );
+    replay.run( stopRequested );
+    const std::chrono::duration< double > elapsed = std::chrono::steady_clock::now( ) - begin;
+    if ( stopRequested ) {
+        Log::info( "stop requested - replay ended early" );
+    }
+    Log::flush( );
+
+    const auto& statistics = replay.statistics( );
+    std::cout << "replayed " << statistics.samples << " samples of " << statistics.streams
+              << " streams, " << statistics.recorded << " s of recording in " << elapsed.count( )
+              << " s (" << statistics.samples / std::max( elapsed.count( ), 1e-9 )
+              << " samples/s)" << std::endl;
+    return 0;
+}
+
+void
+printTrackers( const TrackerPool& pool )
+{
+    const auto trackers = pool.trackers( );
+    if ( trackers.empty( ) ) {
+        std::cout << "no trackers attached" << std::endl;
+    }
+    for ( const auto& tracker : trackers ) {
+        std::cout << "  [" << tracker.id << "] " << toString( tracker.server ) << ", device "
+                  << tracker.deviceSerial << ", "
+                  << ( tracker.connected ? "connected" : "disconnected" ) << ", "
+                  << ( tracker.streaming ? "streaming" : "not streaming" ) << std::endl;
+    }
+}
+
 bool
 checkConnection( const LSLClient& client )
 {
@@ -89,13 +337,13 @@ evaluateConnect( elapi::ELApi::ReturnConnect value )
 {
     switch ( value ) {
         case elapi::ELApi::ReturnConnect::SUCCESS:
-            std::cout << "LSL client connected" << std::endl;
+            Log::info( "LSL client connected" );
             break;
         case elapi::ELApi::ReturnConnect::FAILURE:
-            std::cout << "cannot connect to server - is the server running?" << std::endl;
+            Log::warning( "cannot connect to server - is the server running?" );
             break;
         case elapi::ELApi::ReturnConnect::VERSION_MISMATCH:
-            std::cout << "cannot connect to server - client-server version mismatch" << std::endl;
+            Log::warning( "cannot connect to server - client-server version mismatch" );
             break;
     }
 }
@@ -105,25 +353,24 @@ evaluateTracking( elapi::ELApi::ReturnStart value )
 {
     switch ( value ) {
         case elapi::ELApi::ReturnStart::SUCCESS:
-            std::cout
-                << "tracking started - please note:\n  * sample stream will be (paritally) invalid until device is calibrated\n  * the previous subject's calibration may still be active"
-                << std::endl;
+            Log::info( "tracking started - please note:\n"
+                       "  * sample stream will be (paritally) invalid until device is calibrated\n"
+                       "  * the previous subject's calibration may still be active" );
             break;
         case elapi::ELApi::ReturnStart::ALREADY_RUNNING_DIFFERENT_FRAMERATE:
-            std::cout << "cannot begin tracking - server already tracking different framerate"
-                      << std::endl;
+            Log::warning( "cannot begin tracking - server already tracking different framerate" );
             break;
         case elapi::ELApi::ReturnStart::DEVICE_MISSING:
-            std::cout << "cannot begin tracking - device connected?" << std::endl;
+            Log::warning( "cannot begin tracking - device connected?" );
             break;
         case elapi::ELApi::ReturnStart::INVALID_FRAMERATE_MODE:
-            std::cout << "cannot begin tracking - framerate not supported" << std::endl;
+            Log::warning( "cannot begin tracking - framerate not supported" );
             break;
         case elapi::ELApi::ReturnStart::NOT_CONNECTED:
-            std::cout << "cannot begin tracking - is the server running?" << std::endl;
+            Log::warning( "cannot begin tracking - is the server running?" );
             break;
         case elapi::ELApi::ReturnStart::FAILURE:
-            std::cout << "cannot begin tracking" << std::endl;
+            Log::warning( "cannot begin tracking" );
     }
 }
 
@@ -132,26 +379,119 @@ evaluateCalibration( elapi::ELApi::ReturnCalibrate value )
 {
     switch ( value ) {
         case elapi::ELApi::ReturnCalibrate::SUCCESS:
-            std::cout << "successfully calibrated" << std::endl;
+            Log::info( "successfully calibrated" );
             break;
         case elapi::ELApi::ReturnCalibrate::ALREADY_BUSY:
-            std::cout << "cannot begin calibration - calibration or validation in progress"
-                      << std::endl;
+            Log::warning( "cannot begin calibration - calibration or validation in progress" );
             break;
         case elapi::ELApi::ReturnCalibrate::INVALID_CALIBRATION_MODE:
-            std::cout << "cannot begin calibration - calibration mode not supported" << std::endl;
+            Log::warning( "cannot begin calibration - calibration mode not supported" );
             break;
         case elapi::ELApi::ReturnCalibrate::NOT_CONNECTED:
-            std::cout << "cannot begin calibration - not connected: is the server running?"
-                      << std::endl;
+            Log::warning( "cannot begin calibration - not connected: is the server running?" );
             break;
         case elapi::ELApi::ReturnCalibrate::NOT_TRACKING:
-            std::cout << "cannot begin calibration - client not in trackign mode: call startstream"
-                      << std::endl;
+            Log::warning(
+                "cannot begin calibration - client not in trackign mode: call startstream" );
             break;
         case elapi::ELApi::ReturnCalibrate::FAILURE:
-            std::cout << "calibration failed" << std::endl;
+            Log::warning( "calibration failed" );
+    }
+}
+
+void
+evaluateValidation( elapi::ELApi::ReturnValidate             value,
+                    const elapi::ELApi::ELValidationResult& result )
+{
+    switch ( value ) {
+        case elapi::ELApi::ReturnValidate::SUCCESS: {
+            Log::info( "validation finished - mean deviation per point:" );
+            const int32 npoints = sizeof( result.pointsData ) / sizeof( result.pointsData[ 0 ] );
+            for ( int32 i = 0; i < npoints; i++ ) {
+                const auto&        point = result.pointsData[ i ];
+                std::ostringstream ss;
+                ss << std::fixed << std::setprecision( 2 ) << "  point " << i << " at ("
+                   << point.validationPointPxX << ", " << point.validationPointPxY
+                   << ") px - left " << point.meanDeviationLeftPx << " px / "
+                   << point.meanDeviationLeftDeg << " deg, right " << point.meanDeviationRightPx
+                   << " px / " << point.meanDeviationRightDeg << " deg";
+                Log::info( ss.str( ) );
+            }
+        } break;
+        case elapi::ELApi::ReturnValidate::NOT_CONNECTED:
+            Log::warning( "cannot begin validation - not connected: is the server running?" );
+            break;
+        case elapi::ELApi::ReturnValidate::NOT_TRACKING:
+            Log::warning(
+                "cannot begin validation - client not in tracking mode: call startstream" );
+            break;
+        case elapi::ELApi::ReturnValidate::NOT_CALIBRATED:
+            Log::warning( "cannot begin validation - device is not calibrated" );
+            break;
+        case elapi::ELApi::ReturnValidate::ALREADY_BUSY:
+            Log::warning( "cannot begin validation - calibration or validation in progress" );
+            break;
+        case elapi::ELApi::ReturnValidate::FAILURE:
+            Log::warning( "validation failed" );
+    }
+}
+
+// appends "--<key>" and, if given, "<value>" for every "<key> [= <value>]" line of the file,
+// '#' starts a comment
+bool
+loadConfig( const std::string& path, std::vector< std::string >& args )
+{
+    std::ifstream file( path );
+    if ( !file ) {
+        return false;
+    }
+    const std::string blank = " \t\r";
+    std::string       line;
+    while ( std::getline( file, line ) ) {
+        line = line.substr( 0, line.find( '#' ) );
+        if ( line.find_first_not_of( blank ) == std::string::npos ) {
+            continue;
+        }
+        const size_t      equals = line.find( '=' );
+        const std::string key    = line.substr( 0, equals );
+        if ( key.find_first_not_of( blank ) == std::string::npos ) {
+            return false;
+        }
+        args.push_back( "--" + trim( key, blank ) );
+        if ( equals != std::string::npos ) {
+            const std::string value = line.substr( equals + 1 );
+            args.push_back( value.find_first_not_of( blank ) == std::string::npos
+                                ? ""
+                                : trim( value, blank ) );
+        }
+    }
+    return true;
+}
+
+// streams until SIGTERM or SIGINT, a calibration runs alongside
+int
+runHeadless( LSLClient& client, int32 calibration, bool reconnect )
+{
+    if ( calibration >= 0 ) {
+        const auto retCalibrate = client.requestCalibration( calibration, evaluateCalibration );
+        if ( retCalibrate == elapi::ELApi::ReturnCalibrate::SUCCESS ) {
+            Log::info( "calibration started" );
+        } else {
+            evaluateCalibration( retCalibrate );
+        }
     }
+
+    while ( !stopRequested ) {
+        std::this_thread::sleep_for( HEADLESS_POLL_INTERVAL );
+        if ( !reconnect && !client.isConnected( ) ) {
+            Log::failure( "connection to the server lost - exiting" );
+            return EXIT_CONNECTION_LOST;
+        }
+    }
+    Log::info( "stop requested - shutting down" );
+    client.abortCalibration( );
+    client.closeStream( );
+    return EXIT_STOPPED;
 }
 
 std::string
@@ -209,6 +549,14 @@ helpMessage( )
     ss << std::setw( indentwidth ) << std::right << "Note: ";
     ss << "must align with the device's currently active sampling rate!" << std::endl;
 
+    ss << std::endl
+       << "  " << OPT_PROFILE << " <CHANNELS[:FORMAT]>" << std::setw( indentwidth - 24 ) << "";
+    ss << "optional" << std::endl;
+    ss << std::setw( indentwidth ) << "";
+    ss << "selects the channels and value type of the LSL stream" << std::endl;
+    ss << std::setw( indentwidth ) << "";
+    ss << availableStreamProfiles( ) << std::endl;
+
     ss << std::endl;
 
     ss << std::setfill( '.' );
@@ -226,6 +574,99 @@ helpMessage( )
 
     ss << std::endl;
 
+    ss << std::setfill( '.' );
+    ss << std::setw( commandwidth ) << std::left << COM_VALIDATE + " "
+       << " ";
+    ss << std::setfill( ' ' );
+    ss << "validates the calibration - the deviations of every validation" << std::endl;
+    ss << std::setw( indentwidth ) << "";
+    ss << "point are published on the EyeLogicValidation stream" << std::endl;
+
+    ss << std::endl;
+
+    ss << std::setfill( '.' );
+    ss << std::setw( commandwidth ) << std::left << COM_ABORT + " "
+       << " ";
+    ss << std::setfill( ' ' );
+    ss << "aborts a running calibration or validation" << std::endl;
+
+    ss << std::endl;
+
+    ss << std::setfill( '.' );
+    ss << std::setw( commandwidth ) << std::left << COM_CHUNKING + " "
+       << " ";
+    ss << std::setfill( ' ' );
+    ss << "sets how samples are batched before they are pushed to LSL" << std::endl;
+    ss << std::setw( indentwidth ) << "";
+    ss << "without options, prints the current setting" << std::endl;
+
+    ss << std::endl
+       << "  " << OPT_CHUNKSAMPLES << " <SAMPLES>" << std::setw( indentwidth - 14 ) << "";
+    ss << "maximum number of samples per chunk" << std::endl;
+    ss << std::setw( indentwidth ) << "";
+    ss << "1 pushes every sample immediately (lowest latency), at most "
+       << LSLClient::MAX_CHUNK_SAMPLES << std::endl;
+
+    ss << std::endl
+       << "  " << OPT_CHUNKTIME << " <MICROSECONDS>" << std::setw( indentwidth - 19 ) << "";
+    ss << "maximum time a sample waits for its chunk to fill up" << std::endl;
+    ss << std::setw( indentwidth ) << "";
+    ss << "0 waits until the chunk is full" << std::endl;
+
+    ss << std::endl;
+
+    ss << std::setfill( '.' );
+    ss << std::setw( commandwidth ) << std::left << COM_SERVERS + " "
+       << " ";
+    ss << std::setfill( ' ' );
+    ss << "lists the EyeLogic servers in the local network" << std::endl;
+
+    ss << std::endl;
+
+    ss << std::setfill( '.' );
+    ss << std::setw( commandwidth ) << std::left << COM_ATTACH + " <INDEX|IP:PORT> "
+       << " ";
+    ss << std::setfill( ' ' );
+    ss << "connects an additional tracker, by its index in the server list" << std::endl;
+    ss << std::setw( indentwidth ) << "";
+    ss << "or its address - its stream is named EyeLogic_<SERIAL>" << std::endl;
+
+    ss << std::endl;
+
+    ss << std::setfill( '.' );
+    ss << std::setw( commandwidth ) << std::left << COM_DETACH + " <ID> "
+       << " ";
+    ss << std::setfill( ' ' );
+    ss << "closes the stream of an attached tracker and disconnects it" << std::endl;
+
+    ss << std::endl;
+
+    ss << std::setfill( '.' );
+    ss << std::setw( commandwidth ) << std::left << COM_TRACKERS + " "
+       << " ";
+    ss << std::setfill( ' ' );
+    ss << "lists the attached trackers and their ids" << std::endl;
+
+    ss << std::endl
+       << "  " << OPT_DEVICE << " <ID>" << std::setw( indentwidth - 9 ) << "";
+    ss << "directs " << COM_INIT << ", " << COM_CALIBRATE << ", " << COM_VALIDATE << ", "
+       << COM_ABORT << "," << std::endl;
+    ss << std::setw( indentwidth ) << "";
+    ss << COM_CHUNKING << ", " << COM_STATS << " and " << COM_CLOSE << " to an attached tracker"
+       << std::endl;
+
+    ss << std::endl;
+
+    ss << std::setfill( '.' );
+    ss << std::setw( commandwidth ) << std::left << COM_STATS + " "
+       << " ";
+    ss << std::setfill( ' ' );
+    ss << "prints sample ring, frame index and recording statistics of the stream" << std::endl;
+    ss << std::setw( indentwidth ) << "";
+    ss << "gaps and duplicates are counted per stream" << std::endl;
+
+    ss << std::endl;
+
     ss << std::setfill( '.' );
     ss << std::setw( commandwidth ) << std::left << COM_CLOSE + " "
        << " ";
@@ -241,27 +682,371 @@ helpMessage( )
 }  // namespace
 
 int
-main( )
+main( int argc, char* argv[] )
 {
-    std::cout << "EyeLogic LSL console. Type \"help\" for a list of available commands."
-              << std::endl;
+    // the settings of a config file come first, the command line overrides them
+    std::vector< std::string > args;
+    bool                       validArgs = true;
+    for ( int i = 1; i + 1 < argc; i++ ) {
+        if ( argv[ i ] == ARG_CONFIG && !loadConfig( argv[ i + 1 ], args ) ) {
+            std::cout << "cannot read config file " << argv[ i + 1 ] << std::endl;
+            validArgs = false;
+        }
+    }
+    args.insert( args.end( ), argv + 1, argv + argc );
+
+    int32         chunkSamples = 1;
+    int32         chunkTime    = 0;
+    StreamProfile profile;
+    FilterConfig  filter;
+    bool          polling = false;
+    ThreadConfig  readerConfig;
+    bool          simulate  = false;
+    bool          fillGaps  = false;
+    bool          reconnect = true;
+    int32         idleGrace = 0;
+    std::string   journal;
+    std::string   xdfPath;
+    std::string   replayPath;
+    double        replaySpeed = 1.0;
+    int32         journalSegmentMiB =
+        static_cast< int32 >( RecordingJournal::DEFAULT_SEGMENT_BYTES >> 20 );
+    std::string              logFile;
+    LogLevel                 logLevel     = LogLevel::INFO;
+    bool                     detectEvents = false;
+    EventDetector::Config    detectorConfig;
+    std::vector< int32 >     decimatedRates;
+    bool                     visualAngles = false;
+    TrackerGeometry          trackerGeometry;
+    bool                     headless = false;
+    bool                     remote   = false;
+    elapi::ELApi::ServerInfo server{ };
+    int32                    samplerate  = 0;
+    int32                    calibration = -1;
+    int32                    controlPort = 0;
+    for ( size_t i = 0; i < args.size( ); i++ ) {
+        std::string arg   = args[ i ];
+        std::string value = ( i + 1 < args.size( ) ) ? args[ i + 1 ] : "";
+        if ( arg == ARG_CONFIG && !value.empty( ) ) {
+            // already read
+            i++;
+        } else if ( arg == ARG_HEADLESS ) {
+            headless = true;
+        } else if ( arg == ARG_SERVER && parseServer( value, server ) ) {
+            remote = true;
+            i++;
+        } else if ( arg == ARG_RATE && string2long( value, samplerate ) && samplerate > 0 ) {
+            i++;
+        } else if ( arg == ARG_CALIBRATE && string2long( value, calibration ) &&
+                    calibration >= 0 ) {
+            i++;
+        } else if ( arg == ARG_CONTROLPORT && string2long( value, controlPort ) &&
+                    controlPort > 0 && controlPort <= 65535 ) {
+            i++;
+        } else if ( arg == ARG_PROFILE && parseStreamProfile( value, profile ) ) {
+            i++;
+        } else if ( arg == ARG_FILTER && parseFilter( value, filter ) ) {
+            i++;
+        } else if ( arg == ARG_DECIMATE && parseRates( value, decimatedRates ) ) {
+            i++;
+        } else if ( arg == ARG_ANGLES && parseTrackerGeometry( value, trackerGeometry ) ) {
+            visualAngles = true;
+            i++;
+        } else if ( arg == ARG_CHUNKSAMPLES && string2long( value, chunkSamples ) ) {
+            i++;
+        } else if ( arg == ARG_CHUNKTIME && string2long( value, chunkTime ) ) {
+            i++;
+        } else if ( arg == ARG_ACQUISITION && ( value == "listener" || value == "polling" ) ) {
+            polling = ( value == "polling" );
+            i++;
+        } else if ( arg == ARG_PRIORITY && parseThreadPriority( value, readerConfig.priority ) ) {
+            i++;
+        } else if ( arg == ARG_CPU && string2long( value, readerConfig.cpu ) ) {
+            i++;
+        } else if ( arg == ARG_SIMULATE ) {
+            simulate = true;
+        } else if ( arg == ARG_FILLGAPS ) {
+            fillGaps = true;
+        } else if ( arg == ARG_NORECONNECT ) {
+            reconnect = false;
+        } else if ( arg == ARG_IDLEGRACE && string2long( value, idleGrace ) && idleGrace >= 0 ) {
+            i++;
+        } else if ( arg == ARG_JOURNAL && !value.empty( ) ) {
+            journal = value;
+            i++;
+        } else if ( arg == ARG_XDF && !value.empty( ) ) {
+            xdfPath = value;
+            i++;
+        } else if ( arg == ARG_REPLAY && !value.empty( ) ) {
+            replayPath = value;
+            i++;
+        } else if ( arg == ARG_REPLAYSPEED && value == "max" ) {
+            replaySpeed = 0.0;
+            i++;
+        } else if ( arg == ARG_REPLAYSPEED && string2double( value, replaySpeed ) &&
+                    replaySpeed > 0.0 ) {
+            i++;
+        } else if ( arg == ARG_JOURNALSIZE && string2long( value, journalSegmentMiB ) &&
+                    journalSegmentMiB > 0 ) {
+            i++;
+        } else if ( arg == ARG_LOGFILE && !value.empty( ) ) {
+            logFile = value;
+            i++;
+        } else if ( arg == ARG_LOGLEVEL && parseLogLevel( value, logLevel ) ) {
+            i++;
+        } else if ( arg == ARG_EVENTS && parseAlgorithm( value, detectorConfig.algorithm ) ) {
+            detectEvents = true;
+            i++;
+        } else if ( trim( value ).empty( ) ) {
+            // the last argument, a config key without a value or a blank value
+            std::cout << "ignoring invalid argument \"" << arg << "\" - no value given" << std::endl;
+            validArgs = false;
+            i++;
+        } else {
+            std::cout << "ignoring invalid argument \"" << arg << "\"" << std::endl;
+            validArgs = false;
+        }
+    }
+
+    // a service must not run with settings nobody asked for - without a control port, it cannot
+    // be told to stream later, a replay needs neither
+    if ( headless &&
+         ( !validArgs || ( samplerate == 0 && controlPort == 0 && replayPath.empty( ) ) ) ) {
+        std::cout << "headless mode requires valid arguments and " << ARG_RATE << " <SAMPLERATE>"
+                  << ", " << ARG_CONTROLPORT << " <PORT> or " << ARG_REPLAY << " <PATH>"
+                  << std::endl;
+        return EXIT_USAGE;
+    }
+    if ( headless ) {
+        std::signal( SIGINT, requestStop );
+        std::signal( SIGTERM, requestStop );
+    } else {
+        std::cout << "EyeLogic LSL console. Type \"help\" for a list of available commands."
+                  << std::endl;
+    }
+
+    Log::setLevel( logLevel );
+    if ( !logFile.empty( ) && !Log::setFile( logFile ) ) {
+        std::cout << "cannot open log file " << logFile << std::endl;
+    }
+
+    // replays a recording instead of acquiring from a device
+    if ( !replayPath.empty( ) ) {
+        return replay( replayPath, replaySpeed, chunkSamples, chunkTime );
+    }
+
+    LSLClient client( simulate ? std::make_shared< SimulatedGazeSource >( ) : nullptr );
+    if ( simulate ) {
+        std::cout << "acquiring from a simulated device" << std::endl;
+    }
+    if ( !client.setChunking( chunkSamples, chunkTime ) ) {
+        std::cout << "invalid chunking - pushing every sample immediately" << std::endl;
+    }
+    client.setStreamProfile( profile );
+    client.setGazeFilter( filter );
+    client.setDecimatedRates( decimatedRates );
+    client.setVisualAngles( visualAngles, trackerGeometry );
+    client.setGapFilling( fillGaps );
+    if ( !reconnect ) {
+        client.setReconnect( std::chrono::milliseconds( 0 ), std::chrono::milliseconds( 0 ) );
+    }
+    client.setIdleGrace( std::chrono::seconds( idleGrace ) );
+    client.setEventDetection( detectEvents, detectorConfig );
+    if ( !xdfPath.empty( ) ) {
+        if ( client.setXdfRecording( xdfPath ) ) {
+            std::cout << "recording XDF to " << xdfPath << std::endl;
+        } else {
+            std::cout << "cannot create " << xdfPath << std::endl;
+            if ( headless ) {
+                return EXIT_NO_OUTPUT;
+            }
+        }
+    }
+    if ( !journal.empty( ) ) {
+        if ( client.setJournal( journal, static_cast< uint64 >( journalSegmentMiB ) << 20 ) ) {
+            std::cout << "recording journal to " << journal << std::endl;
+        } else {
+            std::cout << "cannot open journal in " << journal << std::endl;
+            if ( headless ) {
+                return EXIT_NO_OUTPUT;
+            }
+        }
+    }
+    client.setAcquisition(
+        polling ? LSLClient::Acquisition::POLLING : LSLClient::Acquisition::LISTENER, readerConfig );
+
+    // scripts control the client alongside the console
+    ControlServer control( client );
+    if ( controlPort > 0 ) {
+        if ( control.start( static_cast< uint16_t >( controlPort ) ) ) {
+            Log::info( "control server listening on 127.0.0.1:" + std::to_string( controlPort ) );
+        } else {
+            Log::failure( "cannot listen on control port " + std::to_string( controlPort ) );
+            if ( headless ) {
+                Log::flush( );
+                return EXIT_NO_CONTROL;
+            }
+        }
+    }
+
+    const auto retConnect = remote ? client.connectRemote( server ) : client.connectELApi( );
+    evaluateConnect( retConnect );
+    if ( headless && retConnect != elapi::ELApi::ReturnConnect::SUCCESS ) {
+        Log::flush( );
+        return EXIT_NO_SERVER;
+    }
+    // streams right away instead of waiting for startstream
+    if ( samplerate > 0 && retConnect == elapi::ELApi::ReturnConnect::SUCCESS ) {
+        const auto retTracking = client.requestTracking( samplerate );
+        evaluateTracking( retTracking );
+        if ( headless && retTracking != elapi::ELApi::ReturnStart::SUCCESS ) {
+            Log::flush( );
+            return EXIT_NO_TRACKING;
+        }
+    }
+    if ( headless ) {
+        const int exitCode = runHeadless( client, calibration, reconnect );
+        Log::flush( );
+        return exitCode;
+    }
+    if ( calibration >= 0 && client.isStreaming( ) ) {
+        const auto retCalibrate = client.requestCalibration( calibration, evaluateCalibration );
+        if ( retCalibrate != elapi::ELApi::ReturnCalibrate::SUCCESS ) {
+            evaluateCalibration( retCalibrate );
+        }
+    }
 
-    LSLClient client;
-    evaluateConnect( client.connectELApi( ) );
+    // further trackers, each with its own client and outlet
+    TrackerPool::ClientSettings trackerSettings;
+    trackerSettings.profile         = profile;
+    trackerSettings.filter          = filter;
+    trackerSettings.decimatedRates  = decimatedRates;
+    trackerSettings.visualAngles    = visualAngles;
+    trackerSettings.trackerGeometry = trackerGeometry;
+    trackerSettings.chunkSamples    = chunkSamples;
+    trackerSettings.chunkMicroSec   = chunkTime;
+    trackerSettings.acquisition =
+        polling ? LSLClient::Acquisition::POLLING : LSLClient::Acquisition::LISTENER;
+    trackerSettings.readerConfig   = readerConfig;
+    trackerSettings.fillGaps       = fillGaps;
+    trackerSettings.reconnect      = reconnect;
+    trackerSettings.idleGrace      = std::chrono::seconds( idleGrace );
+    trackerSettings.detectEvents   = detectEvents;
+    trackerSettings.detectorConfig = detectorConfig;
 
+    std::unique_ptr< TrackerPool > pool;
+    if ( simulate ) {
+        SimulatorConfig network;
+        network.servers = SIMULATED_SERVERS;
+        pool            = std::make_unique< TrackerPool >(
+            []( const elapi::ELApi::ServerInfo& server ) {
+                // every simulated server is a device of its own
+                SimulatorConfig config;
+                config.deviceSerial += server.port + 1u;
+                config.seed += server.port + 1u;
+                return std::make_shared< SimulatedGazeSource >( config );
+            },
+            std::make_shared< SimulatedGazeSource >( network ) );
+    } else {
+        pool = std::make_unique< TrackerPool >(
+            []( const elapi::ELApi::ServerInfo& ) {
+                return createDefaultGazeSource( "LSL Client" );
+            },
+            createDefaultGazeSource( "LSL Discovery" ) );
+    }
+    std::vector< elapi::ELApi::ServerInfo > servers;
+
+    Log::setPrompt( PROMPT );
     std::string input;
     bool        run = true;
     while ( run ) {
-        std::cout << ">> ";
+        // the messages of the previous command go before the prompt
+        Log::flush( );
+        std::cout << PROMPT;
         getinput( input );
+
+        // "-d <ID>" directs the command to an attached tracker instead of the local client
+        std::shared_ptr< LSLClient > tracker;
+        std::string                  sdevice;
+        int32                        device = 0;
+        if ( findOption( input, OPT_DEVICE, sdevice ) &&
+             ( !string2long( sdevice, device ) || !( tracker = pool->client( device ) ) ) ) {
+            std::cout << "no tracker " << sdevice << " attached - enter \"" << COM_TRACKERS
+                      << "\" for a list" << std::endl;
+            continue;
+        }
+        LSLClient& target = tracker ? *tracker : client;
+
         if ( input == COM_QUITSCOPE ) {
             run = false;
         } else if ( input == COM_HELP ) {
             std::cout << helpMessage( );
+        } else if ( isCommand( input, COM_STATS ) ) {
+            printStatistics( target );
         } else if ( input == COM_CONNECT ) {
             evaluateConnect( client.connectELApi( ) );
-        } else if ( input == COM_CLOSE ) {
-            if ( client.hasConsumers( ) ) {
+        } else if ( input == COM_SERVERS ) {
+            servers = pool->discover( DISCOVERY_MILLIS );
+            if ( servers.empty( ) ) {
+                std::cout << "no EyeLogic server responded" << std::endl;
+            }
+            for ( size_t i = 0; i < servers.size( ); i++ ) {
+                const int32 attached = pool->find( servers[ i ] );
+                std::cout << "  " << i << ": " << toString( servers[ i ] );
+                if ( attached > 0 ) {
+                    std::cout << " (attached as tracker " << attached << ")";
+                }
+                std::cout << std::endl;
+            }
+        } else if ( isCommand( input, COM_ATTACH ) ) {
+            std::istringstream       tokens( input.substr( COM_ATTACH.length( ) ) );
+            std::string              saddress;
+            int32                    index;
+            elapi::ELApi::ServerInfo server;
+            if ( !( tokens >> saddress ) ) {
+                std::cout << "usage: " << COM_ATTACH << " <INDEX|IP:PORT>" << std::endl;
+                continue;
+            }
+            if ( string2long( saddress, index ) ) {
+                if ( index < 0 || static_cast< size_t >( index ) >= servers.size( ) ) {
+                    std::cout << "no server " << index << " - enter \"" << COM_SERVERS
+                              << "\" to list the servers" << std::endl;
+                    continue;
+                }
+                server = servers[ static_cast< size_t >( index ) ];
+            } else if ( !parseServer( saddress, server ) ) {
+                std::cout << "invalid server address \"" << saddress << "\"" << std::endl;
+                continue;
+            }
+            const int32 attached = pool->find( server );
+            if ( attached > 0 ) {
+                std::cout << toString( server ) << " is already attached as tracker " << attached
+                          << std::endl;
+                continue;
+            }
+            int32      id;
+            const auto retConnect = pool->attach( server, trackerSettings, id );
+            evaluateConnect( retConnect );
+            if ( retConnect == elapi::ELApi::ReturnConnect::SUCCESS ) {
+                Log::info( "attached " + toString( server ) + " as tracker " +
+                           std::to_string( id ) + " - " + COM_INIT + " " + OPT_DEVICE + " " +
+                           std::to_string( id ) + " starts its stream" );
+            }
+        } else if ( isCommand( input, COM_DETACH ) ) {
+            std::istringstream tokens( input.substr( COM_DETACH.length( ) ) );
+            std::string        sid;
+            int32              id;
+            if ( !( tokens >> sid ) ) {
+                std::cout << "usage: " << COM_DETACH << " <ID>" << std::endl;
+            } else if ( !string2long( sid, id ) || !pool->detach( id ) ) {
+                std::cout << "no tracker \"" << sid << "\" attached" << std::endl;
+            } else {
+                std::cout << "detached tracker " << id << std::endl;
+            }
+        } else if ( input == COM_TRACKERS ) {
+            printTrackers( *pool );
+        } else if ( isCommand( input, COM_CLOSE ) ) {
+            if ( target.hasConsumers( ) ) {
                 std::cout << "LSL stream currently being consumed, close anyway? - y/n: ";
 
                 bool repeat = true;
@@ -283,16 +1068,40 @@ main( )
                     continue;
                 }
             }
-            if ( client.isStreaming( ) ) {
-                client.closeStream( );
+            if ( target.isStreaming( ) ) {
+                target.closeStream( );
                 std::cout << "closed LSL stream" << std::endl;
             } else {
                 std::cout << "cannot close stream - not streaming" << std::endl;
             }
+        } else if ( isCommand( input, COM_CHUNKING ) ) {
+            int32       samples;
+            int64       microseconds;
+            std::string ssamples, smicroseconds;
+            std::tie( samples, microseconds ) = target.chunking( );
+            if ( findOption( input, OPT_CHUNKSAMPLES, ssamples ) &&
+                 !string2long( ssamples, samples ) ) {
+                std::cout << "chunk size must be single integer!" << std::endl;
+                continue;
+            }
+            // the current chunk time is kept as int64, only a given one is parsed as int32
+            if ( findOption( input, OPT_CHUNKTIME, smicroseconds ) ) {
+                int32 parsed;
+                if ( !string2long( smicroseconds, parsed ) ) {
+                    std::cout << "chunk time must be single integer!" << std::endl;
+                    continue;
+                }
+                microseconds = parsed;
+            }
+            if ( !target.setChunking( samples, microseconds ) ) {
+                std::cout << "chunk size must be 1 to " << LSLClient::MAX_CHUNK_SAMPLES
+                          << ", chunk time must not be negative" << std::endl;
+            }
+            printChunking( target );
         } else {
             if ( input.find( COM_INIT ) == 0 &&
                  ( input.length( ) == COM_INIT.length( ) || input[ COM_INIT.length( ) ] == ' ' ) ) {
-                if ( !checkConnection( client ) ) {
+                if ( !checkConnection( target ) ) {
                     continue;
                 }
 
@@ -300,15 +1109,11 @@ main( )
                 int32       irate = -1;
 
                 const std::string chooseAgain =
-                    "choose tracking mode " + client.listFramerates( ) + ": ";
+                    "choose tracking mode " + target.listFramerates( ) + ": ";
 
-                size_t pos = input.find( "-r" );
-                if ( pos == std::string::npos ) {
+                if ( !findOption( input, OPT_INITRATE, srate ) ) {
                     std::cout << chooseAgain;
                     getinput( srate );
-                } else {
-                    size_t end = input.find( "-", pos + 1 );
-                    srate      = input.substr( pos + 3, end );
                 }
 
                 while ( irate < 0 ) {
@@ -323,14 +1128,24 @@ main( )
                     }
                 }
 
+                std::string   sprofile;
+                StreamProfile profile = target.streamProfile( );
+                if ( findOption( input, OPT_PROFILE, sprofile ) &&
+                     !parseStreamProfile( sprofile, profile ) ) {
+                    std::cout << "unknown stream profile \"" << sprofile << "\" - "
+                              << availableStreamProfiles( ) << std::endl;
+                    continue;
+                }
+                target.setStreamProfile( profile );
+
                 if ( irate >= 0 ) {
-                    evaluateTracking( client.requestTracking( irate ) );
+                    evaluateTracking( target.requestTracking( irate ) );
                 }
 
             } else if ( input.find( COM_CALIBRATE ) == 0 &&
                         ( input.length( ) == COM_CALIBRATE.length( ) ||
                           input[ COM_CALIBRATE.length( ) ] == ' ' ) ) {
-                if ( !checkConnection( client ) ) {
+                if ( !checkConnection( target ) ) {
                     continue;
                 }
 
@@ -338,15 +1153,11 @@ main( )
                 int32       imode = -1;
 
                 const std::string chooseAgain =
-                    "choose calibration mode " + client.listCalibrations( ) + ": ";
+                    "choose calibration mode " + target.listCalibrations( ) + ": ";
 
-                size_t pos = input.find( "-m" );
-                if ( pos == std::string::npos ) {
+                if ( !findOption( input, OPT_CALIBMODE, smode ) ) {
                     std::cout << chooseAgain;
                     getinput( smode );
-                } else {
-                    size_t end = input.find( "-", pos + 1 );
-                    smode      = input.substr( pos + 3, end );
                 }
 
                 while ( imode < 0 ) {
@@ -362,7 +1173,32 @@ main( )
                 }
 
                 if ( imode >= 0 ) {
-                    evaluateCalibration( client.requestCalibration( imode ) );
+                    // the result is reported once the calibration has finished
+                    const auto retCalibrate =
+                        target.requestCalibration( imode, evaluateCalibration );
+                    if ( retCalibrate == elapi::ELApi::ReturnCalibrate::SUCCESS ) {
+                        Log::info( "calibration started - \"" + COM_ABORT + "\" cancels it" );
+                    } else {
+                        evaluateCalibration( retCalibrate );
+                    }
+                }
+
+            } else if ( isCommand( input, COM_VALIDATE ) ) {
+                if ( !checkConnection( target ) ) {
+                    continue;
+                }
+                const auto retValidate = target.requestValidation( evaluateValidation );
+                if ( retValidate == elapi::ELApi::ReturnValidate::SUCCESS ) {
+                    Log::info( "validation started - \"" + COM_ABORT + "\" cancels it" );
+                } else {
+                    evaluateValidation( retValidate, { } );
+                }
+
+            } else if ( isCommand( input, COM_ABORT ) ) {
+                if ( target.isCalibrating( ) ) {
+                    target.abortCalibration( );
+                } else {
+                    std::cout << "no calibration or validation in progress" << std::endl;
                 }
 
             } else {
@@ -372,6 +1208,7 @@ main( )
         }
     }
 
+    Log::flush( );
     std::cout << "Client has shut down. Press ENTER to exit." << std::endl;
     std::cin.get( );
     return 0;